@@ -1,281 +1,512 @@
 /**
  * @file bigint.hpp
  * @brief 无限精度整数（BigInt）核心定义
- *  * 采用逆序存储 digits（如 123 存储为 [3,2,1]），最小化进位/借位时的元素移动开销；
- * 支持 size_t 与合法数字字符串初始化，内置高效比较与 IO 操作。
+ * 两种表示：
+ *  1. 小值模式：绝对值不超过 INT64_MAX 时直接存放在 int64 中，四则运算走机器指令，溢出时才转入大值模式
+ *  2. 大值模式：绝对值按 2^32 进制逆序存放在 limbs_ 中（低位在前，无前导零），符号单独存放
+ * 能放进小值范围的值总是以小值模式表示，因此相等比较不必跨模式。
+ * 乘法按规模选择逐位乘/Karatsuba，除法使用 Knuth 算法D；只有 to_string 和从字符串构造时才做十进制转换，
+ * 长数字的转换采用分治，只用到乘法，复杂度与 Karatsuba 乘法同阶
  * @author azhz1107cat
  * @date 2025-10-25
- * @note 修复核心问题：
- *  1. div_mod_unsigned 中用二分查找替换逐次累加，避免无限循环
- *  2. Karatsuba 乘法添加基准阈值，减少递归深度
- *  3. shift_left 优化内存操作，避免 vector 开头插入的低效行为
  */
 
 #pragma once
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <climits>
 #include <cstdint>
+#include <deque>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <vector>
-#include <climits>  // 新增：用于 ULLONG_MAX
 
 #include "../src/kiz.hpp"
 
 namespace dep {
 
 class BigInt {
-    std::vector<uint8_t> digits_; // 逆序存储（低位在前），每个元素 0-9
-    bool is_negative_;            // false=正，true=负；0恒为非负
+public:
+    using Limb = uint32_t;
+    using Mag = std::vector<Limb>; // 绝对值：2^32 进制，低位在前，无前导零（空表示 0）
 
-    /**
-     * @brief 移除前导零（逆序中为末尾零），确保数字表示唯一
-     */
-    void trim_leading_zeros() {
-        while (digits_.size() > 1 && digits_.back() == 0) {
-            digits_.pop_back();
+    // 较短一方的 limb 数低于该值时用逐位乘，否则用 Karatsuba（x86-64 -O2 下实测约 48 limb 时两者持平）
+    static constexpr size_t karatsuba_threshold = 48;
+
+private:
+    static constexpr uint64_t bin_base = 1ull << 32;
+    // 小值模式的范围是 [-INT64_MAX, INT64_MAX]，不含 INT64_MIN，取反和取绝对值都不会溢出
+    static constexpr int64_t small_max = INT64_MAX;
+    // 十进制转换时每个块的位数，10^9 < 2^32
+    static constexpr size_t dec_chunk_digits = 9;
+    static constexpr Limb dec_chunk_base = 1000000000;
+    static constexpr uint64_t dec_base = dec_chunk_base;
+    // 不超过该 limb 数（或块数）时直接逐块转换，否则分治
+    static constexpr size_t radix_dc_threshold = 32;
+
+    int64_t small_ = 0;        // 小值模式下的值
+    Mag limbs_;                // 非空时为大值模式
+    bool is_negative_ = false; // 只在大值模式下使用
+
+    [[nodiscard]] bool is_small() const { return limbs_.empty(); }
+
+    // ========================= 绝对值（limb 数组）运算 =========================
+
+    static void trim(Mag& m) {
+        while (!m.empty() && m.back() == 0) m.pop_back();
+    }
+
+    static uint64_t small_abs(const int64_t v) {
+        return v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    }
+
+    static Mag mag_of(uint64_t v) {
+        Mag m;
+        while (v) {
+            m.push_back(static_cast<Limb>(v));
+            v >>= 32;
         }
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            is_negative_ = false;
+        return m;
+    }
+
+    [[nodiscard]] Mag magnitude() const {
+        return is_small() ? mag_of(small_abs(small_)) : limbs_;
+    }
+
+    static int cmp_mag(const Mag& a, const Mag& b) {
+        if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
         }
+        return 0;
     }
 
-    /**
-     * @brief 绝对值比较（辅助减法/乘法）：返回 *this 的绝对值是否小于 other 的绝对值
-     */
-    [[nodiscard]] bool abs_less(const BigInt& other) const {
-        if (digits_.size() != other.digits_.size()) {
-            return digits_.size() < other.digits_.size();
-        }
-        // 从最高位（digits_末尾）逐位比
-        for (auto it1 = digits_.rbegin(), it2 = other.digits_.rbegin(); it1 != digits_.rend(); ++it1, ++it2) {
-            if (*it1 != *it2) {
-                return *it1 < *it2;
-            }
+    // 以下加减乘对任意不超过 2^32 的进制 Base 成立：数值运算用 2^32 进制（除法和取模被编译为移位），
+    // 十进制转换用 10^9 进制。乘积累加 (Base-1)^2 + 2*(Base-1) 不超过 2^64-1
+
+    template <uint64_t Base = bin_base>
+    static Mag add_mag(const Mag& a, const Mag& b) {
+        const Mag& x = a.size() >= b.size() ? a : b;
+        const Mag& y = a.size() >= b.size() ? b : a;
+        Mag r(x.size() + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            const uint64_t sum = static_cast<uint64_t>(x[i]) + (i < y.size() ? y[i] : 0) + carry;
+            r[i] = static_cast<Limb>(sum % Base);
+            carry = sum / Base;
         }
-        return false; // 绝对值相等
+        r[x.size()] = static_cast<Limb>(carry);
+        trim(r);
+        return r;
     }
 
-    /**
-     * @brief 核心辅助：计算 (dividend / divisor) 的商和余数（无符号，仅处理正整数）
-     * @param dividend 被除数（非负）
-     * @param divisor 除数（正，非零）
-     * @return  pair<商, 余数>（均非负）
-     * @note 修复：用二分查找替换逐次累加，避免无限循环
-     */
-    static std::pair<BigInt, BigInt> div_mod_unsigned(const BigInt& dividend, const BigInt& divisor) {
-        BigInt quotient, remainder;
-        quotient.digits_.clear();
-        remainder.digits_.clear();
-        remainder.is_negative_ = false;
-        quotient.is_negative_ = false;
-
-        // 从被除数最高位（digits_末尾）开始逐位构建余数
-        for (auto it = dividend.digits_.rbegin(); it != dividend.digits_.rend(); ++it) {
-            // 余数 = 余数 * 10 + 当前位（模拟手工除法）
-            remainder = remainder * BigInt(10) + BigInt(static_cast<size_t>(*it));
-
-            // 修复核心：二分查找最大的q_digit（0-9），避免逐次累加的无限循环
-            uint8_t q_digit = 0;
-            uint8_t left = 0, right = 9; // 单个数字位，范围固定0-9
-            while (left <= right) {
-                uint8_t mid = (left + right) / 2;
-                BigInt temp = divisor * BigInt(static_cast<size_t>(mid));
-                if (temp <= remainder) {
-                    q_digit = mid;
-                    left = mid + 1;
-                } else {
-                    right = mid - 1;
-                }
-            }
+    // 原地 x -= y，要求 x >= y
+    template <uint64_t Base = bin_base>
+    static void sub_into(Mag& x, const Mag& y) {
+        assert(cmp_mag(x, y) >= 0);
+        int64_t borrow = 0;
+        for (size_t i = 0; i < x.size() && (i < y.size() || borrow); ++i) {
+            int64_t diff = static_cast<int64_t>(x[i]) - (i < y.size() ? y[i] : 0) - borrow;
+            borrow = diff < 0 ? 1 : 0;
+            if (borrow) diff += static_cast<int64_t>(Base);
+            x[i] = static_cast<Limb>(diff);
+        }
+        trim(x);
+    }
+
+    static Mag sub_mag(const Mag& a, const Mag& b) {
+        Mag r = a;
+        sub_into(r, b);
+        return r;
+    }
+
+    // 原地 r += x * Base^shift，r 必须足够长
+    template <uint64_t Base = bin_base>
+    static void add_into(Mag& r, const Mag& x, const size_t shift) {
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < x.size(); ++i) {
+            const uint64_t sum = static_cast<uint64_t>(r[shift + i]) + x[i] + carry;
+            r[shift + i] = static_cast<Limb>(sum % Base);
+            carry = sum / Base;
+        }
+        for (; carry; ++i) {
+            assert(shift + i < r.size());
+            const uint64_t sum = static_cast<uint64_t>(r[shift + i]) + carry;
+            r[shift + i] = static_cast<Limb>(sum % Base);
+            carry = sum / Base;
+        }
+    }
+
+    // 原地 m = m * mul + add
+    static void mul_limb_add(Mag& m, const Limb mul, const Limb add) {
+        uint64_t carry = add;
+        for (auto& limb : m) {
+            const uint64_t t = static_cast<uint64_t>(limb) * mul + carry;
+            limb = static_cast<Limb>(t);
+            carry = t >> 32;
+        }
+        if (carry) m.push_back(static_cast<Limb>(carry));
+    }
+
+    // 原地 m /= d，返回余数
+    static Limb divmod_limb(Mag& m, const Limb d) {
+        uint64_t rem = 0;
+        for (size_t i = m.size(); i-- > 0;) {
+            const uint64_t cur = rem << 32 | m[i];
+            m[i] = static_cast<Limb>(cur / d);
+            rem = cur % d;
+        }
+        trim(m);
+        return static_cast<Limb>(rem);
+    }
 
-            // 商的当前位存入（注意商是正序构建，后续需逆序）
-            quotient.digits_.push_back(q_digit);
-            // 更新余数：remainder = remainder - (q_digit * divisor)
-            if (q_digit > 0) {
-                remainder -= (divisor * BigInt(static_cast<size_t>(q_digit)));
+    template <uint64_t Base = bin_base>
+    static Mag mul_schoolbook(const Mag& a, const Mag& b) {
+        Mag r(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            const uint64_t ai = a[i];
+            if (ai == 0) continue;
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); ++j) {
+                const uint64_t t = ai * b[j] + r[i + j] + carry;
+                r[i + j] = static_cast<Limb>(t % Base);
+                carry = t / Base;
             }
+            r[i + b.size()] = static_cast<Limb>(carry);
         }
+        trim(r);
+        return r;
+    }
 
-        // 商是正序存储（高位在前），需逆转为统一的低位在前格式
-        std::reverse(quotient.digits_.begin(), quotient.digits_.end());
-        quotient.trim_leading_zeros();
-        remainder.trim_leading_zeros();
+    template <uint64_t Base = bin_base>
+    static Mag mul_mag(const Mag& a, const Mag& b) {
+        if (a.empty() || b.empty()) return {};
+        if (a.size() < b.size()) return mul_mag<Base>(b, a);
+        // 此后 a 不短于 b
+        if (b.size() < karatsuba_threshold) return mul_schoolbook<Base>(a, b);
+
+        Mag r(a.size() + b.size(), 0);
+        if (2 * b.size() <= a.size()) {
+            // 长短悬殊：把 a 切成与 b 等长的段分别相乘，每段仍是平衡的 Karatsuba
+            for (size_t off = 0; off < a.size(); off += b.size()) {
+                Mag part(a.begin() + static_cast<std::ptrdiff_t>(off),
+                         a.begin() + static_cast<std::ptrdiff_t>(std::min(off + b.size(), a.size())));
+                trim(part);
+                add_into<Base>(r, mul_mag<Base>(part, b), off);
+            }
+            trim(r);
+            return r;
+        }
 
-        return {quotient, remainder};
+        // a = a1*B^m + a0, b = b1*B^m + b0；b 比 m 长，b1 非空
+        const size_t m = a.size() / 2;
+        const auto mid = static_cast<std::ptrdiff_t>(m);
+        Mag a0(a.begin(), a.begin() + mid), a1(a.begin() + mid, a.end());
+        Mag b0(b.begin(), b.begin() + mid), b1(b.begin() + mid, b.end());
+        trim(a0);
+        trim(b0);
+
+        const Mag z0 = mul_mag<Base>(a0, b0);
+        const Mag z2 = mul_mag<Base>(a1, b1);
+        Mag z1 = mul_mag<Base>(add_mag<Base>(a0, a1), add_mag<Base>(b0, b1));
+        sub_into<Base>(z1, z0);
+        sub_into<Base>(z1, z2);
+
+        add_into<Base>(r, z0, 0);
+        add_into<Base>(r, z1, m);
+        add_into<Base>(r, z2, 2 * m);
+        trim(r);
+        return r;
     }
 
     /**
-     * @brief Karatsuba乘法核心（无符号，仅处理正整数）
-     * 时间复杂度 O(n^log3) ≈ O(n^1.58)，远快于普通O(n²)逐位乘
-     * @note 修复：添加基准阈值，减少递归深度
+     * @brief 绝对值除法（Knuth 算法D）：q = u / v，r = u % v，要求 v 非零
      */
-    static BigInt karatsuba_mul(const BigInt& a, const BigInt& b) {
-        // 修复核心：基准条件优化，长度≤8时用普通乘法，减少递归深度
-        const size_t BASE_THRESHOLD = 8;
-        if (a.digits_.size() <= BASE_THRESHOLD || b.digits_.size() <= BASE_THRESHOLD) {
-            BigInt res;
-            res.digits_.resize(a.digits_.size() + b.digits_.size(), 0);
-            // 逐位相乘，累加至对应位置
-            for (size_t i = 0; i < a.digits_.size(); ++i) {
-                uint32_t carry = 0; // 用32位存进位，避免溢出
-                for (size_t j = 0; j < b.digits_.size(); ++j) {
-                    uint32_t sum = res.digits_[i + j] + a.digits_[i] * b.digits_[j] + carry;
-                    res.digits_[i + j] = static_cast<uint8_t>(sum % 10);
-                    carry = sum / 10;
-                }
-                // 处理剩余进位（可能超过1位）
-                size_t carry_pos = i + b.digits_.size();
-                while (carry > 0) {
-                    if (carry_pos >= res.digits_.size()) {
-                        res.digits_.push_back(0);
-                    }
-                    uint32_t sum = res.digits_[carry_pos] + carry;
-                    res.digits_[carry_pos] = static_cast<uint8_t>(sum % 10);
-                    carry = sum / 10;
-                    carry_pos++;
+    static void divmod_mag(const Mag& u_in, const Mag& v_in, Mag& q, Mag& r) {
+        assert(!v_in.empty());
+        if (cmp_mag(u_in, v_in) < 0) {
+            q.clear();
+            r = u_in;
+            return;
+        }
+        if (v_in.size() == 1) {
+            q = u_in;
+            const Limb rem = divmod_limb(q, v_in[0]);
+            r = rem ? Mag{rem} : Mag{};
+            return;
+        }
+
+        const size_t n = v_in.size();
+        const size_t m = u_in.size() - n;
+        // 规格化：左移使除数最高位为 1，试商最多偏大 2
+        const int s = std::countl_zero(v_in.back());
+        Mag v(n), u(u_in.size() + 1);
+        for (size_t i = n - 1; i > 0; --i) {
+            v[i] = static_cast<Limb>(static_cast<uint64_t>(v_in[i]) << s | static_cast<uint64_t>(v_in[i - 1]) >> (32 - s));
+        }
+        v[0] = static_cast<Limb>(static_cast<uint64_t>(v_in[0]) << s);
+        u[u_in.size()] = static_cast<Limb>(static_cast<uint64_t>(u_in.back()) >> (32 - s));
+        for (size_t i = u_in.size() - 1; i > 0; --i) {
+            u[i] = static_cast<Limb>(static_cast<uint64_t>(u_in[i]) << s | static_cast<uint64_t>(u_in[i - 1]) >> (32 - s));
+        }
+        u[0] = static_cast<Limb>(static_cast<uint64_t>(u_in[0]) << s);
+
+        constexpr uint64_t base = 1ull << 32;
+        q.assign(m + 1, 0);
+        for (size_t j = m + 1; j-- > 0;) {
+            // 用被除数最高两位和除数最高一位试商，再用次高位修正
+            const uint64_t num = static_cast<uint64_t>(u[j + n]) << 32 | u[j + n - 1];
+            uint64_t qhat = num / v[n - 1];
+            uint64_t rhat = num % v[n - 1];
+            while (qhat >= base || qhat * v[n - 2] > (rhat << 32 | u[j + n - 2])) {
+                --qhat;
+                rhat += v[n - 1];
+                if (rhat >= base) break;
+            }
+
+            // u[j..j+n] -= qhat * v
+            int64_t borrow = 0;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t p = qhat * v[i] + carry;
+                carry = p >> 32;
+                const int64_t t = static_cast<int64_t>(u[i + j]) - borrow - static_cast<int64_t>(p & 0xffffffffu);
+                u[i + j] = static_cast<Limb>(t);
+                borrow = t < 0 ? 1 : 0;
+            }
+            const int64_t t = static_cast<int64_t>(u[j + n]) - borrow - static_cast<int64_t>(carry);
+            u[j + n] = static_cast<Limb>(t);
+
+            q[j] = static_cast<Limb>(qhat);
+            if (t < 0) {
+                // 试商大了 1，加回一次除数
+                --q[j];
+                uint64_t add_carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    const uint64_t sum = static_cast<uint64_t>(u[i + j]) + v[i] + add_carry;
+                    u[i + j] = static_cast<Limb>(sum);
+                    add_carry = sum >> 32;
                 }
+                u[j + n] = static_cast<Limb>(u[j + n] + add_carry);
             }
-            res.trim_leading_zeros();
-            return res;
         }
+        trim(q);
 
-        // m 取较小长度的一半（向上取整）
-        size_t min_len = std::min(a.digits_.size(), b.digits_.size());
-        size_t m = (min_len + 1) / 2; // 向上取整，比如 min_len=5 → m=3，min_len=4→m=2
+        // 余数右移还原
+        r.assign(n, 0);
+        for (size_t i = 0; i + 1 < n; ++i) {
+            r[i] = static_cast<Limb>(u[i] >> s | static_cast<uint64_t>(u[i + 1]) << (32 - s));
+        }
+        r[n - 1] = u[n - 1] >> s;
+        trim(r);
+    }
 
-        BigInt a_low, a_high, b_low, b_high;
+    // ========================= 十进制转换 =========================
+    // 分治：二进制数按 2^j 个 limb 拆成高低两半，分别转为 10^9 进制后按 高 * 2^(32*2^j) + 低 拼回；
+    // 解析时反过来按 9*2^j 位拆开。用到的幂只有 log n 个，按线程缓存（deque 扩容不会让已有元素失效）
 
-        // 拆分 a：a_low = a % 10^m，a_high = a / 10^m（逆序存储，前m位是低位）
-        a_low.digits_ = std::vector<uint8_t>(a.digits_.begin(), a.digits_.begin() + std::min(m, a.digits_.size()));
-        if (a.digits_.size() > m) {
-            a_high.digits_ = std::vector<uint8_t>(a.digits_.begin() + m, a.digits_.end());
-        } else {
-            a_high.digits_ = {0}; // 不足高位补0
-        }
+    // 2^(32*2^j) 的 10^9 进制形式
+    static const Mag& dec_pow_of_two(const size_t j) {
+        thread_local std::deque<Mag> cache;
+        if (cache.empty()) cache.push_back(to_dec_naive(Mag{0, 1}));
+        while (cache.size() <= j) cache.push_back(mul_mag<dec_base>(cache.back(), cache.back()));
+        return cache[j];
+    }
 
-        // 拆分 b（同 a）
-        b_low.digits_ = std::vector<uint8_t>(b.digits_.begin(), b.digits_.begin() + std::min(m, b.digits_.size()));
-        if (b.digits_.size() > m) {
-            b_high.digits_ = std::vector<uint8_t>(b.digits_.begin() + m, b.digits_.end());
-        } else {
-            b_high.digits_ = {0};
-        }
+    // 10^(9*2^j) 的二进制形式
+    static const Mag& bin_pow_of_ten(const size_t j) {
+        thread_local std::deque<Mag> cache;
+        if (cache.empty()) cache.push_back(Mag{dec_chunk_base});
+        while (cache.size() <= j) cache.push_back(mul_mag(cache.back(), cache.back()));
+        return cache[j];
+    }
 
-        // Karatsuba公式：z0*10^(2m) + (z1 - z0 - z2)*10^m + z2
-        BigInt z0 = karatsuba_mul(a_low, b_low);
-        BigInt z1 = karatsuba_mul(a_low + a_high, b_low + b_high);
-        BigInt z2 = karatsuba_mul(a_high, b_high);
+    // 反复除以 10^9，每次得到最低的 9 位十进制数字
+    static Mag to_dec_naive(Mag m) {
+        Mag chunks;
+        while (!m.empty()) chunks.push_back(divmod_limb(m, dec_chunk_base));
+        return chunks;
+    }
 
-        // 按标准顺序计算（加法交换律下结果一致，但更易读）
-        BigInt res = z2.shift_left(2 * m) + (z1 - z0 - z2).shift_left(m) + z0;
-        res.trim_leading_zeros();
+    // 二进制绝对值 -> 10^9 进制块（低位在前）
+    static Mag to_dec(const Mag& m) {
+        if (m.size() <= radix_dc_threshold) return to_dec_naive(m);
+        // 低半部分取 2^j 个 limb，2^j < m.size()
+        const size_t j = std::bit_width(m.size() - 1) - 1;
+        const auto split = static_cast<std::ptrdiff_t>(size_t{1} << j);
+        Mag low(m.begin(), m.begin() + split);
+        trim(low);
+        Mag res = mul_mag<dec_base>(to_dec(Mag(m.begin() + split, m.end())), dec_pow_of_two(j));
+        const Mag low_dec = to_dec(low);
+        res.resize(std::max(res.size(), low_dec.size()) + 1, 0);
+        add_into<dec_base>(res, low_dec, 0);
+        trim(res);
         return res;
     }
 
-    /**
-     * @brief 左移（乘以 10^k，逆序存储中为开头补k个0）
-     * @note 修复：优化内存操作，避免 vector 开头 insert 的低效行为
-     */
-    [[nodiscard]] BigInt shift_left(size_t k) const {
-        if (k == 0 || (digits_.size() == 1 && digits_[0] == 0)) {
-            return *this;
+    // 十进制数字串 [first, last) -> 二进制绝对值
+    static Mag parse_dec(const char* first, const char* last) {
+        const auto len = static_cast<size_t>(last - first);
+        if (len <= radix_dc_threshold * dec_chunk_digits) {
+            Mag m;
+            // 第一块取余下的位数，之后每块 9 位
+            size_t chunk_len = len % dec_chunk_digits == 0 ? dec_chunk_digits : len % dec_chunk_digits;
+            for (const char* pos = first; pos < last; pos += chunk_len, chunk_len = dec_chunk_digits) {
+                Limb chunk = 0;
+                Limb scale = 1;
+                for (size_t i = 0; i < chunk_len; ++i) {
+                    chunk = chunk * 10 + static_cast<Limb>(pos[i] - '0');
+                    scale *= 10;
+                }
+                mul_limb_add(m, scale, chunk);
+            }
+            trim(m);
+            return m;
         }
-        BigInt res = *this;
-        // 修复核心：先resize预分配，再后移元素，最后填充0，避免开头insert
-        size_t old_size = res.digits_.size();
-        res.digits_.resize(old_size + k, 0); // 扩展内存
-        // 原有元素后移k位
-        for (size_t i = old_size + k - 1; i >= k; --i) {
-            res.digits_[i] = res.digits_[i - k];
-        }
-        // 前k位置0
-        std::fill(res.digits_.begin(), res.digits_.begin() + k, 0);
-        res.trim_leading_zeros(); // 补0后清理前导零
+        // 低位部分取 9*2^j 位，9*2^j < len
+        const size_t j = std::bit_width((len - 1) / dec_chunk_digits) - 1;
+        const size_t low_len = dec_chunk_digits << j;
+        Mag res = mul_mag(parse_dec(first, last - low_len), bin_pow_of_ten(j));
+        const Mag low = parse_dec(last - low_len, last);
+        res.resize(std::max(res.size(), low.size()) + 1, 0);
+        add_into(res, low, 0);
+        trim(res);
         return res;
     }
 
-    /**
-     * @brief 无符号减法：计算 |a| - |b|，要求 |a| >= |b|
-     */
-    static BigInt unsigned_subtract(const BigInt& a, const BigInt& b) {
-        assert(!a.abs_less(b) && "unsigned_subtract requires |a| >= |b|");
-
-        BigInt result;
-        result.digits_.clear();
-        result.is_negative_ = false;
-
-        uint32_t borrow = 0;
-        for (size_t i = 0; i < a.digits_.size(); ++i) {
-            uint32_t a_digit = a.digits_[i];
-            uint32_t b_digit = (i < b.digits_.size()) ? b.digits_[i] : 0;
-
-            int32_t diff = static_cast<int32_t>(a_digit) - static_cast<int32_t>(b_digit) - borrow;
-
-            if (diff < 0) {
-                diff += 10;
-                borrow = 1;
-            } else {
-                borrow = 0;
+    // 由符号和绝对值构造，能放进小值范围时转为小值模式
+    static BigInt from_mag(Mag m, const bool negative) {
+        trim(m);
+        BigInt res;
+        if (m.size() <= 2) {
+            const uint64_t v = m.empty() ? 0 : (m.size() == 2 ? static_cast<uint64_t>(m[1]) << 32 : 0) | m[0];
+            if (v <= static_cast<uint64_t>(small_max)) {
+                res.small_ = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+                return res;
             }
+        }
+        res.limbs_ = std::move(m);
+        res.is_negative_ = negative;
+        return res;
+    }
 
-            result.digits_.push_back(static_cast<uint8_t>(diff));
+    static BigInt from_u64(const uint64_t v, const bool negative) {
+        if (v <= static_cast<uint64_t>(small_max)) {
+            BigInt res;
+            res.small_ = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+            return res;
         }
+        return from_mag(mag_of(v), negative);
+    }
 
-        // 移除前导零
-        while (result.digits_.size() > 1 && result.digits_.back() == 0) {
-            result.digits_.pop_back();
+    // a + b（negate_b 为 true 时计算 a - b）
+    static BigInt add_signed(const BigInt& a, const BigInt& b, const bool negate_b) {
+        if (a.is_small() && b.is_small()) {
+            int64_t res;
+            const bool overflow = negate_b
+                ? __builtin_sub_overflow(a.small_, b.small_, &res)
+                : __builtin_add_overflow(a.small_, b.small_, &res);
+            if (!overflow && res != INT64_MIN) {
+                BigInt out;
+                out.small_ = res;
+                return out;
+            }
         }
+        const Mag ma = a.magnitude();
+        const Mag mb = b.magnitude();
+        const bool neg_a = a.is_negative();
+        const bool neg_b = b.is_negative() != negate_b;
+        if (neg_a == neg_b) return from_mag(add_mag(ma, mb), neg_a);
+        // 异号：绝对值相减，符号取绝对值大的一方
+        if (cmp_mag(ma, mb) >= 0) return from_mag(sub_mag(ma, mb), neg_a);
+        return from_mag(sub_mag(mb, ma), neg_b);
+    }
 
-        return result;
+    static int compare(const BigInt& a, const BigInt& b) {
+        if (a.is_small() && b.is_small()) return (a.small_ > b.small_) - (a.small_ < b.small_);
+        const bool neg_a = a.is_negative();
+        if (neg_a != b.is_negative()) return neg_a ? -1 : 1;
+        // 大值模式的绝对值总是大于小值模式
+        const int mag_cmp = a.is_small() ? -1 : b.is_small() ? 1 : cmp_mag(a.limbs_, b.limbs_);
+        return neg_a ? -mag_cmp : mag_cmp;
+    }
+
+    [[nodiscard]] bool is_zero() const { return is_small() && small_ == 0; }
+
+    // 商和余数的绝对值
+    static void divmod_abs(const BigInt& a, const BigInt& b, Mag& q, Mag& r) {
+        divmod_mag(a.magnitude(), b.magnitude(), q, r);
     }
 
+public:
     /**
     * @brief 辅助函数：无符号快速幂（底数和指数均为非负整数）
     * 二分幂核心逻辑：a^b = (a^(b/2))^2 （b为偶数） / (a^(b/2))^2 * a （b为奇数）
     */
-public:
     static BigInt fast_pow_unsigned(const BigInt& base, const BigInt& exp) {
-        BigInt result(1); // 初始结果为 1（乘法单位元）
+        BigInt result(1);
         BigInt current_base = base;
+        long long small_exp = 0;
+        if (exp.try_to_long_long(small_exp)) {
+            if (small_exp <= 0) return result;
+            for (auto e = static_cast<uint64_t>(small_exp); e; e >>= 1) {
+                if (e & 1) result = result * current_base;
+                // 最后一轮不再平方
+                if (e > 1) current_base = current_base * current_base;
+            }
+            return result;
+        }
+
         BigInt current_exp = exp;
         const BigInt two(2);
-
         while (current_exp > BigInt(0)) {
-            // 若当前指数为奇数，结果 *= 当前底数
             if (current_exp % two == BigInt(1)) {
-                result = result * current_base; // 复用 Karatsuba 乘法，高效
+                result = result * current_base;
             }
-            // 底数平方，指数减半（整除）
             current_base = current_base * current_base;
-            current_exp = current_exp / two; // 整数除法，向下取整
+            current_exp = current_exp / two;
         }
-
         return result;
     }
 
     // ========================= 构造与析构 =========================
-    BigInt() : is_negative_(false), digits_(1, 0) {}
-    BigInt(size_t val) : is_negative_(false) {
-        if (val == 0) { digits_.push_back(0); return; }
-        while (val > 0) { digits_.push_back(static_cast<uint8_t>(val % 10)); val /= 10; }
+    BigInt() = default;
+    BigInt(size_t val) {
+        if (val <= static_cast<uint64_t>(small_max)) {
+            small_ = static_cast<int64_t>(val);
+        } else {
+            limbs_ = mag_of(val);
+        }
     }
-    BigInt(const std::string& s) : is_negative_(false) {
-        if (s.empty()) { digits_.push_back(0); return; }
+    BigInt(const std::string& s) {
         size_t start_idx = 0;
-        if (s[0] == '-') { is_negative_ = true; start_idx = 1; }
-        for (auto it = s.rbegin(); it != s.rend() - start_idx; ++it) {
-            if (*it < '0' || *it > '9') { digits_ = {0}; is_negative_ = false; return; }
-            digits_.push_back(static_cast<uint8_t>(*it - '0'));
+        bool negative = false;
+        if (!s.empty() && s[0] == '-') { negative = true; start_idx = 1; }
+        for (size_t i = start_idx; i < s.size(); ++i) {
+            if (s[i] < '0' || s[i] > '9') return; // 非法字符串得到 0
         }
-        trim_leading_zeros();
+        const size_t len = s.size() - start_idx;
+        if (len <= 18) {
+            // 18 位以内直接放进小值模式
+            int64_t v = 0;
+            for (size_t i = start_idx; i < s.size(); ++i) v = v * 10 + (s[i] - '0');
+            small_ = negative ? -v : v;
+            return;
+        }
+        *this = from_mag(parse_dec(s.data() + start_idx, s.data() + s.size()), negative);
     }
-    BigInt(BigInt&& other) noexcept : digits_(std::move(other.digits_)), is_negative_(other.is_negative_) {
-        other.digits_.clear(); other.is_negative_ = false;
+    BigInt(BigInt&& other) noexcept
+        : small_(other.small_), limbs_(std::move(other.limbs_)), is_negative_(other.is_negative_) {
+        other.small_ = 0; other.limbs_.clear(); other.is_negative_ = false;
     }
     BigInt& operator=(BigInt&& other) noexcept {
-        if (this != &other) { digits_ = std::move(other.digits_); is_negative_ = other.is_negative_; other.digits_.clear(); other.is_negative_ = false; }
+        if (this != &other) {
+            small_ = other.small_; limbs_ = std::move(other.limbs_); is_negative_ = other.is_negative_;
+            other.small_ = 0; other.limbs_.clear(); other.is_negative_ = false;
+        }
         return *this;
     }
 
@@ -283,71 +514,41 @@ public:
     BigInt& operator=(const BigInt& other) = default;
     ~BigInt() = default;
 
+    // 从有符号整数构造（BigInt(size_t) 的有符号版本，不经过字符串）
+    static BigInt from_long_long(const long long val) {
+        return from_u64(small_abs(val), val < 0);
+    }
+
     [[nodiscard]] bool is_negative() const {
-        return is_negative_;
+        return is_small() ? small_ < 0 : is_negative_;
     }
 
     // ========================= 绝对值 =========================
     [[nodiscard]] BigInt abs() const {
         BigInt res = *this;
-        res.is_negative_ = false;
+        if (res.is_small()) {
+            if (res.small_ < 0) res.small_ = -res.small_;
+        } else {
+            res.is_negative_ = false;
+        }
         return res;
     }
 
     // ========================= 比较运算符 =========================
     bool operator==(const BigInt& other) const {
-        if (is_negative_ != other.is_negative_ || digits_.size() != other.digits_.size()) return false;
-        return digits_ == other.digits_;
+        if (is_small() != other.is_small()) return false;
+        if (is_small()) return small_ == other.small_;
+        return is_negative_ == other.is_negative_ && limbs_ == other.limbs_;
     }
     bool operator!=(const BigInt& other) const { return !(*this == other); }
-    bool operator<(const BigInt& other) const {
-        if (is_negative_ != other.is_negative_) return is_negative_;
-        if (digits_.size() != other.digits_.size()) return is_negative_ ? (digits_.size() > other.digits_.size()) : (digits_.size() < other.digits_.size());
-        for (auto it1 = digits_.rbegin(), it2 = other.digits_.rbegin(); it1 != digits_.rend(); ++it1, ++it2) {
-            if (*it1 != *it2) return is_negative_ ? (*it1 > *it2) : (*it1 < *it2);
-        }
-        return false;
-    }
-    bool operator>(const BigInt& other) const { return other < *this; }
-    bool operator<=(const BigInt& other) const { return *this < other || *this == other; }
-    bool operator>=(const BigInt& other) const { return *this > other || *this == other; }
+    bool operator<(const BigInt& other) const { return compare(*this, other) < 0; }
+    bool operator>(const BigInt& other) const { return compare(*this, other) > 0; }
+    bool operator<=(const BigInt& other) const { return compare(*this, other) <= 0; }
+    bool operator>=(const BigInt& other) const { return compare(*this, other) >= 0; }
 
-    // ========================= 核心运算：加法 =========================
+    // ========================= 核心运算：加减 =========================
     BigInt operator+(const BigInt& other) const {
-        BigInt res;
-        res.digits_.clear(); // 清空默认的[0]
-
-        // 情况1：同号（都正或都负）→ 绝对值相加，符号不变
-        if (is_negative_ == other.is_negative_) {
-            res.is_negative_ = is_negative_;
-            uint32_t carry = 0; // 进位（用32位避免溢出）
-            size_t max_len = std::max(digits_.size(), other.digits_.size());
-
-            for (size_t i = 0; i < max_len || carry > 0; ++i) {
-                // 取当前位（不足补0）
-                uint32_t a = (i < digits_.size()) ? digits_[i] : 0;
-                uint32_t b = (i < other.digits_.size()) ? other.digits_[i] : 0;
-                uint32_t sum = a + b + carry;
-
-                res.digits_.push_back(static_cast<uint8_t>(sum % 10));
-                carry = sum / 10;
-            }
-        }
-        // 情况2：异号（一正一负）→ 绝对值相减，符号取绝对值大的
-        else {
-            if (abs_less(other)) {
-                // this绝对值 < other绝对值
-                res = unsigned_subtract(other, *this);
-                res.is_negative_ = other.is_negative_;
-            } else {
-                // this绝对值 >= other绝对值
-                res = unsigned_subtract(*this, other);
-                res.is_negative_ = is_negative_;
-            }
-        }
-
-        res.trim_leading_zeros();
-        return res;
+        return add_signed(*this, other, false);
     }
 
     BigInt& operator+=(const BigInt& other) {
@@ -355,19 +556,10 @@ public:
         return *this;
     }
 
-    // ========================= 核心运算：减法 =========================
     BigInt operator-(const BigInt& other) const {
-        // 特殊情况：减自己 → 0（保留，提升效率）
-        if (*this == other) {
-            return {0};
-        }
-        // 数学本质：a - b = a + (-b) （核心修复，复用加法的正确逻辑）
-        BigInt other_neg = other;       // 复制被减数
-        other_neg.is_negative_ = !other_neg.is_negative_; // 取反被减数的符号（得到相反数）
-        return *this + other_neg;       // 调用正确的加法运算符，完成所有计算
+        return add_signed(*this, other, true);
     }
 
-
     BigInt& operator-=(const BigInt& other) {
         *this = *this - other;
         return *this;
@@ -375,16 +567,17 @@ public:
 
     // ========================= 核心运算：乘法 =========================
     BigInt operator*(const BigInt& other) const {
-        if ((digits_.size() == 1 && digits_[0] == 0) || (other.digits_.size() == 1 && other.digits_[0] == 0)) {
-            return {0};
+        if (is_small() && other.is_small()) {
+            int64_t res;
+            if (!__builtin_mul_overflow(small_, other.small_, &res) && res != INT64_MIN) {
+                BigInt out;
+                out.small_ = res;
+                return out;
+            }
         }
-
-        // 先计算无符号乘法
-        BigInt res = karatsuba_mul(this->abs(), other.abs());
-        // 再设置符号（异或运算：同号得正，异号得负）
-        res.is_negative_ = is_negative_ ^ other.is_negative_;
-        res.trim_leading_zeros();
-        return res;
+        if (is_zero() || other.is_zero()) return {};
+        // 同号得正，异号得负
+        return from_mag(mul_mag(magnitude(), other.magnitude()), is_negative() != other.is_negative());
     }
 
     BigInt& operator*=(const BigInt& other) {
@@ -393,30 +586,25 @@ public:
     }
 
     // ========================= 核心运算：取模 =========================
+    // 余数绝对值为 |a| mod |b|；被除数为负且余数非零时结果为 (|a| mod |b|) - |b|
     BigInt operator%(const BigInt& other) const {
-        // 断言：除数不能为0
-        if(other.digits_.size() == 1 && other.digits_[0] == 0)
+        if (other.is_zero())
             throw NativeFuncError("CalculateError", "BigInt mod: divisor cannot be zero");
-
-        // 特殊情况：被除数为0→结果为0
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            return BigInt(0);
+        if (is_small() && other.is_small()) {
+            const uint64_t b_abs = small_abs(other.small_);
+            const uint64_t rem = small_abs(small_) % b_abs;
+            BigInt out;
+            out.small_ = small_ < 0 && rem != 0
+                ? static_cast<int64_t>(rem) - static_cast<int64_t>(b_abs)
+                : static_cast<int64_t>(rem);
+            return out;
         }
-
-        // 计算被除数、除数的绝对值
-        BigInt a_abs = this->abs();
-        BigInt b_abs = other.abs();
-
-        // 无符号取模（得到非负余数）
-        BigInt remainder = div_mod_unsigned(a_abs, b_abs).second;
-
-        // 调整余数符号（与被除数一致）
-        if (this->is_negative_ && remainder != BigInt(0)) {
-            remainder = remainder - b_abs; // 非零负余数：remainder = - (b_abs - remainder)
+        Mag q, r;
+        divmod_abs(*this, other, q, r);
+        if (is_negative() && !r.empty()) {
+            return from_mag(sub_mag(other.magnitude(), r), true);
         }
-
-        remainder.trim_leading_zeros();
-        return remainder;
+        return from_mag(std::move(r), false);
     }
 
     BigInt& operator%=(const BigInt& other) {
@@ -425,25 +613,18 @@ public:
     }
 
     // ========================= 核心运算：除法 =========================
+    // 向零取整
     BigInt operator/(const BigInt& other) const {
-        // 断言：除数不能为0
-        if(other.digits_.size() == 1 && other.digits_[0] == 0)
+        if (other.is_zero())
             throw NativeFuncError("CalculateError", "divisor cannot be zero");
-
-        // 特殊情况：被除数为0→结果为0
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            return {0};
+        if (is_small() && other.is_small()) {
+            BigInt out;
+            out.small_ = small_ / other.small_;
+            return out;
         }
-
-        // 符号：同号为正，异号为负（异或运算）
-        const bool res_neg = is_negative_ ^ other.is_negative_;
-
-        // 无符号除法取商
-        BigInt quotient = div_mod_unsigned(this->abs(), other.abs()).first;
-        quotient.is_negative_ = res_neg;
-        quotient.trim_leading_zeros();
-
-        return quotient;
+        Mag q, r;
+        divmod_abs(*this, other, q, r);
+        return from_mag(std::move(q), is_negative() != other.is_negative());
     }
 
     BigInt& operator/=(const BigInt& other) {
@@ -454,78 +635,62 @@ public:
     // ========================= 核心运算：幂运算 =========================
     BigInt pow(const BigInt& other) const {
         // 指数必须为非负整数
-        if(other.is_negative_)
+        if (other.is_negative())
             throw NativeFuncError("CalculateError", "use negative int into Bigint.pow is unsupported");
 
-        const BigInt& exp = other;
-        const BigInt zero(0);
-        const BigInt one(1);
+        if (other.is_zero()) return BigInt(1);
+        if (is_zero()) return {};
 
-        // 边界情况：指数为 0 → 结果为 1
-        if (exp == zero) {
-            return one;
+        BigInt result = fast_pow_unsigned(abs(), other);
+        // 底数为负且指数为奇数时结果为负
+        if (is_negative() && other % BigInt(2) == BigInt(1)) {
+            result = BigInt(0) - result;
         }
-
-        // 边界情况：底数为 0 → 结果为 0（指数为正）
-        if (*this == zero) {
-            return zero;
-        }
-
-        // 提取底数的绝对值（后续统一计算正数幂，最后处理符号）
-        BigInt base_abs = this->abs();
-        // 快速幂计算（处理正整数幂）
-        BigInt result_abs = fast_pow_unsigned(base_abs, exp);
-        // 确定结果符号（仅当底数为负且指数为奇数时，结果为负）
-        bool is_result_neg = this->is_negative_ && (exp % BigInt(2) == one);
-        result_abs.is_negative_ = is_result_neg;
-
-        result_abs.trim_leading_zeros();
-        return result_abs;
+        return result;
     }
 
     // ========================= 字符串/数值转换 =========================
     [[nodiscard]] std::string to_string() const {
-        std::string result;
-
-        // 边界处理：若 digits_ 为空（未初始化/零值），直接返回 "0"
-        if (digits_.empty()) {
-            return "0";
-        }
-
-        // 处理负数符号
-        if (is_negative_) {
-            result += '-';
+        if (is_small()) return std::to_string(small_);
+
+        const Mag chunks = to_dec(limbs_);
+        std::string result = is_negative_ ? "-" : "";
+        result += std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const std::string part = std::to_string(chunks[i]);
+            result.append(dec_chunk_digits - part.size(), '0');
+            result += part;
         }
-
-        // 逆序遍历
-        for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
-            // *it 是 0-9 的数字，+'0' 转换为对应的 ASCII 字符（如 3 → '3'）
-            result += static_cast<char>('0' + *it);
-        }
-
         return result;
     }
 
+    // 值能放进 long long 时写入 out 并返回 true, 否则返回 false (不抛异常)
+    [[nodiscard]] bool try_to_long_long(long long& out) const {
+        if (!is_small()) return false;
+        out = small_;
+        return true;
+    }
+
     [[nodiscard]] unsigned long long to_unsigned_long_long() const {
-        // 检查是否为负数
-        if (is_negative_) {
+        if (is_negative()) {
             throw NativeFuncError("CalculateError","BigInt is negative, cannot convert to unsigned long long");
         }
-
-        // 检查是否超出范围
-        const BigInt ull_max_big(ULLONG_MAX);
-        if (*this > ull_max_big) {
+        if (is_small()) return static_cast<unsigned long long>(small_);
+        if (limbs_.size() > 2) {
             throw NativeFuncError("CalculateError","BigInt value exceeds ULLONG_MAX");
         }
+        return static_cast<unsigned long long>(limbs_[1]) << 32 | limbs_[0];
+    }
 
-        unsigned long long result = 0;
-        // 修复核心：逆序遍历 digits_（从高位到低位）
-        for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
-            unsigned char digit = *it;
-            result = result * 10 + digit;
+    // 供哈希表使用的哈希值: 小值直接取值, 大值按limb混合(表示是规范的, 相等的值哈希相同)
+    [[nodiscard]] size_t hash() const {
+        if (is_small()) return static_cast<size_t>(small_);
+        uint64_t h = is_negative_ ? 0x9e3779b97f4a7c15ULL : 0;
+        for (const Limb limb : limbs_) {
+            h = (h ^ limb) * 0x100000001b3ULL;
+            h ^= h >> 29;
         }
-
-        return result;
+        return static_cast<size_t>(h);
     }
 
     // ========================= 友元：输出运算符 =========================
@@ -535,4 +700,4 @@ public:
     }
 };
 
-} // namespace dep
\ No newline at end of file
+} // namespace dep
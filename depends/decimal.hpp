@@ -4,13 +4,31 @@
 #include <cassert>
 #include <algorithm>
 #include <functional>
+#include <iterator>
 
 namespace dep {
 
 class Decimal {
+    // 尾数的绝对值不超过 INT64_MAX（约18位有效数字）时，BigInt 以内联 int64 存放，
+    // 加减乘和对齐都走机器运算，溢出时才自动转为 limb 表示；下面的归一化和 10 的幂也对这种情况走快速路径
     BigInt mantissa_;   // 尾数（包含符号，归一化后无末尾零）
     int exponent_;      // 指数：value = mantissa_ * 10^exponent_
 
+    /**
+     * @brief 10^k（k >= 0），k 不超过 18 时查表
+     */
+    static BigInt pow10(const int k) {
+        static constexpr size_t table[] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+            1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+            100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+            1000000000000000000ull
+        };
+        assert(k >= 0);
+        if (k < static_cast<int>(std::size(table))) return BigInt(table[k]);
+        return BigInt::fast_pow_unsigned(BigInt(10), BigInt(static_cast<size_t>(k)));
+    }
+
     /**
      * @brief 归一化：确保尾数无末尾零，保证表示唯一性
      * 例如：1200×10^-3 → 12×10^-1；-000 → 0×10^0
@@ -21,6 +39,15 @@ class Decimal {
             return;
         }
         // 移除尾数末尾的零，同步调整指数
+        long long small = 0;
+        if (mantissa_.try_to_long_long(small)) {
+            while (small % 10 == 0) {
+                small /= 10;
+                exponent_ += 1;
+            }
+            mantissa_ = BigInt::from_long_long(small);
+            return;
+        }
         BigInt ten(10);
         while (mantissa_ % ten == BigInt(0)) {
             mantissa_ /= ten;
@@ -44,10 +71,9 @@ class Decimal {
         int a_scale = a.exponent_ - common_exp;
         int b_scale = b.exponent_ - common_exp;
 
-        BigInt ten(10);
         // 放大尾数，使两者指数都等于common_exp
-        a_mant = a.mantissa_ * BigInt::fast_pow_unsigned(ten, BigInt(a_scale));
-        b_mant = b.mantissa_ * BigInt::fast_pow_unsigned(ten, BigInt(b_scale));
+        a_mant = a_scale == 0 ? a.mantissa_ : a.mantissa_ * pow10(a_scale);
+        b_mant = b_scale == 0 ? b.mantissa_ : b.mantissa_ * pow10(b_scale);
 
         return common_exp;
     }
@@ -221,11 +247,10 @@ public:
     [[nodiscard]] BigInt integer_part() const {
         if (exponent_ >= 0) {
             // 指数非负：尾数 × 10^exponent
-            return mantissa_ * BigInt::fast_pow_unsigned(BigInt(10), BigInt(exponent_));
+            return mantissa_ * pow10(exponent_);
         } else {
             // 指数为负：尾数 ÷ 10^(-exponent)
-            BigInt ten_pow = BigInt::fast_pow_unsigned(BigInt(10), BigInt(-exponent_));
-            return mantissa_ / ten_pow;
+            return mantissa_ / pow10(-exponent_);
         }
     }
 
@@ -280,8 +305,7 @@ public:
 
         BigInt mant_big(mant_hash);
         BigInt exp_big(exp_hash);
-        BigInt shift_base(1);
-        shift_base = shift_base.pow(BigInt(64));
+        static const BigInt shift_base = BigInt(1).pow(BigInt(64));
 
         return mant_big * shift_base + exp_big;
     }
@@ -301,6 +325,8 @@ public:
     }
 
     bool operator<(const Decimal& other) const {
+        // 异号时不必对齐
+        if (mantissa_.is_negative() != other.mantissa_.is_negative()) return mantissa_.is_negative();
         BigInt a_mant, b_mant;
         align_exponent(*this, other, a_mant, b_mant);
         return a_mant < b_mant;
@@ -463,7 +489,7 @@ public:
         }
 
         // 计算10^n用于缩放
-        BigInt scale = BigInt::fast_pow_unsigned(BigInt(10), BigInt(n));
+        BigInt scale = pow10(n);
 
         // 分离小数部分
         Decimal this_fraction = *this - Decimal(this_int);
@@ -499,10 +525,8 @@ public:
         // 对齐指数（抵消a/b的指数影响）
         align_exponent(*this, other, a_mant, b_mant);
 
-        BigInt ten(10);
         // 补零扩展被除数：乘以 10^n，用于保留n位小数
-        BigInt scale = BigInt::fast_pow_unsigned(ten, BigInt(n));
-        BigInt dividend = a_mant * scale;
+        BigInt dividend = a_mant * pow10(n);
 
         // 整数除法（截断余数）
         BigInt quotient = dividend / b_mant;
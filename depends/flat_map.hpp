@@ -0,0 +1,340 @@
+/**
+ * @file flat_map.hpp
+ * @brief HashMap与Dict共用的开放寻址哈希表
+ * 键值对按插入顺序连续存放在entries_中; 另有一张控制字节表(ctrl_)和等长的下标表(slots_)作为索引,
+ * 每16个控制字节为一组, 查找时一次比较整组(有SSE2时用SIMD, 否则逐字节), 组内没有空位才探测下一组.
+ * 控制字节为空(-128), 已删除(-2), 或者哈希值的低7位(0~127); 哈希值的其余位决定从哪一组开始探测.
+ * 不超过small_limit个键时不建索引, 直接顺序比较entries_, 大多数小表只需要一次内存访问.
+ * 删除时把最后一个键值对挪到空出的位置, 因此删除过键的表不再保持插入顺序.
+ * 插入会使find返回的指针失效
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace dep {
+
+namespace flat_detail {
+
+constexpr int8_t ctrl_empty = -128;
+constexpr int8_t ctrl_deleted = -2;
+constexpr size_t group_width = 16;
+
+// 一组16个控制字节, 各match函数返回匹配位置的位掩码
+class Group {
+public:
+    explicit Group(const int8_t* pos) {
+#if defined(__SSE2__)
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+#else
+        for (size_t i = 0; i < group_width; ++i) ctrl_[i] = pos[i];
+#endif
+    }
+
+    [[nodiscard]] uint32_t match(const int8_t h2) const {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_width; ++i) {
+            if (ctrl_[i] == h2) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    [[nodiscard]] uint32_t match_empty() const {
+        return match(ctrl_empty);
+    }
+
+    // 空位或已删除(两者都小于-1)
+    [[nodiscard]] uint32_t match_free() const {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_width; ++i) {
+            if (ctrl_[i] < -1) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#else
+    int8_t ctrl_[group_width];
+#endif
+};
+
+inline size_t lowest_bit(const uint32_t mask) {
+    return static_cast<size_t>(__builtin_ctz(mask));
+}
+
+// 打散键的原始哈希(BigInt小值的哈希就是它本身), 让低7位和高位都足够随机
+inline size_t mix_hash(const size_t hash) {
+    const uint64_t h = static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+} // namespace flat_detail
+
+/**
+ * @tparam KT 键类型
+ * @tparam VT 值类型
+ * @tparam Traits 提供lookup_type(查找时使用的键类型, 如std::string_view), hash(lookup_type)与
+ *         equal(const KT&, lookup_type)
+ */
+template <typename KT, typename VT, typename Traits>
+class FlatMap {
+public:
+    using Lookup = typename Traits::lookup_type;
+
+    struct Node {
+        KT key;
+        VT value;
+        size_t hash; // 打散后的哈希值, 扩容时不必重新计算
+    };
+
+    static constexpr size_t small_limit = 4;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const std::vector<std::pair<KT, VT>>& vec) {
+        entries_.reserve(vec.size());
+        if (vec.size() > small_limit) rehash(capacity_for(vec.size()));
+        for (const auto& [key, val] : vec) {
+            insert(key, val);
+        }
+    }
+
+    /**
+     * @brief 插入/更新键值对
+     * @return 键已存在时返回被替换的旧值, 否则返回 VT()
+     */
+    VT insert(Lookup key, VT val) {
+        const size_t hash = flat_detail::mix_hash(Traits::hash(key));
+        if (const size_t idx = find_index(key, hash); idx != npos) {
+            VT old_val = std::move(entries_[idx].value);
+            entries_[idx].value = std::move(val);
+            return old_val;
+        }
+
+        entries_.push_back(Node{KT(key), std::move(val), hash});
+        if (ctrl_.empty()) {
+            if (entries_.size() > small_limit) rehash(capacity_for(entries_.size()));
+        } else if ((entries_.size() + tombstones_) * 8 > ctrl_.size() * 7) {
+            rehash(capacity_for(entries_.size() * 2));
+        } else {
+            place(hash, static_cast<uint32_t>(entries_.size() - 1));
+        }
+        return VT();
+    }
+
+    [[nodiscard]] Node* find(Lookup key) {
+        const size_t idx = find_index(key, flat_detail::mix_hash(Traits::hash(key)));
+        return idx == npos ? nullptr : &entries_[idx];
+    }
+
+    [[nodiscard]] const Node* find(Lookup key) const {
+        const size_t idx = find_index(key, flat_detail::mix_hash(Traits::hash(key)));
+        return idx == npos ? nullptr : &entries_[idx];
+    }
+
+    bool del(Lookup key) {
+        const size_t hash = flat_detail::mix_hash(Traits::hash(key));
+        if (ctrl_.empty()) {
+            const size_t idx = find_index(key, hash);
+            if (idx == npos) return false;
+            entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(idx));
+            return true;
+        }
+
+        const size_t pos = find_slot(key, hash);
+        if (pos == npos) return false;
+        const uint32_t idx = slots_[pos];
+        // 所在组里还有空位说明没有探测序列经过这一组, 可以直接标为空位而不留墓碑
+        const size_t group_start = pos & ~(flat_detail::group_width - 1);
+        if (flat_detail::Group(&ctrl_[group_start]).match_empty()) {
+            ctrl_[pos] = flat_detail::ctrl_empty;
+        } else {
+            ctrl_[pos] = flat_detail::ctrl_deleted;
+            ++tombstones_;
+        }
+
+        const auto last = static_cast<uint32_t>(entries_.size() - 1);
+        if (idx != last) {
+            slots_[find_slot_of(last)] = idx;
+            entries_[idx] = std::move(entries_[last]);
+        }
+        entries_.pop_back();
+        return true;
+    }
+
+    // 按存放顺序访问键值对, 不复制
+    [[nodiscard]] const std::vector<Node>& entries() const {
+        return entries_;
+    }
+
+    [[nodiscard]] std::vector<std::pair<KT, VT>> to_vector() const {
+        std::vector<std::pair<KT, VT>> vec;
+        vec.reserve(entries_.size());
+        for (const auto& node : entries_) {
+            vec.emplace_back(node.key, node.value);
+        }
+        return vec;
+    }
+
+    // 按存放顺序遍历所有值(不复制)
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& node : entries_) {
+            f(node.value);
+        }
+    }
+
+    // 转换为字符串（需VT支持to_string()成员函数或为指针）
+    [[nodiscard]] std::string to_string() const {
+        std::stringstream ss;
+        ss << "{ ";
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const auto& node = entries_[i];
+            if constexpr (std::is_same_v<KT, std::string>) {
+                ss << node.key << ": ";
+            } else {
+                ss << node.key.to_string() << ": ";
+            }
+            if constexpr (std::is_pointer_v<VT>) {
+                ss << static_cast<void*>(node.value);
+            } else {
+                ss << node.value.to_string();
+            }
+            if (i + 1 < entries_.size()) ss << ", ";
+        }
+        ss << " }";
+        return ss.str();
+    }
+
+    void clear() {
+        entries_.clear();
+        ctrl_.clear();
+        slots_.clear();
+        tombstones_ = 0;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return entries_.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return entries_.empty();
+    }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    std::vector<Node> entries_;
+    std::vector<int8_t> ctrl_;    // 为空时处于小表模式
+    std::vector<uint32_t> slots_; // 与ctrl_等长, 满的位置存entries_的下标
+    size_t tombstones_ = 0;
+
+    static int8_t h2_of(const size_t hash) {
+        return static_cast<int8_t>(hash & 0x7f);
+    }
+
+    // 装载率不超过7/8的最小容量(16的倍数, 2的幂)
+    static size_t capacity_for(const size_t count) {
+        size_t capacity = flat_detail::group_width;
+        while (count * 8 > capacity * 7) capacity *= 2;
+        return capacity;
+    }
+
+    // 依次产生探测的组起点: 从哈希高位决定的组开始, 按三角数步长跳组, 组数为2的幂时能走遍所有组
+    template <typename F>
+    size_t probe(const size_t hash, F&& visit_group) const {
+        const size_t group_mask = ctrl_.size() / flat_detail::group_width - 1;
+        size_t group = (hash >> 7) & group_mask;
+        for (size_t step = 1; ; ++step) {
+            const size_t start = group * flat_detail::group_width;
+            const flat_detail::Group g(&ctrl_[start]);
+            if (const size_t found = visit_group(start, g); found != npos) return found;
+            if (g.match_empty()) return npos;
+            if (step > group_mask) return npos;
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // 键在ctrl_/slots_中的位置
+    size_t find_slot(Lookup key, const size_t hash) const {
+        return probe(hash, [&](const size_t start, const flat_detail::Group& g) {
+            for (uint32_t mask = g.match(h2_of(hash)); mask; mask &= mask - 1) {
+                const size_t pos = start + flat_detail::lowest_bit(mask);
+                const Node& node = entries_[slots_[pos]];
+                if (node.hash == hash and Traits::equal(node.key, key)) return pos;
+            }
+            return npos;
+        });
+    }
+
+    // 指向entries_[idx]的位置(用于删除时修正被挪动的键值对)
+    size_t find_slot_of(const uint32_t idx) const {
+        const size_t hash = entries_[idx].hash;
+        return probe(hash, [&](const size_t start, const flat_detail::Group& g) {
+            for (uint32_t mask = g.match(h2_of(hash)); mask; mask &= mask - 1) {
+                const size_t pos = start + flat_detail::lowest_bit(mask);
+                if (slots_[pos] == idx) return pos;
+            }
+            return npos;
+        });
+    }
+
+    size_t find_index(Lookup key, const size_t hash) const {
+        if (ctrl_.empty()) {
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                if (entries_[i].hash == hash and Traits::equal(entries_[i].key, key)) return i;
+            }
+            return npos;
+        }
+        const size_t pos = find_slot(key, hash);
+        return pos == npos ? npos : slots_[pos];
+    }
+
+    // 在第一个空位或墓碑处登记entries_[idx]
+    void place(const size_t hash, const uint32_t idx) {
+        const size_t group_mask = ctrl_.size() / flat_detail::group_width - 1;
+        size_t group = (hash >> 7) & group_mask;
+        for (size_t step = 1; ; ++step) {
+            const size_t start = group * flat_detail::group_width;
+            if (const uint32_t mask = flat_detail::Group(&ctrl_[start]).match_free()) {
+                const size_t pos = start + flat_detail::lowest_bit(mask);
+                if (ctrl_[pos] == flat_detail::ctrl_deleted) --tombstones_;
+                ctrl_[pos] = h2_of(hash);
+                slots_[pos] = idx;
+                return;
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    void rehash(const size_t capacity) {
+        ctrl_.assign(capacity, flat_detail::ctrl_empty);
+        slots_.assign(capacity, 0);
+        tombstones_ = 0;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            place(entries_[i].hash, static_cast<uint32_t>(i));
+        }
+    }
+};
+
+} // namespace dep
@@ -4,25 +4,24 @@
 namespace model {
 
 // Bool.__call__
-Object* bool_call(Object* self, const List* args) {
-    const auto a = builtin::get_one_arg(args);
+Object* bool_call(Object* self, Object* const* argv, size_t argc) {
+    const auto a = builtin::get_one_arg(argv, argc);
     return load_bool(
         kiz::Vm::is_true(a)
     );
 }
 
-Object* bool_str(Object* self, const List* args) {
-    const auto s = dynamic_cast<Bool*>(self);
-    return new String(s->val ? "True" : "False");
+Object* bool_str(Object* self, Object* const* argv, size_t argc) {
+    const auto s = as<Bool>(self);
+    return create_str(s->val ? "True" : "False");
 }
 
 
 // Bool.__eq__ 布尔值相等判断：self == args[0]（仅支持Bool与Bool比较）
-Object* bool_eq(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* bool_eq(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_bool = dynamic_cast<Bool*>(self);
-    auto another_bool = dynamic_cast<Bool*>(args->val[0]);
+    auto self_bool = as<Bool>(self);
+    auto another_bool = as<Bool>(argv[0]);
     if (!another_bool)
         throw NativeFuncError("TypeError", "Bool.eq only supports Bool type argument");
     
@@ -30,12 +29,12 @@ Object* bool_eq(Object* self, const List* args) {
 }
 
 // Bool.__hash__
-Object* bool_hash(Object* self, const List* args) {
-    auto self_bool = dynamic_cast<Bool*>(self);
+Object* bool_hash(Object* self, Object* const* argv, size_t argc) {
+    auto self_bool = as<Bool>(self);
     if (self_bool->val == true) {
-        return kiz::Vm::small_int_pool[1];
+        return load_int(1);
     }
-    return kiz::Vm::small_int_pool[0];
+    return load_int(0);
 }
 
 
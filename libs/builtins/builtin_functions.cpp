@@ -9,35 +9,34 @@
 
 namespace builtin {
 
-model::Object* print(model::Object* self, const model::List* args) {
+model::Object* print(model::Object* self, model::Object* const* argv, size_t argc) {
     dep::UTF8String text;
-    for (auto arg : args->val) {
+    for (auto arg : std::span(argv, argc)) {
         text += dep::UTF8String(kiz::Vm::obj_to_str(arg)) + " ";
     }
     std::cout << text << std::endl;
     return model::load_nil();
 }
 
-model::Object* input(model::Object* self, const model::List* args) {
-    if (! args->val.empty()) {
-        const auto prompt_obj = get_one_arg(args);
+model::Object* input(model::Object* self, model::Object* const* argv, size_t argc) {
+    if (argc != 0) {
+        const auto prompt_obj = get_one_arg(argv, argc);
         std::cout << model::cast_to_str(prompt_obj)->val;
     }
     std::string result;
     std::getline(std::cin, result);
-    return new model::String(result);
+    return model::create_str(result);
 }
 
-model::Object* ischild(model::Object* self, const model::List* args) {
-    kiz::Vm::assert_argc(2, args);
+model::Object* ischild(model::Object* self, model::Object* const* argv, size_t argc) {
 
-    const auto a = args->val[0];
-    const auto b = args->val[1];
+    const auto a = argv[0];
+    const auto b = argv[1];
     return check_based_object(a, b);
     
 }
 
-model::Object* help(model::Object* self, const model::List* args) {
+model::Object* help(model::Object* self, model::Object* const* argv, size_t argc) {
     const std::string text = R"(
 The kiz help
 
@@ -79,10 +78,10 @@ Built-in Objects:
     return model::load_nil();
 }
 
-model::Object* breakpoint(model::Object* self, const model::List* args) {
+model::Object* breakpoint(model::Object* self, model::Object* const* argv, size_t argc) {
     size_t i = 0;
-    for (auto& frame: kiz::Vm::call_stack) {
-        std::cout << "Frame [" << i << "] " << frame->name << "\n";
+    for (const auto& frame: kiz::Vm::call_stack) {
+        std::cout << "Frame [" << i << "] " << frame->name() << "\n";
         std::cout << "=================================" << "\n";
         std::cout << "Owner: " << kiz::Vm::obj_to_debug_str(frame->owner) << "\n";
         std::cout << "Pc: " << frame->pc << "\n";
@@ -109,7 +108,7 @@ model::Object* breakpoint(model::Object* self, const model::List* args) {
         std::cout << "AttrNames: ";
         j = 1;
         for (const auto& n: frame->code_object->attr_names) {
-            std::cout << n;
+            std::cout << n.str();
             if (j<frame->code_object->attr_names.size()) std::cout << ", ";
             ++j;
         }
@@ -147,8 +146,8 @@ model::Object* breakpoint(model::Object* self, const model::List* args) {
     throw KizStopRunningSignal();
 }
 
-model::Object* cmd(model::Object* self, const model::List* args) {
-    auto arg_vector = args->val;
+model::Object* cmd(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
     if (arg_vector.empty()) {
         return model::load_nil();
     }
@@ -157,16 +156,16 @@ model::Object* cmd(model::Object* self, const model::List* args) {
     return model::load_nil();
 }
 
-model::Object* now(model::Object* self, const model::List* args) {
+model::Object* now(model::Object* self, model::Object* const* argv, size_t argc) {
     auto now =
         std::chrono::high_resolution_clock::now()
         .time_since_epoch();
     int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
-    return new model::Int( dep::BigInt(std::to_string(time)) );
+    return model::load_int(time);
 }
 
-model::Object* range(model::Object* self, const model::List* args) {
-    auto arg_vector = args->val;
+model::Object* range(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
     std::vector<model::Object*> range_vector;
     dep::BigInt start_int = 0;
     dep::BigInt step_int = 1;
@@ -198,27 +197,28 @@ model::Object* range(model::Object* self, const model::List* args) {
         auto end_obj = arg_vector[2];
         auto end_int_obj = model::cast_to_int(end_obj);
         end_int = end_int_obj->val;
-    } else kiz::Vm::assert_argc({1,2,3}, args);
+    } else kiz::Vm::assert_argc({1,2,3}, argc);
 
     for (dep::BigInt i = start_int; i < end_int; i+=step_int) {
-        auto i_obj = new model::Int(i);
+        auto i_obj = model::load_int(i);
         range_vector.emplace_back(i_obj);
     }
-    return new model::List(range_vector);
+    return model::create_list(range_vector);
 }
 
-model::Object* setattr(model::Object* self, const model::List* args) {
-    const auto arg_vector = args->val;
-    kiz::Vm::assert_argc(3, args);
+model::Object* setattr(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
+    kiz::Vm::assert_argc(3, argc);
     auto for_set = arg_vector[0];
     auto attr_name = arg_vector[1];
     auto value = arg_vector[2];
+    kiz::Vm::note_attr_write(for_set);
     for_set->attrs_insert(model::cast_to_str(attr_name)->val, value);
     return model::load_nil();
 }
 
-model::Object* getattr(model::Object* self, const model::List* args) {
-    auto arg_vector = args->val;
+model::Object* getattr(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
     model::Object* obj;
     model::Object* attr_name;
     model::Object* default_value =  model::load_nil();
@@ -253,21 +253,21 @@ model::Object* getattr(model::Object* self, const model::List* args) {
         }
 
     }
-    kiz::Vm::assert_argc({2,3,4}, args);
+    kiz::Vm::assert_argc({2,3,4}, argc);
 }
 
-model::Object* delattr(model::Object* self, const model::List* args) {
-    kiz::Vm::assert_argc(2, args);
-    auto arg_vector = args->val;
+model::Object* delattr(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
 
     model::Object* obj = arg_vector[0];
     model::Object* attr_name = arg_vector[1];
-    obj->attrs.del(model::cast_to_str(attr_name)->val);
+    kiz::Vm::note_attr_write(obj);
+    obj->attrs_del(model::cast_to_str(attr_name)->val);
     return model::load_nil();
 }
 
-model::Object* hasattr(model::Object* self, const model::List* args) {
-    auto arg_vector = args->val;
+model::Object* hasattr(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
     model::Object* obj;
     model::Object* attr_name;
     if (arg_vector.size() == 2) {
@@ -298,35 +298,35 @@ model::Object* hasattr(model::Object* self, const model::List* args) {
             return model::load_false();
         }
     }
-    kiz::Vm::assert_argc({2,3}, args);
+    kiz::Vm::assert_argc({2,3}, argc);
 }
 
-model::Object* get_refc(model::Object* self, const model::List* args) {
-    const auto obj = get_one_arg(args);
-    return new model::Int( obj->get_refc_() );
+model::Object* get_refc(model::Object* self, model::Object* const* argv, size_t argc) {
+    const auto obj = get_one_arg(argv, argc);
+    return model::load_int( obj->get_refc_() );
 }
 
-model::Object* create(model::Object* self, const model::List* args) {
-    if (args->val.empty()) {
+model::Object* create(model::Object* self, model::Object* const* argv, size_t argc) {
+    if (argc == 0) {
         auto o = new model::Object();
 
-        o->attrs_insert("__parent__", model::based_obj);
+        o->attrs_insert(model::magic_name::parent, model::based_obj);
 
         return o;
     }
-    const auto obj = get_one_arg(args);
+    const auto obj = get_one_arg(argv, argc);
     if (obj->get_type() != model::Object::ObjectType::Object) {
         throw NativeFuncError("TypeError", "Cannot create object from a instance of a native type");
     }
     const auto new_obj = new model::Object();
 
-    new_obj->attrs_insert("__parent__", obj);
+    new_obj->attrs_insert(model::magic_name::parent, obj);
 
     return new_obj;
 }
 
-model::Object* type_of_obj(model::Object* self, const model::List* args) {
-    const auto for_check = get_one_arg(args);
+model::Object* type_of_obj(model::Object* self, model::Object* const* argv, size_t argc) {
+    const auto for_check = get_one_arg(argv, argc);
     std::string type_str;
     switch (for_check->get_type()) {
         case model::Object::ObjectType::Bool: type_str = "Bool"; break;
@@ -344,37 +344,36 @@ model::Object* type_of_obj(model::Object* self, const model::List* args) {
         case model::Object::ObjectType::Module: type_str = "Module"; break;
         default: type_str = "<Unknown>"; break;
     }
-    return new model::String(type_str);
+    return model::create_str(type_str);
 }
 
-model::Object* debug_str(model::Object* self, const model::List* args) {
-    auto for_check = get_one_arg(args);
+model::Object* debug_str(model::Object* self, model::Object* const* argv, size_t argc) {
+    auto for_check = get_one_arg(argv, argc);
     auto debug_str = kiz::Vm::obj_to_debug_str(for_check);
-    return new model::String(debug_str);
+    return model::create_str(debug_str);
 }
 
-model::Object* attr(model::Object* self, const model::List* args) {
-    auto obj = get_one_arg(args);
+model::Object* attr(model::Object* self, model::Object* const* argv, size_t argc) {
+    auto obj = get_one_arg(argv, argc);
     std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
     for (auto& [name, obj]: obj->attrs.to_vector()) {
         obj->make_ref();
         elem_list.emplace_back(dep::hash_string(name),
-            std::pair {new model::String(name), obj}
+            std::pair {model::create_str(name), obj}
         );
     }
     return new model::Dictionary(dep::Dict(elem_list));
 }
 
-model::Object* sleep(model::Object* self, const model::List* args) {
-    auto time = model::cast_to_int(get_one_arg(args)) ->val.to_unsigned_long_long();
+model::Object* sleep(model::Object* self, model::Object* const* argv, size_t argc) {
+    auto time = model::cast_to_int(get_one_arg(argv, argc)) ->val.to_unsigned_long_long();
     std::this_thread::sleep_for(std::chrono::milliseconds(time));
     return model::load_nil();
 }
 
-model::Object* open(model::Object* self, const model::List* args) {
-    kiz::Vm::assert_argc(2, args);
-    auto path = cast_to_str(args->val[0])->val;
-    auto mode = cast_to_str(args->val[1])->val;
+model::Object* open(model::Object* self, model::Object* const* argv, size_t argc) {
+    auto path = cast_to_str(argv[0])->val;
+    auto mode = cast_to_str(argv[1])->val;
 
     auto real_path = kiz::Vm::get_exe_abs_dir() / kiz::Vm::get_current_file_path().parent_path() / path;
 
@@ -409,17 +408,17 @@ model::Object* open(model::Object* self, const model::List* args) {
     }
 
     auto fh_obj = new model::FileHandle();
-    fh_obj->attrs_insert("__parent__", model::based_file_handle);
-    fh_obj->attrs_insert("mode", new model::String(mode));
-    fh_obj->attrs_insert("path", new model::String(real_path.string()));
+    fh_obj->attrs_insert(model::magic_name::parent, model::based_file_handle);
+    fh_obj->attrs_insert("mode", model::create_str(mode));
+    fh_obj->attrs_insert("path", model::create_str(real_path.string()));
     fh_obj->file_handle = file_stream; // 核心：存储文件句柄
 
     return fh_obj;
 }
 
 
-model::Object* assert_(model::Object* self, const model::List* args) {
-    auto args_vec = args->val;
+model::Object* assert_(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::span args_vec(argv, argc);
     std::string msg = "...";
     if (args_vec.size() == 1) {
         if (kiz::Vm::is_true(args_vec[0])) {
@@ -431,13 +430,13 @@ model::Object* assert_(model::Object* self, const model::List* args) {
             return model::load_nil();
         }
         msg = model::cast_to_str(args_vec[1]) ->val;
-    } else kiz::Vm::assert_argc({1,2}, args);
+    } else kiz::Vm::assert_argc({1,2}, argc);
 
     throw NativeFuncError("Assert", msg);
 }
 
-model::Object* panic(model::Object* self, const model::List* args) {
-    std::string msg = model::cast_to_str(args->val[0]) ->val;
+model::Object* panic(model::Object* self, model::Object* const* argv, size_t argc) {
+    std::string msg = model::cast_to_str(argv[0]) ->val;
     std::cout << Color::BRIGHT_RED << "A Panic! : " << Color::RESET << msg << std::endl;
     exit(3);
 }
@@ -6,20 +6,20 @@
 namespace model {
 
 // Decimal.__call__：构造Decimal对象（支持字符串/Int/Decimal初始化）
-Object* decimal_call(Object* self, const List* args) {
-    auto a = builtin::get_one_arg(args);
+Object* decimal_call(Object* self, Object* const* argv, size_t argc) {
+    auto a = builtin::get_one_arg(argv, argc);
     dep::Decimal val(0);
 
     // 从String初始化（如 "123.45", "-67.89e2"）
-    if (auto s = dynamic_cast<String*>(a)) {
+    if (auto s = as<String>(a)) {
         val = dep::Decimal(s->val);
     }
     // 从Int初始化
-    else if (auto i = dynamic_cast<Int*>(a)) {
+    else if (auto i = as<Int>(a)) {
         val = dep::Decimal(i->val);
     }
     // 从Decimal初始化（拷贝）
-    else if (auto d = dynamic_cast<Decimal*>(a)) {
+    else if (auto d = as<Decimal>(a)) {
         val = d->val;
     }
     // 假值（Nil/Bool(false)）初始化为0
@@ -31,27 +31,26 @@ Object* decimal_call(Object* self, const List* args) {
 }
 
 // Decimal.__bool__：非零判断（0为false，其余为true）
-Object* decimal_bool(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+Object* decimal_bool(Object* self, Object* const* argv, size_t argc) {
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
     // 0的Decimal（mantissa=0，exponent=0）返回false
     return load_bool(!(self_dec->val == dep::Decimal(0)));
 }
 
 // Decimal.__add__：加法（self + args[0]），支持Int/Decimal
-Object* decimal_add(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_add(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int相加
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal res = self_dec->val + another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相加
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         dep::Decimal res = self_dec->val + another_dec->val;
         return new Decimal(res);
     }
@@ -60,19 +59,18 @@ Object* decimal_add(Object* self, const List* args) {
 }
 
 // Decimal.__sub__：减法（self - args[0]），支持Int/Decimal
-Object* decimal_sub(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_sub(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int相减
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal res = self_dec->val - another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相减
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         dep::Decimal res = self_dec->val - another_dec->val;
         return new Decimal(res);
     }
@@ -81,19 +79,18 @@ Object* decimal_sub(Object* self, const List* args) {
 }
 
 // Decimal.__mul__：乘法（self * args[0]），支持Int/Decimal
-Object* decimal_mul(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_mul(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int相乘
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal res = self_dec->val * another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相乘
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         dep::Decimal res = self_dec->val * another_dec->val;
         return new Decimal(res);
     }
@@ -102,10 +99,9 @@ Object* decimal_mul(Object* self, const List* args) {
 }
 
 // Decimal.__div__：除法（self / args[0]），支持Int/Decimal（默认保留10位小数）
-Object* decimal_div(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_div(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 除数不能为0（提前检查）
@@ -114,7 +110,7 @@ Object* decimal_div(Object* self, const List* args) {
     };
 
     // 与Int相除
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal divisor(another_int->val);
         if(check_zero(divisor))
             throw NativeFuncError("CalculateError", "decimal_div: division by zero");
@@ -123,7 +119,7 @@ Object* decimal_div(Object* self, const List* args) {
         return new Decimal(res);
     }
     // 与Decimal相除
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         if(check_zero(another_dec->val) )
             throw NativeFuncError("CalculateError",  "decimal_div: division by zero");
 
@@ -135,14 +131,13 @@ Object* decimal_div(Object* self, const List* args) {
 }
 
 // Decimal.__pow__：幂运算（self ^ args[0]），仅支持Int类型的指数（非负）
-Object* decimal_pow(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_pow(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 指数仅支持Int（非负）
-    auto exp_int = dynamic_cast<Int*>(args->val[0]);
+    auto exp_int = as<Int>(argv[0]);
     if (!exp_int)
         throw NativeFuncError("TypeError", "Decimal.pow second arg need be Int");
 
@@ -154,19 +149,18 @@ Object* decimal_pow(Object* self, const List* args) {
 }
 
 // Decimal.__eq__：相等判断（self == args[0]），支持Int/Decimal
-Object* decimal_eq(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_eq(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val == cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         return load_bool(self_dec->val == another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -174,19 +168,18 @@ Object* decimal_eq(Object* self, const List* args) {
 }
 
 // Decimal.__lt__：小于判断（self < args[0]），支持Int/Decimal
-Object* decimal_lt(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_lt(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val < cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         return load_bool(self_dec->val < another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -194,20 +187,19 @@ Object* decimal_lt(Object* self, const List* args) {
 }
 
 // Decimal.__gt__：大于判断（self > args[0]），支持Int/Decimal
-Object* decimal_gt(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* decimal_gt(Object* self, Object* const* argv, size_t argc) {
 
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val > cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = as<Decimal>(argv[0])) {
         return load_bool(self_dec->val > another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -215,9 +207,9 @@ Object* decimal_gt(Object* self, const List* args) {
 }
 
 // Decimal.__neg__：取反操作(-self)
-Object* decimal_neg(Object* self, const List* args) {
+Object* decimal_neg(Object* self, Object* const* argv, size_t argc) {
     // 确保调用者是Decimal对象
-    auto self_dec = dynamic_cast<Decimal*>(self);
+    auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
 
     // 对Decimal值取反（0 - self_val 或直接用重载的-运算符）
@@ -227,21 +219,20 @@ Object* decimal_neg(Object* self, const List* args) {
 }
 
 // Decimal.__hash__
-Object* decimal_hash(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+Object* decimal_hash(Object* self, Object* const* argv, size_t argc) {
+    const auto self_dec = as<Decimal>(self);
     assert(self_dec != nullptr);
-    return new Int(self_dec->val.hash());
+    return load_int(self_dec->val.hash());
 }
 
 
 // Decimal.limit_div：除法（self / args[0]），支持Int/Decimal（保留指定位小数）
-Object* decimal_limit_div(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
+Object* decimal_limit_div(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
 
     // 解析保留小数位数（转为int，避免BigInt越界）
-    const auto n_obj = cast_to_int(args->val[1]);
+    const auto n_obj = cast_to_int(argv[1]);
 
     // 确保n是小整数（避免超出int范围）
     if(n_obj->val >= dep::BigInt(1000))
@@ -250,11 +241,11 @@ Object* decimal_limit_div(Object* self, const List* args) {
 
     dep::Decimal divisor;
     // 处理除数为Int
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         divisor = dep::Decimal(another_int->val);
     }
     // 处理除数为Decimal
-    else if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec = as<Decimal>(argv[0])) {
         divisor = another_dec->val;
     }
     else {
@@ -272,13 +263,12 @@ Object* decimal_limit_div(Object* self, const List* args) {
 }
 
 // Decimal.week_eq
-Object* decimal_approx(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
+Object* decimal_approx(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
 
     // 解析保留小数位数
-    const auto n_obj = cast_to_int(args->val[1]);
+    const auto n_obj = cast_to_int(argv[1]);
 
     // 确保n是小整数
     if (n_obj->val <= dep::BigInt(0))
@@ -290,10 +280,10 @@ Object* decimal_approx(Object* self, const List* args) {
 
     // 处理要比较的数
     dep::Decimal other_dec;
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         other_dec = dep::Decimal(another_int->val);
     }
-    else if (auto another_dec_obj = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec_obj = as<Decimal>(argv[0])) {
         other_dec = another_dec_obj->val;
     }
     else {
@@ -307,13 +297,12 @@ Object* decimal_approx(Object* self, const List* args) {
 }
 
 // Decimal.round_div
-Object* decimal_round_div(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
+Object* decimal_round_div(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = as<Decimal>(self);
 
     // 解析保留小数位数
-    const auto n_obj = cast_to_int(args->val[1]);
+    const auto n_obj = cast_to_int(argv[1]);
 
     // 确保n是小整数
     if (n_obj->val < dep::BigInt(0))
@@ -325,11 +314,11 @@ Object* decimal_round_div(Object* self, const List* args) {
 
     dep::Decimal divisor;
     // 处理除数为Int
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = as<Int>(argv[0])) {
         divisor = dep::Decimal(another_int->val);
     }
     // 处理除数为Decimal
-    else if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec = as<Decimal>(argv[0])) {
         divisor = another_dec->val;
     }
     else {
@@ -346,9 +335,9 @@ Object* decimal_round_div(Object* self, const List* args) {
     return new Decimal(res);
 }
 
-Object* decimal_str(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    return new String(self_dec->val.to_string());
+Object* decimal_str(Object* self, Object* const* argv, size_t argc) {
+    const auto self_dec = as<Decimal>(self);
+    return create_str(self_dec->val.to_string());
 }
 
 }  // namespace model
\ No newline at end of file
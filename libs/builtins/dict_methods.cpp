@@ -5,11 +5,11 @@ namespace model {
 
 dep::BigInt hash_object(Object* key_obj) {
     // hash对象
-    kiz::Vm::call_method(key_obj, "__hash__", {});
+    kiz::Vm::call_method(key_obj, model::magic_name::hash, {});
 
     const auto result = kiz::Vm::get_and_pop_stack_top();
 
-    const auto result_int = dynamic_cast<Int*>(result.get());
+    const auto result_int = as<Int>(result.get());
     if (!result_int)
         throw NativeFuncError("TypeError", "Object's hash method return a value which type isn't Int");
     dep::BigInt key_hash_val = result_int->val;
@@ -17,13 +17,12 @@ dep::BigInt hash_object(Object* key_obj) {
 }
 
 // Dictionary.__add__
-Object* dict_add(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* dict_add(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = as<Dictionary>(self);
     assert(self_dict != nullptr);
     
-    auto another_dict = dynamic_cast<Dictionary*>(args->val[0]);
+    auto another_dict = as<Dictionary>(argv[0]);
     if (! another_dict)
         throw NativeFuncError("TypeError", "Dict.add first argument must be Dict type");
 
@@ -39,20 +38,18 @@ Object* dict_add(Object* self, const List* args) {
     auto new_dict = new Dictionary(dep::Dict(
         self_dict_to_vec
     ));
-    new_dict->make_ref();
     
     return new_dict;
 };
 
 // Dictionary.contains：判断是否包含指定键（key: String），返回Bool
-Object* dict_contains(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* dict_contains(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = as<Dictionary>(self);
     assert(self_dict != nullptr);
     
     // 键
-    auto key_obj = args->val[0];
+    auto key_obj = argv[0];
     dep::BigInt key_hash_val = hash_object(key_obj);
 
     auto found_pair_it = self_dict->val.find(
@@ -65,23 +62,27 @@ Object* dict_contains(Object* self, const List* args) {
     return load_false();
 };
 
-Object* dict_setitem(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    auto key_obj = args->val[0];
-    auto value_obj = args->val[1];
+Object* dict_setitem(Object* self, Object* const* argv, size_t argc) {
+    auto self_dict = as<Dictionary>(self);
+    auto key_obj = argv[0];
+    auto value_obj = argv[1];
     dep::BigInt key_hash_val = hash_object(key_obj);
 
-    self_dict->val.insert(
+    key_obj->make_ref();
+    value_obj->make_ref();
+    auto [old_key, old_value] = self_dict->val.insert(
         key_hash_val,
         std::pair{key_obj, value_obj}
     );
+    // 覆盖已有的键时释放旧的键值
+    if (old_key) old_key->del_ref();
+    if (old_value) old_value->del_ref();
     return load_nil();
 }
 
-Object* dict_getitem(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    auto key_obj = builtin::get_one_arg(args);
+Object* dict_getitem(Object* self, Object* const* argv, size_t argc) {
+    auto self_dict = as<Dictionary>(self);
+    auto key_obj = builtin::get_one_arg(argv, argc);
 
     dep::BigInt key_hash_val = hash_object(key_obj);
 
@@ -96,8 +97,8 @@ Object* dict_getitem(Object* self, const List* args) {
 }
 
 
-Object* dict_str(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+Object* dict_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_dict = as<Dictionary>(self);
     std::string result = "{";
     auto kv_list = self_dict->val.to_vector();
     size_t i = 0;
@@ -109,11 +110,11 @@ Object* dict_str(Object* self, const List* args) {
         ++i;
     }
     result += "}";
-    return new String(result);
+    return create_str(result);
 }
 
-Object* dict_dstr(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+Object* dict_dstr(Object* self, Object* const* argv, size_t argc) {
+    auto self_dict = as<Dictionary>(self);
     std::string result = "{";
     auto kv_list = self_dict->val.to_vector();
     size_t i = 0;
@@ -125,13 +126,13 @@ Object* dict_dstr(Object* self, const List* args) {
         ++i;
     }
     result += "}";
-    return new String(result);
+    return create_str(result);
 }
 
-Object* dict_foreach(Object* self, const List* args) {
-    auto func_obj = builtin::get_one_arg(args);
+Object* dict_foreach(Object* self, Object* const* argv, size_t argc) {
+    auto func_obj = builtin::get_one_arg(argv, argc);
 
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = as<Dictionary>(self);
     assert(self_dict != nullptr);
 
     dep::BigInt idx = 0;
@@ -142,8 +143,8 @@ Object* dict_foreach(Object* self, const List* args) {
     return load_nil();
 }
 
-Object* dict_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
+Object* dict_next(Object* self, Object* const* argv, size_t argc) {
+    auto curr_idx_it = self->attrs.find(model::magic_name::current_index);
     if(!curr_idx_it)
         throw NativeFuncError("TypeError", "Dict.next cannot find attribute '__current_index__' to get current item");
 
@@ -151,19 +152,19 @@ Object* dict_next(Object* self, const List* args) {
 
     auto index =  cast_to_int(curr_idx) ->val.to_unsigned_long_long();
 
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = as<Dictionary>(self);
     if (index < self_dict->val.size()) {
-        auto res = self_dict->val.to_vector()[index].second.second;
-        self->attrs_insert("__current_index__", new Int(index+1));
+        auto res = self_dict->val.entries()[index].value.second;
+        self->attrs_insert(model::magic_name::current_index, load_int(index+1));
         return res;
     }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
+    self->attrs_insert(model::magic_name::current_index, load_int(0));
     return load_stop_iter_signal();
 }
 
-Object* dict_len(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    return new Int(self_dict->val.to_vector().size());
+Object* dict_len(Object* self, Object* const* argv, size_t argc) {
+    auto self_dict = as<Dictionary>(self);
+    return load_int(self_dict->val.size());
 }
 
 }  // namespace model
\ No newline at end of file
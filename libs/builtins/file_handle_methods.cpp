@@ -2,10 +2,9 @@
 
 namespace model {
 
-Object* file_handle_flush(Object* self, const List* args) {
-    kiz::Vm::assert_argc(0, args);
+Object* file_handle_flush(Object* self, Object* const* argv, size_t argc) {
 
-    auto f_obj = dynamic_cast<FileHandle*>(self);
+    auto f_obj = as<FileHandle>(self);
     assert(f_obj);
 
     if (f_obj->is_closed) {
@@ -24,9 +23,8 @@ Object* file_handle_flush(Object* self, const List* args) {
     return load_nil();
 }
 
-Object* file_handle_read(Object* self, const List* args) {
-    kiz::Vm::assert_argc(0, args);
-    auto f_obj = dynamic_cast<FileHandle*>(self);
+Object* file_handle_read(Object* self, Object* const* argv, size_t argc) {
+    auto f_obj = as<FileHandle>(self);
     assert(f_obj);
 
     if (f_obj->is_closed) {
@@ -48,14 +46,13 @@ Object* file_handle_read(Object* self, const List* args) {
     if (f_obj->file_handle->fail() && !f_obj->file_handle->eof()) {
         throw NativeFuncError("FileError", "Read failed");
     }
-    return new String(oss.str());
+    return create_str(oss.str());
 }
 
-Object* file_handle_write(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* file_handle_write(Object* self, Object* const* argv, size_t argc) {
 
     // 类型转换并校验
-    auto f_obj = dynamic_cast<FileHandle*>(self);
+    auto f_obj = as<FileHandle>(self);
     assert(f_obj);
 
     // 校验文件句柄状态
@@ -67,7 +64,7 @@ Object* file_handle_write(Object* self, const List* args) {
     }
 
     // 提取要写入的字符串内容
-    std::string content = kiz::Vm::obj_to_str(args->val[0]);
+    std::string content = kiz::Vm::obj_to_str(argv[0]);
 
     // 写入内容并刷新缓冲区
     *f_obj->file_handle << content;
@@ -77,10 +74,9 @@ Object* file_handle_write(Object* self, const List* args) {
     return load_nil();
 }
 
-Object* file_handle_readline(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* file_handle_readline(Object* self, Object* const* argv, size_t argc) {
 
-    auto f_obj = dynamic_cast<FileHandle*>(self);
+    auto f_obj = as<FileHandle>(self);
     assert(f_obj);
 
     if (f_obj->is_closed) {
@@ -91,7 +87,7 @@ Object* file_handle_readline(Object* self, const List* args) {
     }
 
     // 安全转换参数
-    auto lineno_obj = cast_to_int(args->val[0]);
+    auto lineno_obj = cast_to_int(argv[0]);
     size_t lineno = lineno_obj->val.to_unsigned_long_long();
 
     std::string target_line;
@@ -113,14 +109,13 @@ Object* file_handle_readline(Object* self, const List* args) {
         }
     }
 
-    return new String(target_line);
+    return create_str(target_line);
 }
 
-Object* file_handle_close(Object* self, const List* args) {
-    kiz::Vm::assert_argc(0, args);
+Object* file_handle_close(Object* self, Object* const* argv, size_t argc) {
 
     // 类型转换并校验
-    auto f_obj = dynamic_cast<FileHandle*>(self);
+    auto f_obj = as<FileHandle>(self);
     assert(f_obj);
 
     if (f_obj->is_closed) {
@@ -5,11 +5,16 @@
 
 namespace builtin {
 
-inline model::Object* get_one_arg(const model::List* args) {
-    if (!args->val.empty()) {
-        return args->val[0];
+inline model::Object* get_one_arg(model::Object* const* argv, const size_t argc) {
+    if (argc != 0) {
+        return argv[0];
     }
-    kiz::Vm::assert_argc(1, args);
+    kiz::Vm::assert_argc(1, argc);
+}
+
+// 旧调用约定(参数装在List里)的原生库使用
+inline model::Object* get_one_arg(const model::List* args) {
+    return get_one_arg(args->val.data(), args->val.size());
 }
 
 inline model::Object* check_based_object_inner(
@@ -23,7 +28,7 @@ inline model::Object* check_based_object_inner(
     visited.insert(src_obj);
 
     // 查找__parent__属性
-    const auto it = src_obj->attrs.find("__parent__");
+    const auto it = src_obj->attrs.find(model::magic_name::parent);
     if (it == nullptr) {
         return  model::load_false();
     }
@@ -39,26 +44,26 @@ inline model::Object* check_based_object(model::Object* src_obj, model::Object*
 }
 
 // 内置函数
-model::Object* print(model::Object* self, const model::List* args);
-model::Object* input(model::Object* self, const model::List* args);
-model::Object* ischild(model::Object* self, const model::List* args);
-model::Object* help(model::Object* self, const model::List* args);
-model::Object* breakpoint(model::Object* self, const model::List* args);
-model::Object* range(model::Object* self, const model::List* args);
-model::Object* cmd(model::Object* self, const model::List* args);
-model::Object* now(model::Object* self, const model::List* args);
-model::Object* setattr(model::Object* self, const model::List* args);
-model::Object* getattr(model::Object* self, const model::List* args);
-model::Object* delattr(model::Object* self, const model::List* args);
-model::Object* hasattr(model::Object* self, const model::List* args);
-model::Object* get_refc(model::Object* self, const model::List* args);
-model::Object* create(model::Object* self, const model::List* args);
-model::Object* type_of_obj(model::Object* self, const model::List* args);
-model::Object* debug_str(model::Object* self, const model::List* args);
-model::Object* attr(model::Object* self, const model::List* args);
-model::Object* sleep(model::Object* self, const model::List* args);
-model::Object* open(model::Object* self, const model::List* args);
-model::Object* assert_(model::Object* self, const model::List* args);
-model::Object* panic(model::Object* self, const model::List* args);
+model::Object* print(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* input(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* ischild(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* help(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* breakpoint(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* range(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* cmd(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* now(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* setattr(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* getattr(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* delattr(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* hasattr(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* get_refc(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* create(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* type_of_obj(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* debug_str(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* attr(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* sleep(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* open(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* assert_(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* panic(model::Object* self, model::Object* const* argv, size_t argc);
 
 }
\ No newline at end of file
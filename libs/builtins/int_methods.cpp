@@ -6,10 +6,10 @@
 namespace model {
 
 // Int.__call__
-Object* int_call(Object* self, const List* args) {
-    auto a = builtin::get_one_arg(args);
+Object* int_call(Object* self, Object* const* argv, size_t argc) {
+    auto a = builtin::get_one_arg(argv, argc);
     dep::BigInt val(0);
-    if (auto s = dynamic_cast<String*>(a)) {
+    if (auto s = as<String>(a)) {
         auto str = dep::UTF8String(s->val);
         bool is_digit = true;
         for (const auto& c : str) {
@@ -21,20 +21,20 @@ Object* int_call(Object* self, const List* args) {
             throw NativeFuncError("TypeError", "Cannot cast this string to Int");
         }
     }
-    if (auto i = dynamic_cast<Int*>(a)) {
+    if (auto i = as<Int>(a)) {
         val = dep::BigInt(i->val);
     }
-    if (auto i = dynamic_cast<Decimal*>(a)) {
+    if (auto i = as<Decimal>(a)) {
         val = dep::BigInt(i->val.integer_part());
     }
 
     else if (!kiz::Vm::is_true(a)) val = dep::BigInt(0);
-    return new Int(val);
+    return load_int(val);
 }
 
 // Int.__bool__
-Object* int_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<Int*>(self);
+Object* int_bool(Object* self, Object* const* argv, size_t argc) {
+    const auto self_int = as<Int>(self);
     if (self_int->val == dep::BigInt(0)) {
         return load_false();
     }
@@ -42,19 +42,18 @@ Object* int_bool(Object* self, const List* args) {
 }
 
 // Int.__add__ 整数加法：self + args[0]（仅支持Int/Decimal）
-Object* int_add(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_add(Object* self, Object* const* argv, size_t argc) {
 
-    const auto self_int = dynamic_cast<Int*>(self);
+    const auto self_int = as<Int>(self);
     assert(self_int!=nullptr);
 
     // 与Int相加
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
-        return new Int(self_int->val + another_int->val);
+        return load_int(self_int->val + another_int->val);
     }
     // 与Decimal相加（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec + another_dec->val);
@@ -64,17 +63,16 @@ Object* int_add(Object* self, const List* args) {
 };
 
 // Int.__sub__ 整数减法：self - args[0]（仅支持Int/Decimal）
-Object* int_sub(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_sub(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     // 与Int相减
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
-        return new Int(self_int->val - another_int->val);
+        return load_int(self_int->val - another_int->val);
     }
     // 与Decimal相减（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec - another_dec->val);
@@ -84,17 +82,16 @@ Object* int_sub(Object* self, const List* args) {
 };
 
 // Int.__mul__ 整数乘法：self * args[0]（仅支持Int/Decimal）
-Object* int_mul(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_mul(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     // 与Int相乘
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
-        return new Int(self_int->val * another_int->val);
+        return load_int(self_int->val * another_int->val);
     }
     // 与Decimal相乘（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec * another_dec->val);
@@ -104,22 +101,21 @@ Object* int_mul(Object* self, const List* args) {
 };
 
 // Int.__neg__ 取反
-Object* int_neg(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
+Object* int_neg(Object* self, Object* const* argv, size_t argc) {
+    auto self_int = as<Int>(self);
     assert(self_int!=nullptr);
 
     auto new_int = dep::BigInt(0) - self_int->val;
-    return new Int(new_int);
+    return load_int(new_int);
 }
 
 // Int.__div__ 整数除法 self / args[0]（仅支持Int/Decimal，返回Decimal）
-Object* int_div(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_div(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     assert(self_int!=nullptr);
     // 与Int相除（返回Decimal，保留10位小数）
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
         if (another_int->val == 0) throw NativeFuncError("CalculateError", "divisor cannot be zero");
         dep::Decimal left_dec(self_int->val);
@@ -127,7 +123,7 @@ Object* int_div(Object* self, const List* args) {
         return new Decimal(left_dec.div(right_dec, 10));
     }
     // 与Decimal相除（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         if(another_dec->val == dep::Decimal(0)) throw NativeFuncError("CalculateError", "divisor cannot be zero");
         dep::Decimal left_dec(self_int->val);
@@ -138,11 +134,10 @@ Object* int_div(Object* self, const List* args) {
 };
 
 // Int.__pow__ 整数幂运算：self ^ args[0]（self的args[0]次方，仅支持Int指数）
-Object* int_pow(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_pow(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
-    auto exp_int = dynamic_cast<Int*>(args->val[0]);
+    auto self_int = as<Int>(self);
+    auto exp_int = as<Int>(argv[0]);
     if (! exp_int)
         throw NativeFuncError("TypeError", "function Int.pow second arg need be Int");
 
@@ -155,22 +150,21 @@ Object* int_pow(Object* self, const List* args) {
         dep::Decimal one(1);
         return new Decimal(one.div(res, 10));
     } else {
-        return new Int(self_int->val.pow(exp_int->val));
+        return load_int(self_int->val.pow(exp_int->val));
     }
 };
 
 // Int.__mod__ 整数取模：self % args[0]（仅支持Int）
-Object* int_mod(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_mod(Object* self, Object* const* argv, size_t argc) {
 
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (! another_int)
         throw NativeFuncError("TypeError", "function Int.mod second arg need be Int");
 
     if(another_int->val == dep::BigInt(0))
         throw NativeFuncError("CalculateError", "mod by zero");
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     dep::BigInt remainder = self_int->val % another_int->val;
     // 修正余数符号（确保与除数同号）
     if (remainder != dep::BigInt(0)
@@ -178,21 +172,20 @@ Object* int_mod(Object* self, const List* args) {
     ) {
         remainder += another_int->val;
     }
-    return new Int(dep::BigInt(remainder));
+    return load_int(dep::BigInt(remainder));
 };
 
 // Int.__eq__ 相等判断：self == args[0]（仅支持Int/Decimal）
-Object* int_eq(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_eq(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
         return load_bool(self_int->val == another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val == another_dec->val);
@@ -202,17 +195,16 @@ Object* int_eq(Object* self, const List* args) {
 };
 
 // Int.__lt__ 小于判断：self < args[0]（仅支持Int/Decimal）
-Object* int_lt(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_lt(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
         return load_bool(self_int->val < another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val < another_dec->val);
@@ -222,17 +214,16 @@ Object* int_lt(Object* self, const List* args) {
 };
 
 // Int.__gt__ 大于判断：self > args[0]（仅支持Int/Decimal）
-Object* int_gt(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* int_gt(Object* self, Object* const* argv, size_t argc) {
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = as<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = as<Int>(argv[0]);
     if (another_int) {
         return load_bool(self_int->val > another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = as<Decimal>(argv[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val > another_dec->val);
@@ -242,14 +233,14 @@ Object* int_gt(Object* self, const List* args) {
 };
 
 // Int.__hash__
-Object* int_hash(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
-    return new Int(self_int->val);
+Object* int_hash(Object* self, Object* const* argv, size_t argc) {
+    auto self_int = as<Int>(self);
+    return load_int(self_int->val);
 }
 
-Object* int_str(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
-    return new String(self_int->val.to_string());
+Object* int_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_int = as<Int>(self);
+    return create_str(self_int->val.to_string());
 }
 
 
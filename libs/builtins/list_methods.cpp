@@ -5,41 +5,53 @@
 
 namespace model {
 
+namespace {
+
+// 回调脚本时钉住的结果, 交给create_list持有
+std::vector<Object*> pinned_objects(const std::vector<kiz::StackRef>& held) {
+    std::vector<Object*> objs;
+    objs.reserve(held.size());
+    for (const auto& ref : held) objs.push_back(ref.get());
+    return objs;
+}
+
+} // namespace
+
 // List.__call__
-Object* list_call(Object* self, const List* args) {
-    std::vector<Object*> list = {};
-    if (args->val.empty()) {
-        return new List({});
+Object* list_call(Object* self, Object* const* argv, size_t argc) {
+    if (argc == 0) {
+        return create_list({});
     }
 
-    auto for_cast = builtin::get_one_arg(args);
+    // 已取出的元素在之后的__next__回调期间要钉住, 直到列表持有它们
+    std::vector<kiz::StackRef> held;
+    auto for_cast = builtin::get_one_arg(argv, argc);
     while (true) {
-        kiz::Vm::call_method(for_cast, "__next__", {});
-        auto res = kiz::Vm::simple_get_and_pop_stack_top();
-        if (res == stop_iter_signal) {
+        kiz::Vm::call_method(for_cast, model::magic_name::next_item, {});
+        auto res = kiz::Vm::get_and_pop_stack_top();
+        if (res.get() == stop_iter_signal) {
             break;
         }
-        list.push_back(res);
+        held.push_back(std::move(res));
     }
-    return new List(list);
+    return create_list(pinned_objects(held));
 }
 
 // List.__bool__
-Object* list_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<List*>(self);
+Object* list_bool(Object* self, Object* const* argv, size_t argc) {
+    const auto self_int = as<List>(self);
     assert(self_int != nullptr);
     if (self_int->val.empty()) return load_false();
     return load_true();
 }
 
 //  List.__add__：拼接另一个List（self + 传入List，返回新List）
-Object* list_add(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* list_add(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
     
-    auto another_list = dynamic_cast<List*>(args->val[0]);
+    auto another_list = as<List>(argv[0]);
     if (!another_list)
         throw NativeFuncError("TypeError", "List.add only supports List type argument");
     
@@ -47,17 +59,16 @@ Object* list_add(Object* self, const List* args) {
     std::vector<Object*> new_vals = self_list->val;
     new_vals.insert(new_vals.end(), another_list->val.begin(), another_list->val.end());
     
-    return new List(std::move(new_vals));
+    return create_list(std::move(new_vals));
 };
 
 // List.__mul__：重复自身n次 self * n
-Object* list_mul(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* list_mul(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
     
-    auto times_int = dynamic_cast<Int*>(args->val[0]);
+    auto times_int = as<Int>(argv[0]);
     if (! times_int)
         throw NativeFuncError("TypeError", "List.mul only supports Int type argument");
     if (times_int->val < dep::BigInt(0))
@@ -69,17 +80,16 @@ Object* list_mul(Object* self, const List* args) {
         new_vals.insert(new_vals.end(), self_list->val.begin(), self_list->val.end());
     }
     
-    return new List(std::move(new_vals));
+    return create_list(std::move(new_vals));
 };
 
 // List.__eq__：判断两个List是否相等
-Object* list_eq(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* list_eq(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
     
-    auto another_list = dynamic_cast<List*>(args->val[0]);
+    auto another_list = as<List>(argv[0]);
     if (! another_list)
         throw NativeFuncError("TypeError", "List.eq only supports List type argument");
     
@@ -94,12 +104,12 @@ Object* list_eq(Object* self, const List* args) {
         Object* another_elem = another_list->val[i];
         // 调用 __eq__
         kiz::Vm::call_method(
-            self_elem, "__eq__", {another_elem}
+            self_elem, model::magic_name::eq, {another_elem}
         );
         const auto eq_result = kiz::Vm::simple_get_and_pop_stack_top();
 
         // 解析比较结果
-        const auto eq_bool = dynamic_cast<Bool*>(eq_result);
+        const auto eq_bool = as<Bool>(eq_result);
         if (! eq_bool)
             throw NativeFuncError("TypeError", "__eq__ method must return Bool type");
         
@@ -113,8 +123,8 @@ Object* list_eq(Object* self, const List* args) {
     return load_true();
 };
 
-Object* list_str(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     std::string result = "[";
     for (size_t i = 0; i < self_list->val.size(); ++i) {
         if (self_list->val[i]) {
@@ -127,11 +137,11 @@ Object* list_str(Object* self, const List* args) {
         }
     }
     result += "]";
-    return new String(result);
+    return create_str(result);
 }
 
-Object* list_dstr(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_dstr(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     std::string result = "[";
     for (size_t i = 0; i < self_list->val.size(); ++i) {
         if (self_list->val[i] != nullptr) {
@@ -144,23 +154,22 @@ Object* list_dstr(Object* self, const List* args) {
         }
     }
     result += "]";
-    return new String(result);
+    return create_str(result);
 }
 
 // List.contains：判断列表是否包含目标元素
-Object* list_contains(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* list_contains(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
     
-    Object* target_elem = args->val[0];
+    Object* target_elem = argv[0];
 
     // 遍历列表元素，逐个判断是否与目标元素相等
     for (Object* elem : self_list->val) {
 
         kiz::Vm::call_method(
-            elem, "__eq__", {target_elem}
+            elem, model::magic_name::eq, {target_elem}
         );
         const auto result = kiz::Vm::simple_get_and_pop_stack_top();
 
@@ -173,25 +182,23 @@ Object* list_contains(Object* self, const List* args) {
 };
 
 // List.append：向列表尾部添加一个元素
-Object* list_append(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* list_append(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
     
-    Object* elem_to_add = args->val[0];
+    Object* elem_to_add = argv[0];
 
     // 添加元素到列表尾部
     self_list->val.push_back(elem_to_add);
     elem_to_add->make_ref();
     
     // 返回列表自身，支持链式调用
-    self->make_ref();
     return self;
 };
 
-Object* list_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
+Object* list_next(Object* self, Object* const* argv, size_t argc) {
+    auto curr_idx_it = self->attrs.find(model::magic_name::current_index);
     if(!curr_idx_it)
         throw NativeFuncError("TypeError", "List.next cannot find attribute '__current_index__' to get current index");
 
@@ -199,20 +206,20 @@ Object* list_next(Object* self, const List* args) {
 
     auto index =  cast_to_int(curr_idx) ->val.to_unsigned_long_long();
 
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     if (index < self_list->val.size()) {
         auto res = self_list->val[index];
-        self->attrs_insert("__current_index__", new Int(index+1));
+        self->attrs_insert(model::magic_name::current_index, load_int(index+1));
         return res;
     }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
+    self->attrs_insert(model::magic_name::current_index, load_int(0));
     return load_stop_iter_signal();
 }
 
-Object* list_foreach(Object* self, const List* args) {
-    auto func_obj = builtin::get_one_arg(args);
+Object* list_foreach(Object* self, Object* const* argv, size_t argc) {
+    auto func_obj = builtin::get_one_arg(argv, argc);
 
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
     dep::BigInt idx = 0;
@@ -223,31 +230,32 @@ Object* list_foreach(Object* self, const List* args) {
     return load_nil();
 }
 
-Object* list_reverse(Object* self, const List* args) {
-    const auto self_list = dynamic_cast<List*>(self);
+Object* list_reverse(Object* self, Object* const* argv, size_t argc) {
+    const auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
     std::ranges::reverse(self_list->val);
     return load_nil();
 }
 
-Object* list_extend(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_extend(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
-    auto other_list_obj = builtin::get_one_arg(args);
-    auto other_list = dynamic_cast<List*>(other_list_obj);
+    auto other_list_obj = builtin::get_one_arg(argv, argc);
+    auto other_list = as<List>(other_list_obj);
     if (!other_list)
         throw NativeFuncError("TypeError", "The first argument of List.extend must be List type");
 
     for (auto e: other_list->val) {
         self_list->val.push_back(e);
+        e->make_ref();
     }
     return load_nil();
 }
 
-Object* list_pop(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_pop(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
     if (self_list->val.empty()) {
@@ -258,45 +266,48 @@ Object* list_pop(Object* self, const List* args) {
     return back;
 }
 
-Object* list_insert(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_insert(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
-    kiz::Vm::assert_argc(2, args);
-    if (args->val.size() == 2) {
-        auto value_obj = args->val[0];
-        auto idx_int = dynamic_cast<Int*>(args->val[1]);
+    kiz::Vm::assert_argc(2, argc);
+    if (argc == 2) {
+        auto value_obj = argv[0];
+        auto idx_int = as<Int>(argv[1]);
         if (!idx_int)
             throw NativeFuncError("TypeError", "The first argument of List.setitem must be Int type");
         auto idx = idx_int->val.to_unsigned_long_long();
         if (idx < self_list->val.size()) {
+            value_obj->make_ref();
+            self_list->val[idx]->del_ref();
             self_list->val[idx] = value_obj;
         }
     }
     return load_nil();
 }
 
-Object* list_setitem(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_setitem(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
 
-    auto idx_obj = dynamic_cast<Int*>(args->val[0]);
+    auto idx_obj = as<Int>(argv[0]);
     if (!idx_obj)
         throw NativeFuncError("TypeError", "The first argument of List.setitem must be Int type");
 
     auto index = idx_obj->val.to_unsigned_long_long();
 
-    auto value_obj = args->val[1];
+    auto value_obj = argv[1];
 
     if (index < self_list->val.size()) {
+        value_obj->make_ref();
+        self_list->val[index]->del_ref();
         self_list->val[index] = value_obj;
         return load_nil();
     }
     throw NativeFuncError("SetItemError", std::format("index {} out of range", index));
 }
 
-Object* list_getitem(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    auto idx_obj = dynamic_cast<Int*>(builtin::get_one_arg(args));
+Object* list_getitem(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
+    auto idx_obj = as<Int>(builtin::get_one_arg(argv, argc));
     if (!idx_obj)
         throw NativeFuncError("TypeError", "The first argument of List.getitem must be Int type");
 
@@ -307,84 +318,81 @@ Object* list_getitem(Object* self, const List* args) {
     throw NativeFuncError("GetItemError", std::format("index {} out of range", index));
 }
 
-Object* list_count(Object* self, const List* args) {
-    const auto obj = builtin::get_one_arg(args);
+Object* list_count(Object* self, Object* const* argv, size_t argc) {
+    const auto obj = builtin::get_one_arg(argv, argc);
     size_t count = 0;
     auto self_list = cast_to_list(self);
 
     for (const auto& item : self_list->val) {
-        kiz::Vm::call_method(obj, "__eq__", {item});
+        kiz::Vm::call_method(obj, model::magic_name::eq, {item});
         auto res = kiz::Vm::simple_get_and_pop_stack_top();
         if (res) {
             ++ count;
         }
     }
-    return new Int(count);
+    return load_int(count);
 }
 
-Object* list_find(Object* self, const List* args) {
-    auto func_obj = builtin::get_one_arg(args);
+Object* list_find(Object* self, Object* const* argv, size_t argc) {
+    auto func_obj = builtin::get_one_arg(argv, argc);
 
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
     for (auto e : self_list->val) {
         kiz::Vm::call_function(func_obj, {e}, nullptr);
-        auto res = kiz::Vm::simple_get_and_pop_stack_top();
-        if (kiz::Vm::is_true(res)) {
-            res->make_ref();
-            return res;
+        auto res = kiz::Vm::get_and_pop_stack_top();
+        if (kiz::Vm::is_true(res.get())) {
+            return res.get();
         }
     }
     return load_nil();
 }
 
-Object* list_map(Object* self, const List* args) {
-    auto func_obj = builtin::get_one_arg(args);
+Object* list_map(Object* self, Object* const* argv, size_t argc) {
+    auto func_obj = builtin::get_one_arg(argv, argc);
 
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
-    std::vector<Object*> new_vec;
+    std::vector<kiz::StackRef> held;
 
     for (auto e : self_list->val) {
         kiz::Vm::call_function(func_obj, {e}, nullptr);
-        auto res = kiz::Vm::simple_get_and_pop_stack_top();
-        
-        new_vec.push_back(res);
+        held.push_back(kiz::Vm::get_and_pop_stack_top());
     }
-    return new List(new_vec);
+    return create_list(pinned_objects(held));
 }
 
-Object* list_filter(Object* self, const List* args) {
-    auto func_obj = builtin::get_one_arg(args);
+Object* list_filter(Object* self, Object* const* argv, size_t argc) {
+    auto func_obj = builtin::get_one_arg(argv, argc);
 
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
-    std::vector<Object*> new_vec;
+    std::vector<kiz::StackRef> held;
 
     for (auto e : self_list->val) {
         kiz::Vm::call_function(func_obj, {e}, nullptr);
-        auto res = kiz::Vm::simple_get_and_pop_stack_top();
-        if (kiz::Vm::is_true(res)) {
-            new_vec.push_back(res);
+        auto res = kiz::Vm::get_and_pop_stack_top();
+        if (kiz::Vm::is_true(res.get())) {
+            held.push_back(std::move(res));
         }
     }
-    return new List(new_vec);
+    return create_list(pinned_objects(held));
 }
 
-Object* list_len(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_len(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
-    return new Int(dep::BigInt(self_list->val.size()));
+    return load_int(dep::BigInt(self_list->val.size()));
 }
 
-Object* list_join(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+Object* list_join(Object* self, Object* const* argv, size_t argc) {
+    auto self_list = as<List>(self);
     assert(self_list != nullptr);
 
-    auto sep = kiz::Vm::obj_to_str(builtin::get_one_arg(args));
+    auto sep = kiz::Vm::obj_to_str(builtin::get_one_arg(argv, argc));
 
     std::string text;
     size_t index = 0;
@@ -395,7 +403,7 @@ Object* list_join(Object* self, const List* args) {
         }
         ++index;
     }
-    return new String(text);
+    return create_str(text);
 }
 
 }  // namespace model
\ No newline at end of file
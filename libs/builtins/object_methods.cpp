@@ -4,40 +4,48 @@
 namespace model {
 
 // Object类型
-Object* object_str(Object* self, const List* args) {
-    return new String("<Object at " + model::ptr_to_string(self) + ">");
+Object* object_str(Object* self, Object* const* argv, size_t argc) {
+    return create_str("<Object at " + model::ptr_to_string(self) + ">");
 }
 
-Object* object_eq(Object* self, const List* args) {
-    const auto other_obj = builtin::get_one_arg(args);
+Object* object_eq(Object* self, Object* const* argv, size_t argc) {
+    const auto other_obj = builtin::get_one_arg(argv, argc);
     return model::load_bool(self == other_obj);
 }
 
-Object* object_setitem(Object* self, const List* args) {
-    assert(args->val.size() == 2);
-    auto attr = args->val[0];
-    auto attr_str = dynamic_cast<model::String*>(attr);
+Object* object_setitem(Object* self, Object* const* argv, size_t argc) {
+    assert(argc == 2);
+    auto attr = argv[0];
+    auto attr_str = model::as<model::String>(attr);
     assert(attr_str != nullptr);
-    self->attrs_insert(attr_str->val, args->val[1]);
+    self->attrs_insert(attr_str->val, argv[1]);
     return self;
 }
 
-Object* object_getitem(Object* self, const List* args) {
-    auto attr = builtin::get_one_arg(args);
-    auto attr_str = dynamic_cast<model::String*>(attr);
+Object* object_getitem(Object* self, Object* const* argv, size_t argc) {
+    auto attr = builtin::get_one_arg(argv, argc);
+    auto attr_str = model::as<model::String>(attr);
     assert(attr_str != nullptr);
     return kiz::Vm::get_attr(self, attr_str->val);
 }
 
 
 // Range类型
-Object* range_call(Object* self, const List* args) {
-    auto arg_vector = args->val;
+namespace {
+// Range的属性名, 每次迭代都要用到, 预先登记为符号
+const Symbol range_start = Symbol::intern("start");
+const Symbol range_step = Symbol::intern("step");
+const Symbol range_end = Symbol::intern("end");
+const Symbol range_current = Symbol::intern("current");
+}
+
+Object* range_call(Object* self, Object* const* argv, size_t argc) {
+    const std::span arg_vector(argv, argc);
     dep::BigInt start_int = 0;
     dep::BigInt step_int = 1;
     dep::BigInt end_int = 1;
     auto r_obj = new Object();
-    r_obj->attrs_insert("__parent__", self);
+    r_obj->attrs_insert(model::magic_name::parent, self);
 
     if (arg_vector.size() == 1) {
         end_int = cast_to_int(arg_vector[0])->val.to_unsigned_long_long();
@@ -51,20 +59,20 @@ Object* range_call(Object* self, const List* args) {
         step_int = cast_to_int(arg_vector[1])->val.to_unsigned_long_long();
         end_int = cast_to_int(arg_vector[2])->val.to_unsigned_long_long();
 
-    } else kiz::Vm::assert_argc({1,2,3}, args);
+    } else kiz::Vm::assert_argc({1,2,3}, argc);
 
-    r_obj->attrs_insert("current", new Int(start_int));
-    r_obj->attrs_insert("start", new Int(start_int));
-    r_obj->attrs_insert("step", new Int(step_int));
-    r_obj->attrs_insert("end", new Int(end_int));
+    r_obj->attrs_insert(range_current, create_int(start_int)); // 游标会被range_next原地修改, 不能取自小整数池
+    r_obj->attrs_insert(range_start, load_int(start_int));
+    r_obj->attrs_insert(range_step, load_int(step_int));
+    r_obj->attrs_insert(range_end, load_int(end_int));
     return r_obj;
 }
 
-Object* range_next(Object* self, const List* args) {
-    Int* start_obj = cast_to_int(kiz::Vm::get_attr_current(self, "start"));
-    Int* step_obj = cast_to_int(kiz::Vm::get_attr_current(self, "step"));
-    Int* end_obj = cast_to_int(kiz::Vm::get_attr_current(self, "end"));
-    Int* current_obj = cast_to_int(kiz::Vm::get_attr_current(self, "current"));
+Object* range_next(Object* self, Object* const* argv, size_t argc) {
+    Int* start_obj = cast_to_int(kiz::Vm::get_attr_current(self, range_start));
+    Int* step_obj = cast_to_int(kiz::Vm::get_attr_current(self, range_step));
+    Int* end_obj = cast_to_int(kiz::Vm::get_attr_current(self, range_end));
+    Int* current_obj = cast_to_int(kiz::Vm::get_attr_current(self, range_current));
 
     dep::BigInt& start_int = start_obj->val;
     dep::BigInt& step_int = step_obj->val;
@@ -86,49 +94,48 @@ Object* range_next(Object* self, const List* args) {
     current += step_int;
 
     // 返回迭代值
-    return new Int(old_val);
+    return load_int(old_val);
 }
 
-Object* range_str(Object* self, const List* args) {
-    dep::BigInt start_int = cast_to_int(kiz::Vm::get_attr_current(self, "start"))->val;
-    dep::BigInt step_int = cast_to_int(kiz::Vm::get_attr_current(self, "step"))->val;
-    dep::BigInt end_int = cast_to_int(kiz::Vm::get_attr_current(self, "end"))->val;
-    dep::BigInt current = cast_to_int(kiz::Vm::get_attr_current(self, "current"))->val;
+Object* range_str(Object* self, Object* const* argv, size_t argc) {
+    dep::BigInt start_int = cast_to_int(kiz::Vm::get_attr_current(self, range_start))->val;
+    dep::BigInt step_int = cast_to_int(kiz::Vm::get_attr_current(self, range_step))->val;
+    dep::BigInt end_int = cast_to_int(kiz::Vm::get_attr_current(self, range_end))->val;
+    dep::BigInt current = cast_to_int(kiz::Vm::get_attr_current(self, range_current))->val;
 
-    return new String(std::format("Range(start={}, step={}, end={}, current={})", start_int.to_string(),
+    return create_str(std::format("Range(start={}, step={}, end={}, current={})", start_int.to_string(),
         step_int.to_string(), end_int.to_string(), current.to_string()));
 }
 
 // Error类型
-Object* error_str(Object* self, const List* args) {
-    auto name = kiz::Vm::obj_to_debug_str(kiz::Vm::get_attr_current(self, "__name__"));
-    auto msg = kiz::Vm::obj_to_debug_str(kiz::Vm::get_attr_current(self, "__msg__"));
-    return new String(std::format("Error(name={}, msg={})", name, msg));
+Object* error_str(Object* self, Object* const* argv, size_t argc) {
+    auto name = kiz::Vm::obj_to_debug_str(kiz::Vm::get_attr_current(self, model::magic_name::name));
+    auto msg = kiz::Vm::obj_to_debug_str(kiz::Vm::get_attr_current(self, model::magic_name::msg));
+    return create_str(std::format("Error(name={}, msg={})", name, msg));
 }
 
-Object* error_call(Object* self, const List* args) {
-    kiz::Vm::assert_argc(2, args);
-    auto err_name = args->val[0];
-    auto err_msg = args->val[1];
+Object* error_call(Object* self, Object* const* argv, size_t argc) {
+    auto err_name = argv[0];
+    auto err_msg = argv[1];
 
     auto err = new Error(kiz::Vm::make_pos_info());
-    err->attrs_insert("__name__", err_name);
-    err->attrs_insert("__msg__", err_msg);
+    err->attrs_insert(model::magic_name::name, err_name);
+    err->attrs_insert(model::magic_name::msg, err_msg);
     return err;
 }
 
 // Function类型
-Object* function_str(Object* self, const List* args) {
-    auto self_fn = dynamic_cast<Function*>(self);
-    return new String(
+Object* function_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_fn = as<Function>(self);
+    return create_str(
         "<Function: path='" + self_fn->name + "', argc=" + std::to_string(self_fn->argc) + " at " + ptr_to_string(self_fn) + ">"
     );
 }
 
 // NativeFunction类型
-Object* native_function_str(Object* self, const List* args) {
-    auto self_nfn = dynamic_cast<NativeFunction*>(self);
-    return new model::String(
+Object* native_function_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_nfn = as<NativeFunction>(self);
+    return model::create_str(
      "<NativeFunction" +
          (self_nfn->name.empty()
          ? ""
@@ -139,9 +146,9 @@ Object* native_function_str(Object* self, const List* args) {
 }
 
 // Module类型
-Object* module_str(Object* self, const List* args) {
-    auto self_mod = dynamic_cast<model::Module*>(self);
-    return new model::String(
+Object* module_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_mod = model::as<model::Module>(self);
+    return model::create_str(
         "<Module: path='" + self_mod->path + "', attr=" + self_mod->attrs.to_string() + ", at " + ptr_to_string(self_mod) + ">"
     );
 }
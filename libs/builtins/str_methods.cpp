@@ -5,44 +5,42 @@
 namespace model {
 
 // String.__call__
-Object* str_call(Object* self, const List* args) {
+Object* str_call(Object* self, Object* const* argv, size_t argc) {
     std::string val;
-    if (args->val.empty()) {
+    if (argc == 0) {
         val = "";
     } else {
-        val = kiz::Vm::obj_to_str(args->val[0]);
+        val = kiz::Vm::obj_to_str(argv[0]);
     }
-    return new String(val);
+    return create_str(val);
 }
 
 // String.__bool__
-Object* str_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<String*>(self);
+Object* str_bool(Object* self, Object* const* argv, size_t argc) {
+    const auto self_int = as<String>(self);
     if (self_int->val.empty()) load_false();
     return load_true();
 }
 
 // String.__add__：字符串拼接（self + 传入String，返回新String，不修改原对象）
-Object* str_add(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
-    auto self_str = dynamic_cast<String*>(self);
+Object* str_add(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
     
-    auto another_str = dynamic_cast<String*>(args->val[0]);
+    auto another_str = as<String>(argv[0]);
     if (!another_str)
         throw NativeFuncError("TypeError", "String.add only supports String type argument");
     
     // 拼接并返回新String
-    return new String(self_str->val + another_str->val);
+    return create_str(self_str->val + another_str->val);
 };
 
 // String.__mul__：字符串重复n次（self * n，返回新String，n为非负整数）
-Object* str_mul(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
-    auto self_str = dynamic_cast<String*>(self);
+Object* str_mul(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
     
-    auto times_int = dynamic_cast<Int*>(args->val[0]);
+    auto times_int = as<Int>(argv[0]);
     if (!times_int)
         throw NativeFuncError("TypeError","String.mul only supports Int type argument");
     if(times_int->val < dep::BigInt(0))
@@ -54,17 +52,16 @@ Object* str_mul(Object* self, const List* args) {
         result += self_str->val;
     }
     
-    return new String(std::move(result));
+    return create_str(std::move(result));
 };
 
 // String.__eq__：判断两个字符串是否相等 self == x
-Object* str_eq(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* str_eq(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_str = dynamic_cast<String*>(self);
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
     
-    auto another_str = dynamic_cast<String*>(args->val[0]);
+    auto another_str = as<String>(argv[0]);
     if (! another_str)
         throw NativeFuncError("TypeError","String.eq only supports String type argument");
     
@@ -72,13 +69,12 @@ Object* str_eq(Object* self, const List* args) {
 };
 
 // String.__contains__：判断是否包含子字符串 x in self
-Object* str_contains(Object* self, const List* args) {
-    kiz::Vm::assert_argc(1, args);
+Object* str_contains(Object* self, Object* const* argv, size_t argc) {
     
-    auto self_str = dynamic_cast<String*>(self);
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
     
-    auto sub_str = dynamic_cast<String*>(args->val[0]);
+    auto sub_str = as<String>(argv[0]);
     if(! sub_str)
         throw NativeFuncError("TypeError", "String.contains only supports String type argument");
     
@@ -87,94 +83,94 @@ Object* str_contains(Object* self, const List* args) {
 };
 
 // String.__hash__
-Object* str_hash(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
+Object* str_hash(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
     auto hashed_str = dep::hash_string(self_str->val);
-    return new Int(dep::BigInt(hashed_str));
+    return load_int(dep::BigInt(hashed_str));
 }
 
-Object* str_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
+Object* str_next(Object* self, Object* const* argv, size_t argc) {
+    auto curr_idx_it = self->attrs.find(model::magic_name::current_index);
     assert(curr_idx_it != nullptr);
 
     auto curr_idx = curr_idx_it->value;
 
     auto index = cast_to_int(curr_idx) ->val.to_unsigned_long_long();
 
-    auto self_str = dynamic_cast<String*>(self);
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
 
     if (index < self_str->val.size()) {
         auto res = dep::UTF8String(self_str->val)[index];
-        self->attrs_insert("__current_index__", new Int(index+1));
-        return new String(res.to_string());
+        self->attrs_insert(model::magic_name::current_index, load_int(index+1));
+        return create_str(res.to_string());
     }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
+    self->attrs_insert(model::magic_name::current_index, load_int(0));
     return load_stop_iter_signal();
 }
 
-Object* str_str(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
+Object* str_str(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
-    return new String(self_str->val);
+    return create_str(self_str->val);
 }
 
-Object* str_dstr(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
+Object* str_dstr(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
     assert(self_str != nullptr);
-    return new String("\"" + self_str->val + "\"");
+    return create_str("\"" + self_str->val + "\"");
 }
 
-Object* str_getitem(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
-    auto idx_obj = cast_to_int(builtin::get_one_arg(args));
+Object* str_getitem(Object* self, Object* const* argv, size_t argc) {
+    auto self_str = as<String>(self);
+    auto idx_obj = cast_to_int(builtin::get_one_arg(argv, argc));
     auto index = idx_obj->val.to_unsigned_long_long();
     auto text = dep::UTF8String(self_str->val);
 
     if (index >= text.size()) {
         throw NativeFuncError("GetItemError", std::format("index {} out of range", index));
     }
-    return new String( text[index] .to_string() );
+    return create_str( text[index] .to_string() );
 }
 
-Object* str_foreach(Object* self, const List* args) {
-    const auto func_obj = builtin::get_one_arg(args);
+Object* str_foreach(Object* self, Object* const* argv, size_t argc) {
+    const auto func_obj = builtin::get_one_arg(argv, argc);
 
     auto self_str = cast_to_str(self);
 
     dep::BigInt idx = 0;
     for (const auto& e : dep::UTF8String(self_str->val)) {
         kiz::Vm::call_function(func_obj, {
-            new String(e.to_string())
+            create_str(e.to_string())
         }, nullptr);
         idx += 1;
     }
     return load_nil();
 }
 
-Object* str_count(Object* self, const List* args) {
-    const auto obj = builtin::get_one_arg(args);
+Object* str_count(Object* self, Object* const* argv, size_t argc) {
+    const auto obj = builtin::get_one_arg(argv, argc);
     size_t count = 0;
     auto self_str = cast_to_str(self);
 
     for (const auto& c : dep::UTF8String(self_str->val)) {
-        kiz::Vm::call_method(obj, "__eq__", {
-            new String(c.to_string())
+        kiz::Vm::call_method(obj, model::magic_name::eq, {
+            create_str(c.to_string())
         });
         auto res = kiz::Vm::get_and_pop_stack_top();
         if (res.get()) {
             ++ count;
         }
     }
-    return new Int(count);
+    return load_int(count);
 }
 
 
-Object* str_startswith(Object* self, const List* args) {
+Object* str_startswith(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self)->val;
     auto prefix = cast_to_str(
-        builtin::get_one_arg(args)
+        builtin::get_one_arg(argv, argc)
     ) -> val;
 
     if (prefix.empty()) {
@@ -187,10 +183,10 @@ Object* str_startswith(Object* self, const List* args) {
     return load_bool(self_str.compare(0, prefix.size(), prefix) == 0);
 }
 
-Object* str_endswith(Object* self, const List* args) {
+Object* str_endswith(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self)->val;
     auto suffix = cast_to_str(
-        builtin::get_one_arg(args)
+        builtin::get_one_arg(argv, argc)
     ) -> val;
 
     if (suffix.empty()) {
@@ -205,13 +201,13 @@ Object* str_endswith(Object* self, const List* args) {
 
 }
 
-Object* str_len(Object* self, const List* args) {
+Object* str_len(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
 
-    return new Int(dep::UTF8String(self_str->val).size());
+    return load_int(dep::UTF8String(self_str->val).size());
 }
 
-Object* str_is_alpha(Object* self, const List* args) {
+Object* str_is_alpha(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
     auto str = dep::UTF8String(self_str->val);
     bool is_alpha = true;
@@ -221,7 +217,7 @@ Object* str_is_alpha(Object* self, const List* args) {
     return load_bool(is_alpha);
 }
 
-Object* str_is_digit(Object* self, const List* args) {
+Object* str_is_digit(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
     auto str = dep::UTF8String(self_str->val);
     bool is_digit = true;
@@ -232,10 +228,10 @@ Object* str_is_digit(Object* self, const List* args) {
 
 }
 
-Object* str_substr(Object* self, const List* args) {
+Object* str_substr(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
-    auto args_vec = args->val;
-    kiz::Vm::assert_argc(2, args);
+    const std::span args_vec(argv, argc);
+    kiz::Vm::assert_argc(2, argc);
 
     size_t pos = cast_to_int(args_vec[0])->val.to_unsigned_long_long();
     size_t len = 1;
@@ -243,28 +239,28 @@ Object* str_substr(Object* self, const List* args) {
         len = cast_to_int(args_vec[1])->val.to_unsigned_long_long();
     }
 
-    return new String(dep::UTF8String(self_str->val).substr(
+    return create_str(dep::UTF8String(self_str->val).substr(
         pos, len
     ).to_string());
 }
 
-Object* str_to_lower(Object* self, const List* args) {
+Object* str_to_lower(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
 
-    return new String(dep::UTF8String(self_str->val).to_lower().to_string());
+    return create_str(dep::UTF8String(self_str->val).to_lower().to_string());
 }
 
-Object* str_to_upper(Object* self, const List* args) {
+Object* str_to_upper(Object* self, Object* const* argv, size_t argc) {
     auto self_str = cast_to_str(self);
 
-    return new String(dep::UTF8String(self_str->val).to_upper().to_string());
+    return create_str(dep::UTF8String(self_str->val).to_upper().to_string());
 
 }
 
-Object* str_format(Object* self, const List* args) {
+Object* str_format(Object* self, Object* const* argv, size_t argc) {
     auto format_str = cast_to_str(self)->val;
     std::vector<std::string> str_vec;
-    for (auto item : args->val) {
+    for (auto item : std::span(argv, argc)) {
         str_vec.push_back(kiz::Vm::obj_to_str(item));
     }
 
@@ -297,7 +293,7 @@ Object* str_format(Object* self, const List* args) {
         pos = brace_pos + 2;
     }
 
-    return new String(result);
+    return create_str(result);
 }
 
 
@@ -0,0 +1,98 @@
+#include "include/gc_lib.hpp"
+
+#include "models/gc.hpp"
+
+namespace gc_lib {
+
+namespace {
+
+size_t get_size_arg(model::Object* arg, const std::string& func_name) {
+    const auto int_obj = model::as<model::Int>(arg);
+    long long val = 0;
+    if (!int_obj or !int_obj->val.try_to_long_long(val) or val < 0) {
+        throw NativeFuncError("TypeError", std::format(
+            "gc.{} requires a non-negative Int argument", func_name));
+    }
+    return static_cast<size_t>(val);
+}
+
+} // namespace
+
+model::Object* init_module(model::Object* self, model::Object* const* argv, size_t argc) {
+    auto mod = new model::Module("gc");
+
+    mod->attrs_insert("collect", model::create_nfunc(collect, 0, "collect"));
+    mod->attrs_insert("enable", model::create_nfunc(enable, 0, "enable"));
+    mod->attrs_insert("disable", model::create_nfunc(disable, 0, "disable"));
+    mod->attrs_insert("is_enabled", model::create_nfunc(is_enabled, 0, "is_enabled"));
+    mod->attrs_insert("set_threshold", model::create_nfunc(set_threshold, 1, "set_threshold"));
+    mod->attrs_insert("get_threshold", model::create_nfunc(get_threshold, 0, "get_threshold"));
+    mod->attrs_insert("set_budget", model::create_nfunc(set_budget, 1, "set_budget"));
+    mod->attrs_insert("get_budget", model::create_nfunc(get_budget, 0, "get_budget"));
+    mod->attrs_insert("stats", model::create_nfunc(stats, 0, "stats"));
+
+    return mod;
+}
+
+// 处理全部候选根, 返回回收的对象数
+model::Object* collect(model::Object* self, model::Object* const* argv, size_t argc) {
+    return model::load_int(static_cast<long long>(model::CycleCollector::collect(0)));
+}
+
+model::Object* enable(model::Object* self, model::Object* const* argv, size_t argc) {
+    model::CycleCollector::enabled = true;
+    return model::load_nil();
+}
+
+model::Object* disable(model::Object* self, model::Object* const* argv, size_t argc) {
+    model::CycleCollector::enabled = false;
+    return model::load_nil();
+}
+
+model::Object* is_enabled(model::Object* self, model::Object* const* argv, size_t argc) {
+    return model::load_bool(model::CycleCollector::enabled);
+}
+
+model::Object* set_threshold(model::Object* self, model::Object* const* argv, size_t argc) {
+    const size_t threshold = get_size_arg(argv[0], "set_threshold");
+    if (threshold == 0) throw NativeFuncError("ValueError", "gc threshold must be greater than 0");
+    model::gc_threshold = threshold;
+    model::gc_pending = model::gc_candidates.size() >= threshold;
+    return model::load_nil();
+}
+
+model::Object* get_threshold(model::Object* self, model::Object* const* argv, size_t argc) {
+    return model::load_int(static_cast<long long>(model::gc_threshold));
+}
+
+// 0表示每次自动回收都处理全部候选根
+model::Object* set_budget(model::Object* self, model::Object* const* argv, size_t argc) {
+    model::CycleCollector::budget = get_size_arg(argv[0], "set_budget");
+    return model::load_nil();
+}
+
+model::Object* get_budget(model::Object* self, model::Object* const* argv, size_t argc) {
+    return model::load_int(static_cast<long long>(model::CycleCollector::budget));
+}
+
+model::Object* stats(model::Object* self, model::Object* const* argv, size_t argc) {
+    const std::pair<std::string, size_t> items[] = {
+        {"collections", model::CycleCollector::collections},
+        {"freed", model::CycleCollector::freed_total},
+        {"last_freed", model::CycleCollector::last_freed},
+        {"candidates", model::gc_candidates.size()},
+        {"threshold", model::gc_threshold},
+        {"budget", model::CycleCollector::budget},
+    };
+    std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
+    for (const auto& [name, val] : items) {
+        elem_list.emplace_back(dep::hash_string(name),
+            std::pair<model::Object*, model::Object*> {
+                model::create_str(name), model::load_int(static_cast<long long>(val))
+            }
+        );
+    }
+    return new model::Dictionary(dep::Dict(elem_list));
+}
+
+}
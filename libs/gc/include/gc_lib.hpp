@@ -0,0 +1,20 @@
+#pragma once
+#include "models/models.hpp"
+
+namespace gc_lib {
+
+model::Object* init_module(model::Object* self, model::Object* const* argv, size_t argc);
+
+model::Object* collect(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* enable(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* disable(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* is_enabled(model::Object* self, model::Object* const* argv, size_t argc);
+
+model::Object* set_threshold(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* get_threshold(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* set_budget(model::Object* self, model::Object* const* argv, size_t argc);
+model::Object* get_budget(model::Object* self, model::Object* const* argv, size_t argc);
+
+model::Object* stats(model::Object* self, model::Object* const* argv, size_t argc);
+
+}
@@ -36,9 +36,11 @@ model::Object* init_module(model::Object* self, const model::List* args) {
 
 model::Object* get_args(model::Object* self, const model::List* args) {
     kiz::Vm::assert_argc(0, args);
-    auto argv = new model::List({});
+    auto argv = model::create_list({});
     for (auto c: rest_argv) {
-        argv->val.push_back(new model::String(c));
+        auto arg = model::create_str(c);
+        arg->make_ref();
+        argv->val.push_back(arg);
     }
     return argv;
 }
@@ -58,7 +60,7 @@ model::Object* get_env(model::Object* self, const model::List* args) {
                     std::string key = env_str.substr(0, eq_pos);
                     std::string val = env_str.substr(eq_pos + 1);
                     elem_list.emplace_back(dep::hash_string(key),
-                        std::pair {new model::String(key), new model::String(val)}
+                        std::pair {model::create_str(key), model::create_str(val)}
                     );
                 }
                 env++;
@@ -73,7 +75,7 @@ model::Object* get_env(model::Object* self, const model::List* args) {
                     std::string key = env_str.substr(0, eq_pos);
                     std::string val = env_str.substr(eq_pos + 1);
                     elem_list.emplace_back(dep::hash_string(key),
-                        std::pair {new model::String(key), new model::String(val)}
+                        std::pair {model::create_str(key), model::create_str(val)}
                     );
                 }
                 env++;
@@ -110,7 +112,7 @@ model::Object* cwd(model::Object* self, const model::List* args) {
 #endif
         throw NativeFuncError("SystemError", "Failed to get current working directory");
     }
-    return new model::String(std::string(buf));
+    return model::create_str(std::string(buf));
 }
 
 model::Object* chdir_(model::Object* self, const model::List* args) {
@@ -12,33 +12,21 @@ void IRGenerator::gen_expr(Expr* expr) {
         // 生成LOAD_CONST指令（加载字面量常量）
         auto const_obj = make_int_obj(dynamic_cast<NumberExpr*>(expr));
         size_t const_idx = get_or_add_const(const_obj);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{const_idx},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {const_idx}, expr->pos);
         break;
     }
     case AstType::StringExpr: {
         // 生成LOAD_CONST指令（加载字面量常量）
         auto const_obj = make_string_obj(dynamic_cast<StringExpr*>(expr));
         size_t const_idx = get_or_add_const(const_obj);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{const_idx},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {const_idx}, expr->pos);
         break;
     }
     case AstType::DecimalExpr: {
         // 生成LOAD_CONST指令（加载字面量常量）
         auto const_obj = make_decimal_obj(dynamic_cast<DecimalExpr*>(expr));
         size_t const_idx = get_or_add_const(const_obj);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{const_idx},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {const_idx}, expr->pos);
         break;
     }
     case AstType::IdentifierExpr: {
@@ -47,21 +35,13 @@ void IRGenerator::gen_expr(Expr* expr) {
         const auto name_idx_it = std::ranges::find(code_chunks.back().var_names, ident->name);
         if (name_idx_it != code_chunks.back().var_names.end()) {
             size_t name_idx = std::distance(code_chunks.back().var_names.begin(), name_idx_it);
-            code_chunks.back().code_list.emplace_back(
-                Opcode::LOAD_VAR,
-                std::vector{name_idx},
-                expr->pos
-            );
+            emit(Opcode::LOAD_VAR, {name_idx}, expr->pos);
         } else {
             // 可能已经注册入free_vars
             auto may_be_free_it = std::ranges::find(code_chunks.back().free_names, ident->name);
             if (may_be_free_it != code_chunks.back().free_names.end()) {
                 size_t name_idx = std::distance(code_chunks.back().free_names.begin(), may_be_free_it);
-                code_chunks.back().code_list.emplace_back(
-                    Opcode::LOAD_FREE_VAR,
-                    std::vector{name_idx},
-                    expr->pos
-                );
+                emit(Opcode::LOAD_FREE_VAR, {name_idx}, expr->pos);
                 break;
             }
 
@@ -80,22 +60,14 @@ void IRGenerator::gen_expr(Expr* expr) {
             if (!find_free_var_it) {
                 auto builtin_it = std::ranges::find(Vm::builtin_names, ident->name);
                 if (builtin_it != Vm::builtin_names.end()) {
-                    code_chunks.back().code_list.emplace_back(
-                        Opcode::LOAD_BUILTINS,
-                        std::vector{static_cast<size_t>(builtin_it - Vm::builtin_names.begin())},
-                        expr->pos
-                    );
+                    emit(Opcode::LOAD_BUILTINS, {static_cast<size_t>(builtin_it - Vm::builtin_names.begin())}, expr->pos);
                     break;
                 }
                 err::error_reporter(file_path, expr->pos, "NameError", "Undefined var '"+ident->name+"'");
             } else {
                 code_chunks.back().free_names.push_back(ident->name);
                 code_chunks.back().upvalues.push_back({i, name_idx});
-                code_chunks.back().code_list.emplace_back(
-                    Opcode::LOAD_FREE_VAR,
-                    std::vector{code_chunks.back().upvalues.size() - 1},
-                    expr->pos
-                );
+                emit(Opcode::LOAD_FREE_VAR, {code_chunks.back().upvalues.size() - 1}, expr->pos);
             }
         }
         break;
@@ -103,28 +75,33 @@ void IRGenerator::gen_expr(Expr* expr) {
     case AstType::BinaryExpr: {
         // 二元运算：生成左表达式 -> 右表达式 -> 运算指令
         const auto bin_expr = dynamic_cast<BinaryExpr*>(expr);
+        if (gen_folded(expr)) break;
         if (bin_expr->op == "and"){
             gen_expr(bin_expr->left.get());  // 左操作数
 
-            code_chunks.back().code_list.emplace_back(Opcode::COPY_TOP, std::vector<size_t>{}, expr->pos);
+            emit(Opcode::COPY_TOP, {}, expr->pos);
 
             size_t jump_if_false_idx = code_chunks.back().code_list.size();
-            code_chunks.back().code_list.emplace_back(Opcode::JUMP_IF_FALSE, std::vector<size_t>{0}, expr->pos);
+            emit(Opcode::JUMP_IF_FALSE, {0}, expr->pos);
 
-            gen_expr(bin_expr->right.get()); // 右操作数（栈中顺序：左在下，右在上）
+            // 不短路时左操作数不再需要, 结果只由右操作数决定
+            emit(Opcode::POP_TOP, {}, expr->pos);
+            gen_expr(bin_expr->right.get()); // 右操作数
             code_chunks.back().code_list[jump_if_false_idx].opn_list[0] = code_chunks.back().code_list.size();
             break;
         }
         if (bin_expr->op == "or") {
             gen_expr(bin_expr->left.get());  // 左操作数
 
-            code_chunks.back().code_list.emplace_back(Opcode::COPY_TOP, std::vector<size_t>{}, expr->pos);
+            emit(Opcode::COPY_TOP, {}, expr->pos);
 
-            code_chunks.back().code_list.emplace_back(Opcode::OP_NOT, std::vector<size_t>{}, expr->pos);
+            emit(Opcode::OP_NOT, {}, expr->pos);
             size_t jump_if_false_idx = code_chunks.back().code_list.size();
-            code_chunks.back().code_list.emplace_back(Opcode::JUMP_IF_FALSE, std::vector<size_t>{0}, expr->pos);
+            emit(Opcode::JUMP_IF_FALSE, {0}, expr->pos);
 
-            gen_expr(bin_expr->right.get()); // 右操作数（栈中顺序：左在下，右在上）
+            // 不短路时左操作数不再需要, 结果只由右操作数决定
+            emit(Opcode::POP_TOP, {}, expr->pos);
+            gen_expr(bin_expr->right.get()); // 右操作数
             code_chunks.back().code_list[jump_if_false_idx].opn_list[0] = code_chunks.back().code_list.size();
             break;
         }
@@ -153,16 +130,13 @@ void IRGenerator::gen_expr(Expr* expr) {
 
         else assert(false);
 
-        code_chunks.back().code_list.emplace_back(
-            opc,
-            std::vector<size_t>{},
-            expr->pos
-        );
+        emit(opc, {}, expr->pos);
         break;
     }
     case AstType::UnaryExpr: {
         // 一元运算：生成操作数 -> 运算指令
         auto unary_expr = dynamic_cast<UnaryExpr*>(expr);
+        if (gen_folded(expr)) break;
         gen_expr(unary_expr->operand.get());
 
         Opcode opc;
@@ -170,11 +144,7 @@ void IRGenerator::gen_expr(Expr* expr) {
         else if (unary_expr->op == "not") opc = Opcode::OP_NOT;
         else assert(false);
 
-        code_chunks.back().code_list.emplace_back(
-            opc,
-            std::vector<size_t>{},
-            expr->pos
-        );
+        emit(opc, {}, expr->pos);
         break;
     }
     case AstType::CallExpr:
@@ -190,11 +160,7 @@ void IRGenerator::gen_expr(Expr* expr) {
             gen_expr(e.get());
         }
         // 生成 OP_MAKE_LIST 指令
-        code_chunks.back().code_list.emplace_back(
-            Opcode::MAKE_LIST,
-            std::vector{list_expr->elements.size()},
-            expr->pos
-       );
+        emit(Opcode::MAKE_LIST, {list_expr->elements.size()}, expr->pos);
         break;
     }
     case AstType::GetMemberExpr: {
@@ -202,11 +168,7 @@ void IRGenerator::gen_expr(Expr* expr) {
         auto get_mem = dynamic_cast<GetMemberExpr*>(expr);
         gen_expr(get_mem->father.get()); // 生成对象IR
         size_t name_idx = get_or_add_name(code_chunks.back().attr_names, get_mem->child->name);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::GET_ATTR,
-            std::vector<size_t>{name_idx},
-            expr->pos
-        );
+        emit(Opcode::GET_ATTR, {name_idx}, expr->pos);
         break;
     }
     case AstType::GetItemExpr: {
@@ -218,19 +180,11 @@ void IRGenerator::gen_expr(Expr* expr) {
         }
 
         // 生成 OP_MAKE_LIST 指令：将栈顶 arg_count 个元素打包成参数列表，压回栈
-        code_chunks.back().code_list.emplace_back(
-            Opcode::MAKE_LIST,
-            std::vector{arg_count},
-            get_mem_expr->pos
-        );
+        emit(Opcode::MAKE_LIST, {arg_count}, get_mem_expr->pos);
 
         gen_expr(get_mem_expr->father.get());
 
-        code_chunks.back().code_list.emplace_back(
-            Opcode::GET_ITEM,
-            std::vector<size_t>{},
-            get_mem_expr->pos
-        );
+        emit(Opcode::GET_ITEM, {}, get_mem_expr->pos);
         break;
     }
     case AstType::LambdaExpr: {
@@ -250,16 +204,8 @@ void IRGenerator::gen_expr(Expr* expr) {
         if (code_chunks.back().code_list.empty() || code_chunks.back().code_list.back().opc != Opcode::RET) {
             const auto nil = model::load_nil();
             const size_t nil_idx = get_or_add_const(nil);
-            code_chunks.back().code_list.emplace_back(
-                Opcode::LOAD_CONST,
-                std::vector{nil_idx},
-                expr->pos
-            );
-            code_chunks.back().code_list.emplace_back(
-                Opcode::RET,
-                std::vector<size_t>{},
-                expr->pos
-            );
+            emit(Opcode::LOAD_CONST, {nil_idx}, expr->pos);
+            emit(Opcode::RET, {}, expr->pos);
         }
 
         // std::cout << "== IR Result ==" << std::endl;
@@ -279,16 +225,8 @@ void IRGenerator::gen_expr(Expr* expr) {
         // }
         // std::cout << "== End ==" << std::endl;
 
-        auto code_obj = new model::CodeObject(
-            code_chunks.back().code_list,
-            code_chunks.back().var_names,
-            code_chunks.back().attr_names,
-            code_chunks.back().free_names,
-            code_chunks.back().upvalues,
-            code_chunks.back().var_names.size(),
-            code_chunks.back().exception_tables,
-            code_chunks.back().ensure_stmts
-        );
+        auto code_obj = make_code_obj();
+        propagate_frame_reach();
         code_chunks.pop_back();
 
         // 生成lambda函数体IR
@@ -303,26 +241,14 @@ void IRGenerator::gen_expr(Expr* expr) {
 
         // 加载lambda函数对象
         const size_t fn_const_idx = get_or_add_const(lambda_fn);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{fn_const_idx},
-            expr->pos
-        );
-        code_chunks.back().code_list.emplace_back(
-            Opcode::CREATE_CLOSURE,
-            std::vector<size_t>{},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {fn_const_idx}, expr->pos);
+        emit(Opcode::CREATE_CLOSURE, {}, expr->pos);
         break;
     }
     case AstType::NilExpr : {
         const auto nil = model::load_nil();
         const size_t nil_idx = get_or_add_const(nil);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{nil_idx},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {nil_idx}, expr->pos);
         break;
     }
     case AstType::BoolExpr : {
@@ -330,11 +256,7 @@ void IRGenerator::gen_expr(Expr* expr) {
         assert(bool_ast!=nullptr);
         const auto bool_obj = model::load_bool(bool_ast->val);
         const size_t bool_idx = get_or_add_const(bool_obj);
-        code_chunks.back().code_list.emplace_back(
-            Opcode::LOAD_CONST,
-            std::vector{bool_idx},
-            expr->pos
-        );
+        emit(Opcode::LOAD_CONST, {bool_idx}, expr->pos);
         break;
     }
     default:
@@ -346,18 +268,11 @@ void IRGenerator::gen_fn_call(CallExpr* call_expr) {
     assert(call_expr && "gen_fn_call: 函数调用节点为空");
     size_t arg_count = call_expr->args.size();
 
-    // 生成所有参数的IR，最终打包成List（与原逻辑一致）
+    // 生成所有参数的IR, 参数留在操作数栈上, 由CALL/CALL_METHOD按个数直接取用
     for (auto& arg : call_expr->args) {
         gen_expr(arg.get());
     }
 
-    // 生成 OP_MAKE_LIST 指令：将栈顶 arg_count 个元素打包成参数列表，压回栈
-    code_chunks.back().code_list.emplace_back(
-        Opcode::MAKE_LIST,
-        std::vector<size_t>{arg_count},
-        call_expr->pos
-    );
-
     // 判断 callee 是否为 GetMemberExpr
     if (auto member_expr = dynamic_cast<GetMemberExpr*>(call_expr->callee.get())) {
         gen_expr(member_expr->father.get()); 
@@ -366,20 +281,12 @@ void IRGenerator::gen_fn_call(CallExpr* call_expr) {
         const std::string& method_name = member_expr->child->name;
         size_t method_name_idx = get_or_add_name(code_chunks.back().attr_names, method_name);
 
-        // 生成 CALL_METHOD 指令：操作数为 方法名索引 + 参数个数（用于校验）
-        code_chunks.back().code_list.emplace_back(
-            Opcode::CALL_METHOD,
-            std::vector{method_name_idx, arg_count},
-            call_expr->pos
-        );
+        // 生成 CALL_METHOD 指令：操作数为 方法名索引 + 参数个数
+        emit(Opcode::CALL_METHOD, {method_name_idx, arg_count}, call_expr->pos);
     } else {
         // 普通函数调用：生成函数对象IR → 生成 CALL 指令
         gen_expr(call_expr->callee.get());
-        code_chunks.back().code_list.emplace_back(
-            Opcode::CALL,
-            std::vector{arg_count},
-            call_expr->pos
-        );
+        emit(Opcode::CALL, {arg_count}, call_expr->pos);
     }
 }
 
@@ -392,11 +299,7 @@ void IRGenerator::gen_dict(DictExpr* expr) {
     }
 
     size_t dict_size = expr->elements.size();
-    code_chunks.back().code_list.emplace_back(
-        Opcode::MAKE_DICT,
-        std::vector{dict_size},
-        expr->pos
-    );
+    emit(Opcode::MAKE_DICT, {dict_size}, expr->pos);
 }
 
 }
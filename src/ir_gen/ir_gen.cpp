@@ -50,9 +50,19 @@ model::CodeObject* IRGenerator::gen(std::unique_ptr<BlockStmt> ast_into, const s
     code_chunks.emplace_back(CodeChunk());
     if (!global_var_names_into.empty()) {
         code_chunks.back().var_names = global_var_names_into;
+        // REPL: 之前输入的函数可能用SET_GLOBAL改写这些变量
+        code_chunks.back().locals_written_externally = true;
     }
     gen_block(root_block);
 
+    // 模块末尾的表达式语句把结果留在栈顶, 供REPL打印
+    auto& module_chunk = code_chunks.back();
+    if (!root_block->statements.empty() and root_block->statements.back()->ast_type == AstType::ExprStmt
+        and !module_chunk.code_list.empty() and module_chunk.code_list.back().opc == Opcode::POP_TOP) {
+        module_chunk.code_list.pop_back();
+        module_chunk.code_pos.pop_back();
+    }
+
     // std::cout << "== IR Result ==" << std::endl;
     // size_t i = 0;
     // for (const auto& inst : code_chunks.back().code_list) {
@@ -70,31 +80,73 @@ model::CodeObject* IRGenerator::gen(std::unique_ptr<BlockStmt> ast_into, const s
     // }
     // std::cout << "== End ==" << std::endl;
 
-    auto code_obj = new model::CodeObject(
-        code_chunks.back().code_list,
-        code_chunks.back().var_names,
-        code_chunks.back().attr_names,
-        code_chunks.back().free_names,
-        code_chunks.back().upvalues,
-        code_chunks.back().var_names.size(),
-        code_chunks.back().exception_tables,
-        code_chunks.back().ensure_stmts
-    );
+    auto code_obj = make_code_obj();
 
     return code_obj;
 }
 
+void IRGenerator::emit(const Opcode opc, const std::initializer_list<size_t> opn_list, const err::PositionInfo& pos) {
+    code_chunks.back().code_list.emplace_back(opc, opn_list);
+    code_chunks.back().code_pos.push_back(pos);
+}
+
+model::CodeObject* IRGenerator::make_code_obj() {
+    auto& chunk = code_chunks.back();
+    size_t temp_count = 0;
+    if (Vm::engine == Vm::Engine::Register) {
+        // 寄存器代码不再经过窥孔优化; 只有模块的主体需要为REPL保留末尾表达式的结果
+        const bool is_module = code_chunks.size() == 1;
+        temp_count = gen_registers(chunk.code_list, chunk.code_pos, &chunk.exception_tables,
+            chunk.var_names.size(), chunk.locals_written_externally, is_module);
+        temp_count = std::max(temp_count, gen_registers(chunk.ensure_stmts, chunk.ensure_pos, nullptr,
+            chunk.var_names.size(), chunk.locals_written_externally, false));
+    } else if (opt_level >= 1) {
+        peephole(chunk.code_list);
+        peephole(chunk.ensure_stmts);
+    }
+
+    // 给每条GET_ATTR/CALL_METHOD分配内联缓存槽位(第3个操作数), ensure块与主体共用同一组缓存
+    size_t attr_cache_count = 0;
+    auto assign_cache_slots = [&](std::vector<Instruction>& insts) {
+        for (auto& inst : insts) {
+            if (inst.opc == Opcode::GET_ATTR or inst.opc == Opcode::CALL_METHOD
+                or inst.opc == Opcode::REG_GET_ATTR or inst.opc == Opcode::REG_CALL_METHOD) {
+                inst.opn_list[2] = static_cast<uint32_t>(attr_cache_count++);
+            }
+        }
+    };
+    assign_cache_slots(chunk.code_list);
+    assign_cache_slots(chunk.ensure_stmts);
+
+    // 属性名在这里登记为符号, 运行时按符号查找属性
+    std::vector<model::Symbol> attr_symbols;
+    attr_symbols.reserve(chunk.attr_names.size());
+    for (const auto& attr_name : chunk.attr_names) {
+        attr_symbols.push_back(model::Symbol::intern(attr_name));
+    }
+
+    const auto code_obj = new model::CodeObject(
+        chunk.code_list,
+        model::make_pos_table(chunk.code_pos),
+        chunk.var_names,
+        attr_symbols,
+        chunk.free_names,
+        chunk.upvalues,
+        chunk.var_names.size(),
+        chunk.exception_tables,
+        chunk.ensure_stmts,
+        model::make_pos_table(chunk.ensure_pos),
+        attr_cache_count
+    );
+    code_obj->frame_reach = chunk.frame_reach;
+    code_obj->temp_count = temp_count;
+    return code_obj;
+}
+
 model::Int* IRGenerator::make_int_obj(const NumberExpr* num_expr) {
     DEBUG_OUTPUT("making int object...");
     assert(num_expr);
-    auto the_num = dep::BigInt(num_expr->value);
-    if (the_num >= 0 and the_num < 201) {
-        auto obj = Vm::small_int_pool[the_num.to_unsigned_long_long()];
-        return obj;
-    }
-
-    auto int_obj = new model::Int( the_num );
-    return int_obj;
+    return model::load_int(dep::BigInt(num_expr->value));
 }
 
 
@@ -108,7 +160,7 @@ model::Decimal* IRGenerator::make_decimal_obj(const DecimalExpr* dec_expr) {
 model::String* IRGenerator::make_string_obj(const StringExpr* str_expr) {
     DEBUG_OUTPUT("making string object...");
     assert(str_expr);
-    auto str_obj = new model::String(str_expr->value);
+    auto str_obj = model::create_str(str_expr->value);
     return str_obj;
 }
 
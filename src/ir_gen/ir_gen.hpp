@@ -10,7 +10,9 @@
 #include "../parser/ast.hpp"
 #include "../models/models.hpp"
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <stack>
 #include <vector>
 
@@ -29,17 +31,26 @@ struct CodeChunk {
     std::vector<std::string> free_names;
 
     std::vector<Instruction> code_list;
+    std::vector<err::PositionInfo> code_pos; // 与code_list一一对应, 生成CodeObject时压缩成位置表
     std::vector<LoopInfo> loop_info_stack;
     std::vector<model::UpValue> upvalues;
 
     std::vector<model::ExceptionTable> exception_tables;
     std::vector<Instruction> ensure_stmts;
+    std::vector<err::PositionInfo> ensure_pos;
+
+    size_t try_depth = 0; // 所在try/catch的层数, 其中的调用不能改写为尾调用
+    size_t frame_reach = 0; // 见CodeObject::frame_reach
+    // 局部变量会被其他帧改写(内层函数的SET_NONLOCAL, 函数里的SET_GLOBAL, REPL之后输入的代码),
+    // 寄存器后端不能把这样的局部变量留到调用之后再读(见reg_gen.cpp)
+    bool locals_written_externally = false;
 };
 
 class IRGenerator {
     std::unique_ptr<BlockStmt> ast;
     std::vector<CodeChunk> code_chunks;
     const std::string& file_path;
+    bool in_folded_fallback = false;
 public:
     explicit IRGenerator(const std::string& file_path) : file_path(file_path) {}
     model::CodeObject* gen(std::unique_ptr<BlockStmt> ast_into, const std::vector<std::string>& global_var_names_into = {});
@@ -51,10 +62,47 @@ public:
     );
     std::vector<std::string> get_global_var_names();
 
+    ///| 窥孔优化(见peephole.cpp): 把常见指令序列融合为超级指令, 并统计融合次数
+    static void peephole(std::vector<Instruction>& code);
+    static void print_peephole_stats();
+    static bool show_peephole_stats;
+    static std::map<Opcode, size_t> peephole_stats;
+    static size_t peephole_scanned;
+
+    ///| 寄存器后端(见reg_gen.cpp): --vm=register时代替窥孔优化, 把栈指令翻译为寄存器指令, 返回用到的临时寄存器数
+    static size_t gen_registers(std::vector<Instruction>& code, std::vector<err::PositionInfo>& code_pos,
+        std::vector<model::ExceptionTable>* exception_tables, size_t locals_count, bool locals_exposed, bool keep_result);
+
+    ///| 优化级别: 0关闭所有优化, 1(默认)开启常量折叠, 死代码消除(见optimize.cpp)和窥孔优化
+    static int opt_level;
+
 private:
+    void emit(Opcode opc, std::initializer_list<size_t> opn_list, const err::PositionInfo& pos);
+    model::CodeObject* make_code_obj();
+
+    // 生成不可达代码前的状态, 用于回滚已生成的指令
+    struct GenCheckpoint {
+        size_t code_size;
+        size_t exception_table_count;
+        size_t break_count;
+        size_t continue_count;
+    };
+    [[nodiscard]] GenCheckpoint save_checkpoint() const;
+    void rollback(const GenCheckpoint& checkpoint);
+    void gen_unreachable(const BlockStmt* block);
+    bool gen_folded(Expr* expr);
+    static model::Object* fold_const(Expr* expr);
+    static model::Object* fold_const_rec(Expr* expr);
+    static std::optional<bool> fold_condition(Expr* expr);
+    void mark_tail_call(const Expr* ret_expr);
+    void note_frame_reach(size_t distance);
+    void note_external_write(size_t distance);
+    void propagate_frame_reach();
+
     void gen_for(ForStmt* for_stmt);
     void gen_try(TryStmt* try_stmt);
     void gen_block(const BlockStmt* block);
+    void gen_stmt(Stmt* stmt);
 
     void gen_fn_call(CallExpr* expr);
     void gen_dict(DictExpr* expr);
@@ -0,0 +1,243 @@
+/**
+ * @file optimize.cpp
+ * @brief 生成IR时的常量折叠与死代码消除(-O1, 默认开启)
+ * 常量折叠: 只由Int/Decimal/Str/Bool/Nil字面量和算术/比较/取负/not组成的表达式,
+ * 在生成IR时直接算出结果. 计算复用Vm::try_fast_binary_op, 结果与运行时完全一致;
+ * 除零等需要抛错的情况不折叠, 留到运行时按原协议报错.
+ * 折叠结果由LOAD_FOLDED加载, 其后仍保留未折叠的原指令: 内置类型的运算被脚本改写后
+ * (Vm::builtin_ops_intact为false)LOAD_FOLDED不再生效, 转而执行原指令.
+ * 死代码消除: 条件为True/False/Nil字面量(及其not)的if/while只生成会执行的分支,
+ * return/throw/break/next之后的语句不再生成.
+ * 不可达的代码仍然照常生成一遍再回滚指令, 变量名, 常量和ensure块的登记保持不变,
+ * 因此编译期的名字解析结果与-O0一致.
+ * 尾调用: 函数中不在try/catch里的return f(...)改写为TAIL_CALL, 由虚拟机复用当前帧
+ */
+
+#include "ir_gen.hpp"
+#include "../opcode/opcode.hpp"
+#include "../vm/vm.hpp"
+
+#include <algorithm>
+
+namespace kiz {
+
+int IRGenerator::opt_level = 1;
+
+namespace {
+
+std::optional<Opcode> foldable_binary_op(const std::string& op) {
+    if (op == "+") return Opcode::OP_ADD;
+    if (op == "-") return Opcode::OP_SUB;
+    if (op == "*") return Opcode::OP_MUL;
+    if (op == "/") return Opcode::OP_DIV;
+    if (op == "%") return Opcode::OP_MOD;
+    if (op == "^") return Opcode::OP_POW;
+    if (op == "==") return Opcode::OP_EQ;
+    if (op == "!=") return Opcode::OP_NE;
+    if (op == "<") return Opcode::OP_LT;
+    if (op == ">") return Opcode::OP_GT;
+    if (op == "<=") return Opcode::OP_LE;
+    if (op == ">=") return Opcode::OP_GE;
+    // and/or 保留原有的求值和出栈方式, 不折叠
+    return std::nullopt;
+}
+
+// 表达式是否只由字面量和可折叠的运算符组成(不创建任何对象)
+bool is_const_expr(const Expr* expr) {
+    switch (expr->ast_type) {
+        case AstType::NumberExpr: case AstType::DecimalExpr: case AstType::StringExpr:
+        case AstType::BoolExpr: case AstType::NilExpr:
+            return true;
+        case AstType::BinaryExpr: {
+            const auto bin_expr = static_cast<const BinaryExpr*>(expr);
+            return foldable_binary_op(bin_expr->op).has_value()
+                and is_const_expr(bin_expr->left.get()) and is_const_expr(bin_expr->right.get());
+        }
+        case AstType::UnaryExpr: {
+            const auto unary_expr = static_cast<const UnaryExpr*>(expr);
+            return (unary_expr->op == "-" or unary_expr->op == "not")
+                and is_const_expr(unary_expr->operand.get());
+        }
+        default:
+            return false;
+    }
+}
+
+// 真假不依赖任何可被改写的运算符的条件
+bool is_literal_condition(const Expr* expr) {
+    if (expr->ast_type == AstType::BoolExpr or expr->ast_type == AstType::NilExpr) return true;
+    if (expr->ast_type == AstType::UnaryExpr) {
+        const auto unary_expr = static_cast<const UnaryExpr*>(expr);
+        return unary_expr->op == "not" and is_literal_condition(unary_expr->operand.get());
+    }
+    return false;
+}
+
+bool is_terminator(const AstType t) {
+    return t == AstType::ReturnStmt or t == AstType::ThrowStmt
+        or t == AstType::BreakStmt or t == AstType::NextStmt;
+}
+
+} // namespace
+
+model::Object* IRGenerator::fold_const(Expr* expr) {
+    if (opt_level < 1 or !is_const_expr(expr)) return nullptr;
+    return fold_const_rec(expr);
+}
+
+bool IRGenerator::gen_folded(Expr* expr) {
+    // 正在生成某个折叠结果的保底指令时, 子表达式不再重复折叠
+    if (in_folded_fallback) return false;
+    const auto folded = fold_const(expr);
+    if (!folded) return false;
+
+    const size_t guard_idx = code_chunks.back().code_list.size();
+    emit(Opcode::LOAD_FOLDED, {get_or_add_const(folded), 0}, expr->pos);
+    in_folded_fallback = true;
+    gen_expr(expr);
+    in_folded_fallback = false;
+    code_chunks.back().code_list[guard_idx].opn_list[1] = code_chunks.back().code_list.size();
+    return true;
+}
+
+// 返回的对象已持有一个引用, 折叠失败返回nullptr
+model::Object* IRGenerator::fold_const_rec(Expr* expr) {
+    model::Object* result = nullptr;
+    switch (expr->ast_type) {
+        case AstType::NumberExpr:
+            result = make_int_obj(static_cast<NumberExpr*>(expr));
+            break;
+        case AstType::DecimalExpr:
+            result = make_decimal_obj(static_cast<DecimalExpr*>(expr));
+            break;
+        case AstType::StringExpr:
+            result = make_string_obj(static_cast<StringExpr*>(expr));
+            break;
+        case AstType::BoolExpr:
+            result = model::load_bool(static_cast<BoolExpr*>(expr)->val);
+            break;
+        case AstType::NilExpr:
+            result = model::load_nil();
+            break;
+        case AstType::BinaryExpr: {
+            const auto bin_expr = static_cast<BinaryExpr*>(expr);
+            const auto left = fold_const_rec(bin_expr->left.get());
+            if (!left) return nullptr;
+            const auto right = fold_const_rec(bin_expr->right.get());
+            if (right) {
+                result = Vm::try_fast_binary_op(*foldable_binary_op(bin_expr->op), left, right);
+                if (result) result->make_ref();
+                right->del_ref();
+            }
+            left->del_ref();
+            return result;
+        }
+        case AstType::UnaryExpr: {
+            const auto unary_expr = static_cast<UnaryExpr*>(expr);
+            const auto operand = fold_const_rec(unary_expr->operand.get());
+            if (!operand) return nullptr;
+            if (unary_expr->op == "-") {
+                result = Vm::try_fast_neg(operand);
+            } else if (operand->get_type() == model::Object::ObjectType::Bool
+                or operand->get_type() == model::Object::ObjectType::Nil) {
+                // not只折叠真假值不需要调用__bool__的操作数
+                result = model::load_bool(!Vm::is_true(operand));
+            }
+            if (result) result->make_ref();
+            operand->del_ref();
+            return result;
+        }
+        default:
+            return nullptr;
+    }
+    result->make_ref();
+    return result;
+}
+
+std::optional<bool> IRGenerator::fold_condition(Expr* expr) {
+    if (!is_literal_condition(expr)) return std::nullopt;
+    const auto cond = fold_const(expr);
+    if (!cond) return std::nullopt;
+    const bool truth = Vm::is_true(cond);
+    cond->del_ref();
+    return truth;
+}
+
+void IRGenerator::mark_tail_call(const Expr* ret_expr) {
+    auto& chunk = code_chunks.back();
+    // 模块顶层没有可复用的函数帧; try/catch里的调用必须留在当前帧内, 异常才能被捕获
+    if (opt_level < 1 or code_chunks.size() < 2 or chunk.try_depth > 0) return;
+    if (ret_expr->ast_type != AstType::CallExpr or chunk.code_list.empty()) return;
+    // 普通调用的CALL是函数调用表达式生成的最后一条指令; 方法调用(CALL_METHOD)不改写
+    if (auto& last = chunk.code_list.back(); last.opc == Opcode::CALL) {
+        last.opc = Opcode::TAIL_CALL;
+    }
+}
+
+// 当前函数执行到SET_NONLOCAL时, 要回溯到自身帧之下distance层的帧
+void IRGenerator::note_frame_reach(const size_t distance) {
+    auto& chunk = code_chunks.back();
+    chunk.frame_reach = std::max(chunk.frame_reach, distance);
+}
+
+// SET_NONLOCAL写的是外层distance层函数的局部变量
+void IRGenerator::note_external_write(const size_t distance) {
+    if (distance >= code_chunks.size()) return;
+    code_chunks[code_chunks.size() - 1 - distance].locals_written_externally = true;
+}
+
+// 子函数生成完毕(仍在code_chunks末尾)时调用: 父函数为它创建闭包时按upvalue的距离回溯调用栈,
+// 子函数自身的回溯则从父函数帧之上开始算起, 都要折算到父函数上
+void IRGenerator::propagate_frame_reach() {
+    const auto& child = code_chunks.back();
+    auto& parent = code_chunks[code_chunks.size() - 2];
+    size_t reach = child.frame_reach;
+    for (const auto& upvalue : child.upvalues) {
+        reach = std::max(reach, upvalue.distance_from_curr);
+    }
+    if (reach > 1) parent.frame_reach = std::max(parent.frame_reach, reach - 1);
+}
+
+IRGenerator::GenCheckpoint IRGenerator::save_checkpoint() const {
+    const auto& chunk = code_chunks.back();
+    GenCheckpoint checkpoint{chunk.code_list.size(), chunk.exception_tables.size(), 0, 0};
+    if (!chunk.loop_info_stack.empty()) {
+        checkpoint.break_count = chunk.loop_info_stack.back().break_pos.size();
+        checkpoint.continue_count = chunk.loop_info_stack.back().continue_pos.size();
+    }
+    return checkpoint;
+}
+
+void IRGenerator::rollback(const GenCheckpoint& checkpoint) {
+    auto& chunk = code_chunks.back();
+    chunk.code_list.erase(chunk.code_list.begin() + static_cast<std::ptrdiff_t>(checkpoint.code_size), chunk.code_list.end());
+    chunk.code_pos.erase(chunk.code_pos.begin() + static_cast<std::ptrdiff_t>(checkpoint.code_size), chunk.code_pos.end());
+    chunk.exception_tables.erase(
+        chunk.exception_tables.begin() + static_cast<std::ptrdiff_t>(checkpoint.exception_table_count),
+        chunk.exception_tables.end());
+    if (!chunk.loop_info_stack.empty()) {
+        chunk.loop_info_stack.back().break_pos.resize(checkpoint.break_count);
+        chunk.loop_info_stack.back().continue_pos.resize(checkpoint.continue_count);
+    }
+}
+
+void IRGenerator::gen_unreachable(const BlockStmt* block) {
+    const auto checkpoint = save_checkpoint();
+    gen_block(block);
+    rollback(checkpoint);
+}
+
+void IRGenerator::gen_block(const BlockStmt* block) {
+    const auto& stmts = block->statements;
+    for (size_t i = 0; i < stmts.size(); ++i) {
+        gen_stmt(stmts[i].get());
+        if (opt_level >= 1 and is_terminator(stmts[i]->ast_type) and i + 1 < stmts.size()) {
+            // 同一块中后面的语句不可达
+            const auto checkpoint = save_checkpoint();
+            for (++i; i < stmts.size(); ++i) gen_stmt(stmts[i].get());
+            rollback(checkpoint);
+        }
+    }
+}
+
+} // namespace kiz
@@ -0,0 +1,128 @@
+/**
+ * @file peephole.cpp
+ * @brief 窥孔优化: 把常见的指令序列融合为超级指令
+ * 只原地改写序列的第一条指令, 序列其余指令保持原样, 因此不需要重排跳转目标和位置表:
+ * 从序列开头进入时执行超级指令并跳过整段, 跳转到序列中间时照常逐条执行;
+ * 超级指令的快速路径不适用时, 只完成第一条原指令的效果, 剩下的交给保留的原指令
+ */
+
+#include "ir_gen.hpp"
+#include "../opcode/opcode.hpp"
+#include "../vm/vm.hpp"
+
+#include <iostream>
+
+namespace kiz {
+
+bool IRGenerator::show_peephole_stats = false;
+std::map<Opcode, size_t> IRGenerator::peephole_stats {};
+size_t IRGenerator::peephole_scanned = 0;
+
+namespace {
+
+bool is_fast_binary_op(const Opcode opc) {
+    switch (opc) {
+        case Opcode::OP_ADD: case Opcode::OP_SUB: case Opcode::OP_MUL: case Opcode::OP_DIV:
+        case Opcode::OP_MOD: case Opcode::OP_POW: case Opcode::OP_EQ: case Opcode::OP_NE:
+        case Opcode::OP_LT: case Opcode::OP_GT: case Opcode::OP_LE: case Opcode::OP_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_compare_op(const Opcode opc) {
+    switch (opc) {
+        case Opcode::OP_EQ: case Opcode::OP_NE: case Opcode::OP_LT:
+        case Opcode::OP_GT: case Opcode::OP_LE: case Opcode::OP_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 尝试以code[i]开头匹配一个序列, 成功则返回融合后的指令
+std::optional<Instruction> match_at(const std::vector<Instruction>& code, const size_t i) {
+    const size_t rest = code.size() - i;
+    const auto opc_at = [&](const size_t k) { return code[i + k].opc; };
+    const auto opn_at = [&](const size_t k, const size_t n) -> size_t { return code[i + k].opn_list[n]; };
+
+    // LOAD_VAR x; LOAD_CONST c(Int); OP_ADD; SET_LOCAL x  =>  INC_LOCAL x, c
+    if (rest >= 4 and opc_at(0) == Opcode::LOAD_VAR and opc_at(1) == Opcode::LOAD_CONST
+        and opc_at(2) == Opcode::OP_ADD and opc_at(3) == Opcode::SET_LOCAL
+        and opn_at(0, 0) == opn_at(3, 0)
+        and Vm::const_pool[opn_at(1, 0)]->get_type() == model::Object::ObjectType::Int) {
+        return Instruction(Opcode::INC_LOCAL, {opn_at(0, 0), opn_at(1, 0)});
+    }
+
+    // LOAD_VAR x; LOAD_VAR/LOAD_CONST y; 二元运算  =>  BINARY_VAR_VAR / BINARY_VAR_CONST x, y, op
+    if (rest >= 3 and opc_at(0) == Opcode::LOAD_VAR and is_fast_binary_op(opc_at(2))) {
+        if (opc_at(1) == Opcode::LOAD_VAR) {
+            return Instruction(Opcode::BINARY_VAR_VAR,
+                {opn_at(0, 0), opn_at(1, 0), static_cast<size_t>(opc_at(2))});
+        }
+        if (opc_at(1) == Opcode::LOAD_CONST) {
+            return Instruction(Opcode::BINARY_VAR_CONST,
+                {opn_at(0, 0), opn_at(1, 0), static_cast<size_t>(opc_at(2))});
+        }
+    }
+
+    // COPY_TOP; OP_NOT; JUMP_IF_FALSE t; POP_TOP  =>  JUMP_IF_TRUE_KEEP t (or表达式)
+    if (rest >= 4 and opc_at(0) == Opcode::COPY_TOP and opc_at(1) == Opcode::OP_NOT
+        and opc_at(2) == Opcode::JUMP_IF_FALSE and opc_at(3) == Opcode::POP_TOP) {
+        return Instruction(Opcode::JUMP_IF_TRUE_KEEP, {opn_at(2, 0)});
+    }
+
+    // SET_LOCAL x; LOAD_VAR x; JUMP_IF_FINISH_ITER t  =>  SET_LOCAL_JUMP_IF_FINISH_ITER x, t (for循环)
+    if (rest >= 3 and opc_at(0) == Opcode::SET_LOCAL and opc_at(1) == Opcode::LOAD_VAR
+        and opc_at(2) == Opcode::JUMP_IF_FINISH_ITER and opn_at(0, 0) == opn_at(1, 0)) {
+        return Instruction(Opcode::SET_LOCAL_JUMP_IF_FINISH_ITER, {opn_at(0, 0), opn_at(2, 0)});
+    }
+
+    if (rest >= 2) {
+        // 比较; JUMP_IF_FALSE t  =>  COMPARE_JUMP_IF_FALSE op, t
+        if (is_compare_op(opc_at(0)) and opc_at(1) == Opcode::JUMP_IF_FALSE) {
+            return Instruction(Opcode::COMPARE_JUMP_IF_FALSE, {static_cast<size_t>(opc_at(0)), opn_at(1, 0)});
+        }
+        // COPY_TOP; JUMP_IF_FALSE t; POP_TOP  =>  JUMP_IF_FALSE_KEEP t (and表达式)
+        if (rest >= 3 and opc_at(0) == Opcode::COPY_TOP and opc_at(1) == Opcode::JUMP_IF_FALSE
+            and opc_at(2) == Opcode::POP_TOP) {
+            return Instruction(Opcode::JUMP_IF_FALSE_KEEP, {opn_at(1, 0)});
+        }
+        if (opc_at(0) == Opcode::LOAD_VAR and opc_at(1) == Opcode::LOAD_VAR) {
+            return Instruction(Opcode::LOAD_VAR_LOAD_VAR, {opn_at(0, 0), opn_at(1, 0)});
+        }
+        if (opc_at(0) == Opcode::LOAD_VAR and opc_at(1) == Opcode::LOAD_CONST) {
+            return Instruction(Opcode::LOAD_VAR_LOAD_CONST, {opn_at(0, 0), opn_at(1, 0)});
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace
+
+void IRGenerator::peephole(std::vector<Instruction>& code) {
+    // 依次从每个位置尝试匹配; 融合只改写code[i], 后面的位置仍按原指令匹配, 允许相互重叠
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (const auto fused = match_at(code, i)) {
+            code[i] = *fused;
+            ++peephole_stats[fused->opc];
+        }
+    }
+    peephole_scanned += code.size();
+}
+
+void IRGenerator::print_peephole_stats() {
+    size_t total = 0;
+    for (const auto& count : peephole_stats | std::views::values) total += count;
+
+    std::cout << "== Peephole Stats ==\n";
+    std::cout << "instructions: " << peephole_scanned << ", fused: " << total << "\n";
+    for (const auto& [opc, count] : peephole_stats) {
+        std::cout << "  " << opcode_to_string(opc) << ": " << count << "\n";
+    }
+    std::cout << "== End ==" << std::endl;
+}
+
+} // namespace kiz
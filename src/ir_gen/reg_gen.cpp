@@ -0,0 +1,504 @@
+/**
+ * @file reg_gen.cpp
+ * @brief 寄存器后端(--vm=register): 把栈指令翻译为以帧内槽位为操作数的三地址指令
+ * 按指令顺序模拟操作数栈, 虚拟栈上每一项记为它的值所在的槽位: 第i层的临时值固定放在
+ * 临时寄存器i(槽位locals_count + i); LOAD_VAR/LOAD_CONST/LOAD_BUILTINS不生成指令,
+ * 只把局部变量或常量记在虚拟栈上, 由用到它的指令直接读取.
+ * 跳转指令和跳转目标处把虚拟栈上的所有项落到各自的临时寄存器里, 从任何路径到达同一位置时
+ * 寄存器布局都一致. 临时值从不压到op_stack的栈顶, 调用时参数按顺序放在连续的临时寄存器中,
+ * 由handle_call原地取用, 返回值落在第一个参数的位置上.
+ */
+
+#include "ir_gen.hpp"
+#include "../opcode/opcode.hpp"
+#include "../vm/vm.hpp"
+
+#include <algorithm>
+
+namespace kiz {
+
+namespace {
+
+constexpr uint32_t const_bit = Instruction::const_operand_bit;
+
+bool is_binary_op(const Opcode opc) {
+    switch (opc) {
+        case Opcode::OP_ADD: case Opcode::OP_SUB: case Opcode::OP_MUL: case Opcode::OP_DIV:
+        case Opcode::OP_MOD: case Opcode::OP_POW: case Opcode::OP_EQ: case Opcode::OP_NE:
+        case Opcode::OP_LT: case Opcode::OP_GT: case Opcode::OP_LE: case Opcode::OP_GE:
+        case Opcode::OP_IS: case Opcode::OP_IN: case Opcode::IS_CHILD: case Opcode::GET_ITEM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_compare_op(const Opcode opc) {
+    switch (opc) {
+        case Opcode::OP_EQ: case Opcode::OP_NE: case Opcode::OP_LT:
+        case Opcode::OP_GT: case Opcode::OP_LE: case Opcode::OP_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 栈指令中跳转目标所在的操作数
+std::optional<size_t> jump_target_operand(const Instruction& inst) {
+    switch (inst.opc) {
+        case Opcode::JUMP: case Opcode::JUMP_IF_FALSE: case Opcode::JUMP_IF_FINISH_ITER:
+            return 0;
+        case Opcode::LOAD_FOLDED:
+            return 1;
+        default:
+            return std::nullopt;
+    }
+}
+
+class RegisterLowering {
+public:
+    RegisterLowering(const std::vector<Instruction>& code, const std::vector<err::PositionInfo>& code_pos,
+        const size_t locals_count, const bool locals_exposed)
+        : code(code), code_pos(code_pos), locals_count(locals_count), locals_exposed(locals_exposed),
+          is_label(code.size() + 1, false), label_depth(code.size() + 1), pc_map(code.size() + 1, 0) {}
+
+    void run(std::vector<model::ExceptionTable>* exception_tables, bool keep_result);
+
+    std::vector<Instruction> out;
+    std::vector<err::PositionInfo> out_pos;
+    size_t temp_count = 0;
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    const std::vector<Instruction>& code;
+    const std::vector<err::PositionInfo>& code_pos;
+    const size_t locals_count;
+    const bool locals_exposed;
+
+    std::vector<uint32_t> stack; // 虚拟操作数栈: 每一项的值所在的槽位或常量
+    std::vector<bool> is_label;
+    std::vector<std::optional<size_t>> label_depth; // 到达跳转目标时的栈深度
+    std::vector<size_t> pc_map; // 原pc -> 新pc, 末尾多一项对应代码结尾
+    std::vector<std::pair<size_t, size_t>> jump_fixups; // (新指令下标, 操作数下标), 操作数暂存原pc
+    bool reachable = true;
+    size_t producer = npos; // 最后一条指令把结果写到栈顶临时寄存器时的下标, 之后的SET_LOCAL可以改写它的目的槽位
+    err::PositionInfo pos {};
+
+    [[nodiscard]] uint32_t temp_reg(const size_t depth) const {
+        return static_cast<uint32_t>(locals_count + depth);
+    }
+    [[nodiscard]] bool is_local(const uint32_t opnd) const {
+        return !(opnd & const_bit) and opnd < locals_count;
+    }
+    [[nodiscard]] size_t clamp_target(const size_t target) const {
+        return std::min(target, code.size());
+    }
+
+    void emit(const Opcode opc, const std::initializer_list<size_t> opns, const Opcode sub_opc = {}, const size_t aux = 0) {
+        Instruction inst(opc, opns);
+        inst.sub_opc = sub_opc;
+        inst.aux = static_cast<uint16_t>(aux);
+        out.push_back(inst);
+        out_pos.push_back(pos);
+        producer = npos;
+    }
+    void emit_producer(const Opcode opc, const std::initializer_list<size_t> opns, const size_t aux = 0) {
+        emit(opc, opns, {}, aux);
+        producer = out.size() - 1;
+    }
+    // 跳转目标先按原pc写入, 全部翻译完再换成新pc
+    void emit_jump(const Opcode opc, const std::initializer_list<size_t> opns, const size_t target_operand,
+        const Opcode sub_opc = {}) {
+        emit(opc, opns, sub_opc);
+        jump_fixups.emplace_back(out.size() - 1, target_operand);
+    }
+
+    uint32_t pop() {
+        if (stack.empty()) throw KizStopRunningSignal("register backend: operand stack underflow");
+        const uint32_t opnd = stack.back();
+        stack.pop_back();
+        return opnd;
+    }
+    uint32_t push_temp() {
+        const uint32_t reg = temp_reg(stack.size());
+        stack.push_back(reg);
+        temp_count = std::max(temp_count, stack.size());
+        return reg;
+    }
+
+    void move_to_temp(const size_t i) {
+        const uint32_t reg = temp_reg(i);
+        temp_count = std::max(temp_count, i + 1);
+        if (stack[i] == reg) return;
+        emit(Opcode::REG_MOVE, {reg, stack[i]});
+        stack[i] = reg;
+    }
+    void materialize_from(const size_t from) {
+        for (size_t i = from; i < stack.size(); ++i) move_to_temp(i);
+    }
+    // 写局部变量之前, 先把还记着它旧值的项落到临时寄存器
+    void flush_local(const uint32_t local) {
+        for (size_t i = 0; i < stack.size(); ++i) {
+            if (stack[i] == local) move_to_temp(i);
+        }
+    }
+    // 局部变量可能在执行用户代码期间被其他帧改写时, 栈上剩下的项不能再按局部变量延后读取
+    void guard_exposed_locals() {
+        if (!locals_exposed) return;
+        for (size_t i = 0; i < stack.size(); ++i) {
+            if (is_local(stack[i])) move_to_temp(i);
+        }
+    }
+
+    void mark_labels(const std::vector<model::ExceptionTable>* exception_tables);
+    void record_target(size_t target);
+    void enter_label(size_t pc);
+    void store_local(uint32_t local, uint32_t value);
+    void lower_jump_if_false(const Instruction& inst);
+    void lower(const Instruction& inst);
+    void remap(std::vector<model::ExceptionTable>* exception_tables);
+};
+
+void RegisterLowering::mark_labels(const std::vector<model::ExceptionTable>* exception_tables) {
+    for (const auto& inst : code) {
+        if (const auto operand = jump_target_operand(inst)) {
+            is_label[clamp_target(inst.opn_list[*operand])] = true;
+        }
+    }
+    if (!exception_tables) return;
+    for (const auto& table : *exception_tables) {
+        is_label[clamp_target(table.try_part_start_pc)] = true;
+        is_label[clamp_target(table.mismatch_pc)] = true;
+        table.handle_pc.for_each([&](const size_t handler) { is_label[clamp_target(handler)] = true; });
+    }
+}
+
+void RegisterLowering::record_target(size_t target) {
+    target = clamp_target(target);
+    if (!label_depth[target]) {
+        label_depth[target] = stack.size();
+    } else if (*label_depth[target] != stack.size()) {
+        throw KizStopRunningSignal("register backend: inconsistent stack depth at jump target");
+    }
+}
+
+// 跳转目标: 顺序执行过来的一侧先把所有项落到临时寄存器(这些MOVE放在目标之前), 之后统一按临时寄存器读取
+void RegisterLowering::enter_label(const size_t pc) {
+    if (reachable) {
+        materialize_from(0);
+        record_target(pc);
+    } else {
+        const size_t depth = label_depth[pc].value_or(stack.size());
+        stack.clear();
+        for (size_t i = 0; i < depth; ++i) stack.push_back(temp_reg(i));
+        temp_count = std::max(temp_count, depth);
+    }
+    reachable = true;
+    producer = npos;
+}
+
+void RegisterLowering::store_local(const uint32_t local, const uint32_t value) {
+    // 上一条指令刚把结果写到栈顶临时寄存器: 直接改写它的目的槽位, 省掉一次MOVE
+    const bool aliased = std::ranges::find(stack, local) != stack.end();
+    if (!aliased and producer != npos and producer == out.size() - 1
+        and value == temp_reg(stack.size()) and out.back().opn_list[0] == value) {
+        out.back().opn_list[0] = local;
+        producer = npos;
+        return;
+    }
+    flush_local(local);
+    emit(Opcode::REG_MOVE, {local, value});
+}
+
+void RegisterLowering::lower_jump_if_false(const Instruction& inst) {
+    const uint32_t cond = pop();
+    const size_t target = inst.opn_list[0];
+    const bool cond_just_made = producer != npos and producer == out.size() - 1
+        and cond == temp_reg(stack.size()) and out.back().opn_list[0] == cond;
+
+    // 比较; JUMP_IF_FALSE  =>  REG_COMPARE_JUMP_IF_FALSE, 比较结果不再写入寄存器
+    if (cond_just_made and out.back().opc == Opcode::REG_BINARY and is_compare_op(out.back().sub_opc)) {
+        const Instruction cmp = out.back();
+        const err::PositionInfo cmp_pos = out_pos.back();
+        out.pop_back();
+        out_pos.pop_back();
+        materialize_from(0);
+        record_target(target);
+        const err::PositionInfo jump_pos = pos;
+        pos = cmp_pos;
+        emit_jump(Opcode::REG_COMPARE_JUMP_IF_FALSE, {cmp.opn_list[1], cmp.opn_list[2], target}, 2, cmp.sub_opc);
+        pos = jump_pos;
+        return;
+    }
+    // not; JUMP_IF_FALSE  =>  REG_JUMP_IF_TRUE
+    if (cond_just_made and out.back().opc == Opcode::REG_UNARY and out.back().sub_opc == Opcode::OP_NOT) {
+        const uint32_t operand = out.back().opn_list[1];
+        out.pop_back();
+        out_pos.pop_back();
+        materialize_from(0);
+        record_target(target);
+        emit_jump(Opcode::REG_JUMP_IF_TRUE, {operand, target}, 1);
+        return;
+    }
+    materialize_from(0);
+    record_target(target);
+    emit_jump(Opcode::REG_JUMP_IF_FALSE, {cond, target}, 1);
+}
+
+void RegisterLowering::lower(const Instruction& inst) {
+    const Opcode opc = inst.opc;
+    if (is_binary_op(opc)) {
+        const uint32_t b = pop();
+        const uint32_t a = pop();
+        guard_exposed_locals();
+        const uint32_t dst = push_temp();
+        emit(Opcode::REG_BINARY, {dst, a, b}, opc);
+        producer = out.size() - 1;
+        return;
+    }
+
+    switch (opc) {
+    case Opcode::LOAD_VAR:
+        stack.push_back(inst.opn_list[0]);
+        break;
+    case Opcode::LOAD_CONST:
+        stack.push_back(inst.opn_list[0] | const_bit);
+        break;
+    case Opcode::LOAD_BUILTINS:
+        // 内置对象在启动时注册后不再变化, 直接登记为常量
+        stack.push_back(static_cast<uint32_t>(IRGenerator::get_or_add_const(Vm::builtins[inst.opn_list[0]])) | const_bit);
+        break;
+    case Opcode::LOAD_FREE_VAR: {
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_LOAD_FREE, {dst, inst.opn_list[0]});
+        break;
+    }
+    case Opcode::LOAD_FOLDED: {
+        // 跳转的一侧多一项折叠结果, 顺序执行的一侧照常计算原表达式
+        materialize_from(0);
+        const uint32_t dst = push_temp();
+        record_target(inst.opn_list[1]);
+        stack.pop_back();
+        emit_jump(Opcode::REG_LOAD_FOLDED, {dst, inst.opn_list[0], inst.opn_list[1]}, 2);
+        break;
+    }
+    case Opcode::COPY_TOP:
+        if (stack.empty()) throw KizStopRunningSignal("register backend: operand stack underflow");
+        stack.push_back(stack.back());
+        break;
+    case Opcode::POP_TOP:
+        pop();
+        break;
+
+    case Opcode::SET_LOCAL:
+        store_local(inst.opn_list[0], pop());
+        break;
+    case Opcode::SET_GLOBAL: {
+        // 在模块中执行时写的就是自身的局部变量
+        const uint32_t value = pop();
+        flush_local(inst.opn_list[0]);
+        emit(Opcode::REG_SET_GLOBAL, {inst.opn_list[0], value});
+        break;
+    }
+    case Opcode::SET_NONLOCAL:
+        emit(Opcode::REG_SET_NONLOCAL, {inst.opn_list[0], pop()});
+        break;
+
+    case Opcode::OP_NEG: case Opcode::OP_NOT: {
+        const uint32_t operand = pop();
+        guard_exposed_locals();
+        const uint32_t dst = push_temp();
+        emit(Opcode::REG_UNARY, {dst, operand}, opc);
+        producer = out.size() - 1;
+        break;
+    }
+
+    case Opcode::CALL: case Opcode::TAIL_CALL: {
+        const uint32_t func = pop();
+        const size_t argc = inst.opn_list[0];
+        if (stack.size() < argc) throw KizStopRunningSignal("register backend: operand stack underflow");
+        const size_t base = stack.size() - argc;
+        materialize_from(base);
+        guard_exposed_locals();
+        stack.resize(base);
+        push_temp();
+        emit(opc == Opcode::CALL ? Opcode::REG_CALL : Opcode::REG_TAIL_CALL, {temp_reg(base), argc, func});
+        break;
+    }
+    case Opcode::CALL_METHOD: {
+        const size_t argc = inst.opn_list[1];
+        if (stack.size() < argc + 1) throw KizStopRunningSignal("register backend: operand stack underflow");
+        if (inst.opn_list[0] > UINT16_MAX) throw KizStopRunningSignal("register backend: too many attribute names");
+        // 参数之后紧跟调用对象
+        const size_t base = stack.size() - argc - 1;
+        materialize_from(base);
+        guard_exposed_locals();
+        stack.resize(base);
+        push_temp();
+        emit(Opcode::REG_CALL_METHOD, {temp_reg(base), argc, 0}, {}, inst.opn_list[0]);
+        break;
+    }
+    case Opcode::RET:
+        emit(Opcode::REG_RET, {pop()});
+        reachable = false;
+        break;
+    case Opcode::THROW:
+        emit(Opcode::REG_THROW, {pop()});
+        reachable = false;
+        break;
+
+    case Opcode::JUMP:
+        materialize_from(0);
+        record_target(inst.opn_list[0]);
+        emit_jump(Opcode::JUMP, {inst.opn_list[0]}, 0);
+        reachable = false;
+        break;
+    case Opcode::JUMP_IF_FALSE:
+        lower_jump_if_false(inst);
+        break;
+    case Opcode::JUMP_IF_FINISH_ITER: {
+        const uint32_t value = pop();
+        materialize_from(0);
+        record_target(inst.opn_list[0]);
+        emit_jump(Opcode::REG_JUMP_IF_FINISH_ITER, {value, inst.opn_list[0]}, 1);
+        break;
+    }
+
+    case Opcode::MAKE_LIST: case Opcode::MAKE_DICT: {
+        const size_t count = inst.opn_list[0];
+        const size_t elems = opc == Opcode::MAKE_DICT ? count * 2 : count;
+        if (stack.size() < elems) throw KizStopRunningSignal("register backend: operand stack underflow");
+        const size_t base = stack.size() - elems;
+        materialize_from(base);
+        if (opc == Opcode::MAKE_DICT) guard_exposed_locals(); // 计算键的__hash__
+        stack.resize(base);
+        const uint32_t dst = push_temp();
+        emit_producer(opc == Opcode::MAKE_LIST ? Opcode::REG_MAKE_LIST : Opcode::REG_MAKE_DICT,
+            {dst, temp_reg(base), count});
+        break;
+    }
+    case Opcode::CREATE_CLOSURE: {
+        const uint32_t fn_template = pop();
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_CLOSURE, {dst, fn_template});
+        break;
+    }
+    case Opcode::CREATE_OBJECT: {
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_CREATE_OBJECT, {dst});
+        break;
+    }
+
+    case Opcode::GET_ATTR: {
+        if (inst.opn_list[0] > UINT16_MAX) throw KizStopRunningSignal("register backend: too many attribute names");
+        const uint32_t obj = pop();
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_GET_ATTR, {dst, obj, 0}, inst.opn_list[0]);
+        break;
+    }
+    case Opcode::SET_ATTR: {
+        const uint32_t value = pop();
+        const uint32_t obj = pop();
+        emit(Opcode::REG_SET_ATTR, {obj, value, inst.opn_list[0]});
+        break;
+    }
+    case Opcode::SET_ITEM: {
+        // __setitem__的返回值直接丢弃
+        const uint32_t value = pop();
+        const uint32_t key = pop();
+        const uint32_t obj = pop();
+        guard_exposed_locals();
+        emit(Opcode::REG_SET_ITEM, {obj, key, value});
+        break;
+    }
+
+    case Opcode::IMPORT: {
+        guard_exposed_locals();
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_IMPORT, {dst, inst.opn_list[0]});
+        break;
+    }
+    case Opcode::LOAD_ERROR: {
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_LOAD_ERROR, {dst});
+        break;
+    }
+
+    // 迭代器由帧的iters持有, CACHE_ITER之后不再留在栈上
+    case Opcode::CACHE_ITER:
+        emit(Opcode::REG_CACHE_ITER, {pop()});
+        break;
+    case Opcode::GET_ITER: {
+        const uint32_t dst = push_temp();
+        emit_producer(Opcode::REG_LOAD_ITER, {dst});
+        break;
+    }
+    case Opcode::POP_ITER:
+        emit(Opcode::POP_ITER, {});
+        break;
+
+    default:
+        throw KizStopRunningSignal("register backend: unsupported opcode " + opcode_to_string(opc));
+    }
+}
+
+void RegisterLowering::remap(std::vector<model::ExceptionTable>* exception_tables) {
+    for (const auto& [idx, operand] : jump_fixups) {
+        out[idx].opn_list[operand] = static_cast<uint32_t>(pc_map[clamp_target(out[idx].opn_list[operand])]);
+    }
+    if (!exception_tables) return;
+    for (auto& table : *exception_tables) {
+        table.try_part_start_pc = pc_map[clamp_target(table.try_part_start_pc)];
+        table.try_part_end_pc = pc_map[clamp_target(table.try_part_end_pc)];
+        table.mismatch_pc = pc_map[clamp_target(table.mismatch_pc)];
+        dep::HashMap<size_t> handle_pc;
+        for (const auto& [error_name, handler] : table.handle_pc.to_vector()) {
+            handle_pc.insert(error_name, pc_map[clamp_target(handler)]);
+        }
+        table.handle_pc = handle_pc;
+    }
+}
+
+void RegisterLowering::run(std::vector<model::ExceptionTable>* exception_tables, const bool keep_result) {
+    mark_labels(exception_tables);
+    out.reserve(code.size());
+    out_pos.reserve(code.size());
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (is_label[pc]) enter_label(pc);
+        pc_map[pc] = out.size();
+        pos = code_pos[pc];
+        // try块开始时的栈深度就是进入catch块时的深度
+        if (exception_tables) {
+            for (const auto& table : *exception_tables) {
+                if (table.try_part_start_pc != pc) continue;
+                table.handle_pc.for_each([&](const size_t handler) { record_target(handler); });
+                record_target(table.mismatch_pc);
+            }
+        }
+        lower(code[pc]);
+    }
+
+    if (is_label[code.size()]) enter_label(code.size());
+    pc_map[code.size()] = out.size();
+    // 模块末尾表达式语句的结果压到栈顶, 供REPL打印
+    if (keep_result and reachable and !stack.empty()) {
+        emit(Opcode::REG_PUSH, {stack.back()});
+    }
+    remap(exception_tables);
+}
+
+} // namespace
+
+size_t IRGenerator::gen_registers(std::vector<Instruction>& code, std::vector<err::PositionInfo>& code_pos,
+    std::vector<model::ExceptionTable>* exception_tables, const size_t locals_count, const bool locals_exposed,
+    const bool keep_result) {
+    RegisterLowering lowering(code, code_pos, locals_count, locals_exposed);
+    lowering.run(exception_tables, keep_result);
+    code = std::move(lowering.out);
+    code_pos = std::move(lowering.out_pos);
+    return lowering.temp_count;
+}
+
+} // namespace kiz
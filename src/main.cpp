@@ -119,7 +119,7 @@ extern "C" void handle_sigint(int sig) {
  * @param argv 命令行参数数组（来自main函数）
  * @return void
  */
-void args_parser(const int argc, char* argv[]) {
+void args_parser(int argc, char* argv[]) {
     // 程序名称
     enable_ansi_escape();
     // 注册平台特定的信号处理函数
@@ -143,6 +143,29 @@ void args_parser(const int argc, char* argv[]) {
     }
     const char* prog_name = argv[0];
 
+    // 选项只能出现在命令/路径之前, 取出后其余参数按原规则处理
+    int opt_count = 0;
+    while (1 + opt_count < argc and std::string(argv[1 + opt_count]).starts_with("-")) {
+        const std::string opt = argv[1 + opt_count];
+        if (opt == "--peephole-stats") {
+            kiz::IRGenerator::show_peephole_stats = true;
+        } else if (opt == "-O0" or opt == "-O1") {
+            kiz::IRGenerator::opt_level = opt[2] - '0';
+        } else if (opt == "--vm=stack") {
+            kiz::Vm::engine = kiz::Vm::Engine::Stack;
+        } else if (opt == "--vm=register") {
+            kiz::Vm::engine = kiz::Vm::Engine::Register;
+        } else {
+            std::cerr << "Unknown option: " << opt << std::endl;
+            std::exit(1);
+        }
+        ++opt_count;
+    }
+    if (opt_count > 0) {
+        for (int i = 1; i + opt_count < argc; ++i) argv[i] = argv[i + opt_count];
+        argc -= opt_count;
+    }
+
     // 无参数：默认启动REPL
     if (argc == 1) {
         ui::Repl repl;
@@ -216,6 +239,9 @@ void run_file(const std::string& path) {
         kiz::Vm::set_main_module(module);
         kiz::Vm::exec_curr_code();
         kiz::Vm::handle_ensure();
+        if (kiz::IRGenerator::show_peephole_stats) {
+            kiz::IRGenerator::print_peephole_stats();
+        }
     } catch (KizStopRunningSignal& e) {
         if (std::string(e.what()).empty()) {
             std::exit(0);
@@ -273,6 +299,28 @@ the kiz cmd help
   -----------------------
   | > kiz help        |
   -----------------------
+
+- options (before the command or path)
+  --peephole-stats
+    print how many instructions were fused into superinstructions
+  like this
+  ---------------------------------------
+  | > kiz --peephole-stats demo.kiz    |
+  ---------------------------------------
+  -O0 / -O1
+    optimization level of the code generator (default -O1)
+    -O0 turns off constant folding, dead code elimination, tail calls and superinstructions
+  like this
+  ---------------------------------------
+  | > kiz -O0 demo.kiz                 |
+  ---------------------------------------
+  --vm=stack / --vm=register
+    which engine runs the code (default stack)
+    register compiles to three-address instructions on frame slots instead of the operand stack
+  like this
+  ---------------------------------------
+  | > kiz --vm=register demo.kiz       |
+  ---------------------------------------
 )";
     std::cout << text << std::endl;
 }
@@ -298,8 +346,7 @@ void start_test() {
                 std::cout << "====== recover from a error =====\n";
                 continue;
             }
-            kiz::Vm::call_stack.clear();
-            kiz::Vm::op_stack.clear();
+            kiz::Vm::reset_run_state();
             std::cout << "========================\n" << "\n";
         }
     }
@@ -0,0 +1,275 @@
+/**
+ * @file gc.hpp
+ * @brief 循环回收器: 在引用计数之上回收互相引用的垃圾(试探删除, Bacon–Rajan同步算法)
+ * 引用计数减少但没有归零的容器对象被记为候选根(见Object::del_ref); 回收时从候选根出发:
+ * 1. 标灰: 沿对象图把每条内部引用从目标的计数里试探性地减掉
+ * 2. 扫描: 减完后计数仍大于0的对象有外部引用, 把它及其可达的对象恢复为黑色(计数加回);
+ *    其余灰色对象标白, 只被环内引用的垃圾
+ * 3. 回收: 拆开白色对象的容器, 释放它们对非容器对象的引用后逐个delete
+ * 只沿属性, List元素, Dictionary键值和Function自由变量追踪; 常驻(important)对象视为
+ * 外部引用. 回收只在虚拟机的指令边界(安全点)进行
+ *
+ * 延迟引用计数(DeferredRc, Deutsch–Bobrow): op_stack上的值只是借用, 压栈出栈不改引用计数;
+ * 局部变量槽位, 属性, 容器元素和帧持有的对象仍然计数. 计数归零的对象和刚放上栈的无主对象登记到
+ * 零计数表(zct), 在安全点核对: 借用者(op_stack, 被StackRef钉住的值, 被ZctPin钉住的表前缀)
+ * 临时计入计数, 计数仍为0的对象才释放. 循环回收也在这段时间里进行, 否则只被借用的环会被当成垃圾
+ */
+
+#pragma once
+
+#include "models.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace model {
+
+class DeferredRc {
+public:
+    static constexpr size_t default_threshold = 4096;
+    // 上次核对之后新登记的对象达到该数量时, 在下一个安全点核对
+    static inline size_t threshold = default_threshold;
+
+    static bool pending() { return zct.size() >= next_check_; }
+
+    // 核对零计数表, between在借用者临时计入计数期间执行
+    template <typename F>
+    static void reconcile(F&& between) {
+        count_borrowers();
+        drain();
+        between();
+        drain();
+        uncount_borrowers();
+        // 一次核对要遍历全部借用者, 深递归时栈很长, 间隔至少与借用者数量相当才能摊平开销
+        next_check_ = zct.size() + std::max(threshold, kiz::Vm::op_stack.size() + kiz::Vm::pinned.size());
+    }
+
+private:
+    static inline size_t next_check_ = default_threshold;
+
+    template <typename F>
+    static void for_each_borrower(F&& visit) {
+        for (Object* obj : kiz::Vm::op_stack) {
+            if (obj) visit(obj);
+        }
+        for (Object* obj : kiz::Vm::pinned) {
+            if (obj) visit(obj);
+        }
+        for (size_t i = 0; i < zct_pinned; ++i) visit(zct[i]);
+    }
+
+    static void count_borrowers() {
+        for_each_borrower([](Object* obj) { obj->make_ref(); });
+    }
+
+    // 撤销临时计数: 只剩借用者的对象重新登记, 不经过del_ref以免把栈上的容器都记成循环回收的候选根
+    static void uncount_borrowers() {
+        for_each_borrower([](Object* obj) {
+            if (obj->is_important) return;
+            size_t old_ref;
+            if (Object::uses_atomic_refc()) [[unlikely]] {
+                old_ref = std::atomic_ref(obj->refc_).fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                old_ref = obj->refc_--;
+            }
+            if (old_ref == 1 and !obj->in_zct_) obj->enter_zct();
+        });
+    }
+
+    // 释放钉住部分之后计数为0的对象; 析构时计数归零的子对象追加到表尾, 在同一轮里处理
+    static void drain() {
+        for (size_t i = zct_pinned; i < zct.size(); ++i) {
+            Object* obj = zct[i];
+            obj->in_zct_ = false;
+            if (obj->get_refc_() == 0) obj->free_now();
+        }
+        zct.resize(zct_pinned);
+    }
+};
+
+class CycleCollector {
+public:
+    // 每次自动回收最多处理的候选根数, 0表示不限
+    static inline size_t budget = 10000;
+    // 为false时不再自动回收, 仍可手动调用collect
+    static inline bool enabled = true;
+
+    static inline size_t collections = 0; // 执行过的回收次数
+    static inline size_t freed_total = 0; // 累计回收的对象数
+    static inline size_t last_freed = 0;  // 最近一次回收的对象数
+
+    // 安全点: 零计数表或候选根达到阈值时核对零计数表, 后者还要做一次增量回收
+    static void on_safe_point() {
+        const bool cycles = gc_pending and enabled;
+        if (!cycles and !DeferredRc::pending()) return;
+        DeferredRc::reconcile([cycles] {
+            if (cycles) collect_cycles(budget);
+        });
+    }
+
+    // 核对零计数表并处理至多max_roots个候选根(0为全部), 返回循环回收的对象数
+    static size_t collect(const size_t max_roots) {
+        size_t freed = 0;
+        DeferredRc::reconcile([&freed, max_roots] { freed = collect_cycles(max_roots); });
+        return freed;
+    }
+
+private:
+    enum Color : uint8_t { Black = 0, Gray, White };
+
+    static size_t collect_cycles(const size_t max_roots) {
+        std::vector<Object*> roots;
+        while (!gc_candidates.empty() and (max_roots == 0 or roots.size() < max_roots)) {
+            Object* obj = gc_candidates.back();
+            gc_candidates.pop_back();
+            if (!obj) continue;
+            obj->gc_buffered_ = false;
+            roots.push_back(obj);
+        }
+
+        for (Object* root : roots) mark_gray(root);
+        for (Object* root : roots) scan(root);
+        std::vector<Object*> garbage;
+        for (Object* root : roots) collect_white(root, garbage);
+        free_garbage(garbage);
+
+        gc_pending = gc_candidates.size() >= gc_threshold;
+        ++collections;
+        last_freed = garbage.size();
+        freed_total += garbage.size();
+        return garbage.size();
+    }
+
+    static bool is_traced(const Object* obj) {
+        return obj and !obj->is_important and obj->may_form_cycle();
+    }
+
+    // 遍历obj持有引用的所有对象(不含CodeObject等不会成环的成员)
+    template <typename F>
+    static void for_each_child(Object* obj, F&& visit) {
+        for (const auto& slot : obj->attrs.slots()) {
+            if (slot.value) visit(slot.value);
+        }
+        switch (obj->get_type()) {
+            case Object::ObjectType::List:
+                for (Object* elem : as_unchecked<List>(obj)->val) {
+                    if (elem) visit(elem);
+                }
+                break;
+            case Object::ObjectType::Dictionary:
+                as_unchecked<Dictionary>(obj)->val.for_each([&](const std::pair<Object*, Object*>& kv_pair) {
+                    if (kv_pair.first) visit(kv_pair.first);
+                    if (kv_pair.second) visit(kv_pair.second);
+                });
+                break;
+            case Object::ObjectType::Function:
+                for (Object* free_var : as_unchecked<Function>(obj)->free_vars) {
+                    if (free_var) visit(free_var);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    // 以下三步都用显式栈代替递归, 避免长链表撑爆C++调用栈
+
+    static void mark_gray(Object* root) {
+        if (root->gc_color_ == Gray) return;
+        root->gc_color_ = Gray;
+        std::vector<Object*> stack {root};
+        while (!stack.empty()) {
+            Object* obj = stack.back();
+            stack.pop_back();
+            for_each_child(obj, [&](Object* child) {
+                if (!is_traced(child)) return;
+                --child->refc_;
+                if (child->gc_color_ != Gray) {
+                    child->gc_color_ = Gray;
+                    stack.push_back(child);
+                }
+            });
+        }
+    }
+
+    static void scan_black(Object* root) {
+        root->gc_color_ = Black;
+        std::vector<Object*> stack {root};
+        while (!stack.empty()) {
+            Object* obj = stack.back();
+            stack.pop_back();
+            for_each_child(obj, [&](Object* child) {
+                if (!is_traced(child)) return;
+                ++child->refc_;
+                if (child->gc_color_ != Black) {
+                    child->gc_color_ = Black;
+                    stack.push_back(child);
+                }
+            });
+        }
+    }
+
+    static void scan(Object* root) {
+        std::vector<Object*> stack {root};
+        while (!stack.empty()) {
+            Object* obj = stack.back();
+            stack.pop_back();
+            if (obj->gc_color_ != Gray) continue;
+            if (obj->refc_ > 0) {
+                scan_black(obj);
+                continue;
+            }
+            obj->gc_color_ = White;
+            for_each_child(obj, [&](Object* child) {
+                if (is_traced(child)) stack.push_back(child);
+            });
+        }
+    }
+
+    static void collect_white(Object* root, std::vector<Object*>& garbage) {
+        if (root->gc_color_ != White) return;
+        root->gc_color_ = Black;
+        std::vector<Object*> stack {root};
+        while (!stack.empty()) {
+            Object* obj = stack.back();
+            stack.pop_back();
+            // 还在缓冲区里(不在本批候选根中)的白色对象同样是垃圾, 先移出缓冲区
+            if (obj->gc_buffered_) {
+                gc_candidates[obj->gc_index_] = nullptr;
+                obj->gc_buffered_ = false;
+            }
+            garbage.push_back(obj);
+            for_each_child(obj, [&](Object* child) {
+                if (is_traced(child) and child->gc_color_ == White) {
+                    child->gc_color_ = Black;
+                    stack.push_back(child);
+                }
+            });
+        }
+    }
+
+    static void free_garbage(const std::vector<Object*>& garbage) {
+        if (garbage.empty()) return;
+        // 垃圾之间以及垃圾指向其他容器的引用已在标灰时减掉; 剩下不追踪的子对象(字符串, 整数等)
+        // 照常释放. 先拆开全部容器, 再统一delete, 析构时就不会再碰到其他垃圾对象
+        std::vector<Object*> untraced;
+        for (Object* obj : garbage) {
+            for_each_child(obj, [&](Object* child) {
+                if (!is_traced(child)) untraced.push_back(child);
+            });
+            obj->attrs.drop_slots();
+            switch (obj->get_type()) {
+                case Object::ObjectType::List: as_unchecked<List>(obj)->val.clear(); break;
+                case Object::ObjectType::Dictionary: as_unchecked<Dictionary>(obj)->val.clear(); break;
+                case Object::ObjectType::Function: as_unchecked<Function>(obj)->free_vars.clear(); break;
+                default: break;
+            }
+        }
+        // 原型可能被回收, 让内联缓存失效
+        ++attr_epoch;
+        for (Object* child : untraced) child->del_ref();
+        for (Object* obj : garbage) delete obj;
+    }
+};
+
+} // namespace model
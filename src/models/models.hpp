@@ -7,12 +7,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <format>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <ranges>
+#include <span>
 #include <utility>
 
 #include "../kiz.hpp"
@@ -21,33 +23,11 @@
 #include "../../depends/bigint.hpp"
 #include "../../depends/decimal.hpp"
 #include "../../depends/dict.hpp"
+#include "shape.hpp"
 
 
 namespace model {
 
-namespace magic_name {
-    constexpr auto add = "__add__";
-    constexpr auto sub = "__sub__";
-    constexpr auto mul = "__mul__";
-    constexpr auto div = "__div__";
-    constexpr auto pow = "__pow__";
-    constexpr auto mod = "__mod__";
-    constexpr auto eq = "__eq__";
-    constexpr auto lt = "__lt__";
-    constexpr auto gt = "__gt__";
-
-    constexpr auto parent = "__parent__";
-    constexpr auto call = "__call__";
-    constexpr auto bool_of = "__bool__";
-    constexpr auto str = "__str__";
-    constexpr auto debug_str = "__dstr__";
-    constexpr auto getitem = "__getitem__";
-    constexpr auto setitem = "__setitem__";
-    constexpr auto contains = "contains";  // contains不是魔术方法
-    constexpr auto next_item = "__next__";
-    constexpr auto hash = "__hash__";
-}
-
 // 工具函数ptr转为地址的字符串
 template <typename T>
 std::string ptr_to_string(T* m) {
@@ -76,61 +56,240 @@ struct ExceptionTable {
     size_t mismatch_pc;
 };
 
-class Object {
-    std::atomic<size_t> refc_ = 0;
-    bool is_important = false; // 重要对象不参与make_refc/del_refc
+// 位置表项: 从start_pc开始(到下一项之前)的指令共用同一个源码位置
+struct PosEntry {
+    size_t start_pc;
+    err::PositionInfo pos;
+};
+
+// 把逐条指令的位置压缩成位置表, 相邻且相同的位置合并为一项
+inline std::vector<PosEntry> make_pos_table(const std::vector<err::PositionInfo>& positions) {
+    std::vector<PosEntry> table;
+    for (size_t pc = 0; pc < positions.size(); ++pc) {
+        const auto& pos = positions[pc];
+        if (!table.empty()) {
+            const auto& last = table.back().pos;
+            if (last.lno_start == pos.lno_start and last.lno_end == pos.lno_end
+                and last.col_start == pos.col_start and last.col_end == pos.col_end) {
+                continue;
+            }
+        }
+        table.push_back({pc, pos});
+    }
+    return table;
+}
+
+class Object;
+
+// 循环回收(见gc.hpp)的候选根缓冲区: 引用计数减少但没有归零的容器对象可能只剩下环内的引用.
+// 对象被释放时把自己的槽位置空, 因此缓冲区里可能有nullptr
+inline std::vector<Object*> gc_candidates;
+// 候选根达到该数量时, 虚拟机在下一个安全点执行一次增量回收
+inline size_t gc_threshold = 10000;
+inline bool gc_pending = false;
+
+// 延迟引用计数的零计数表(见gc.hpp DeferredRc): 计数为0但可能还被操作数栈借用的对象, 在安全点核对后才释放.
+// 前zct_pinned项由ZctPin钉住, 核对时视为仍被借用
+inline std::vector<Object*> zct;
+inline size_t zct_pinned = 0;
+
+// 原生函数回调脚本期间钉住零计数表里已有的对象: 原生函数可能还以裸指针持有它们(比如上一次回调的返回值),
+// 回调里的核对只处理之后登记的对象
+class ZctPin {
+public:
+    ZctPin() : outer_(zct_pinned) { zct_pinned = zct.size(); }
+    ~ZctPin() { zct_pinned = outer_; }
+    ZctPin(const ZctPin&) = delete;
+    ZctPin& operator=(const ZctPin&) = delete;
+
+private:
+    size_t outer_;
+};
+
+// 按类型划分的有界空闲链表: 引用计数归零, 属性仍与刚构造时相同的Int/String/List不立即delete,
+// 留待下次创建同类对象时原地重置val后复用, 省去构造属性表(attrs_insert)和分配内存的开销.
+// 使用原子计数时不回收(见Object::try_recycle)
+template <typename T>
+class FreeList {
 public:
-    dep::HashMap<Object*> attrs;
+    static constexpr size_t limit = 1024;
+
+    static T* pop() {
+        if (cache_.empty()) return nullptr;
+        T* obj = cache_.back();
+        cache_.pop_back();
+        return obj;
+    }
+
+    static bool push(T* obj) {
+        if (cache_.size() >= limit) return false;
+        cache_.push_back(obj);
+        return true;
+    }
 
+    // 真正释放缓存的对象, 供两次运行之间回收内存(见Vm::reclaim_memory)
+    static void clear() {
+        for (T* obj : cache_) delete obj;
+        cache_.clear();
+    }
+
+private:
+    static inline std::vector<T*> cache_;
+};
+
+class Object {
+public:
     // 对象类型枚举
-    enum class ObjectType {
+    enum class ObjectType : uint8_t {
         Object, Nil, Bool, Int, String, Decimal,
         List, Dictionary, CodeObject, Function,
-        NativeFunction, Module, Error
+        NativeFunction, Module, Error, FileHandle
     };
 
+private:
+    // 虚拟机是单线程的, 引用计数默认是普通整数; 定义KIZ_ATOMIC_REFCOUNT时所有对象都使用原子操作.
+    // 没有运行时按对象切换: 虚拟机不会把对象交给其他线程, 嵌入方需要跨线程持有对象时应开启该选项
+    size_t refc_ = 0;
+    bool is_important = false; // 重要对象不参与make_refc/del_refc
+    bool is_proto = false; // 曾被用作__parent__, 其属性变化会影响内联缓存
+    // 类型标记存放在对象头中, 构造时由子类写入; 类型判断只需读取这一字节, 不经过虚函数和RTTI
+    const ObjectType type_ = ObjectType::Object;
+    // 循环回收的标记颜色与候选根缓冲区中的位置, 只由CycleCollector读写
+    uint8_t gc_color_ = 0;
+    bool gc_buffered_ = false;
+    bool in_zct_ = false; // 已登记在零计数表中
+    uint32_t gc_index_ = 0;
+
+    friend class CycleCollector;
+    friend class DeferredRc;
+
+    // 能通过属性/元素/自由变量引用其他对象, 从而构成环的类型
+    [[nodiscard]] bool may_form_cycle() const {
+        constexpr unsigned cyclic_types = 1u << static_cast<unsigned>(ObjectType::Object)
+            | 1u << static_cast<unsigned>(ObjectType::List)
+            | 1u << static_cast<unsigned>(ObjectType::Dictionary)
+            | 1u << static_cast<unsigned>(ObjectType::Function)
+            | 1u << static_cast<unsigned>(ObjectType::Module)
+            | 1u << static_cast<unsigned>(ObjectType::Error);
+        return cyclic_types >> static_cast<unsigned>(type_) & 1u;
+    }
+
+    // 引用计数归零时尝试放回FreeList, 定义在String之后
+    bool try_recycle();
+
+    void enter_zct() {
+        in_zct_ = true;
+        zct.push_back(this);
+    }
+
+    // 由DeferredRc在核对零计数表时调用
+    void free_now() {
+        if (!try_recycle()) delete this;
+    }
+
+    void buffer_as_gc_candidate() {
+        gc_buffered_ = true;
+        gc_index_ = static_cast<uint32_t>(gc_candidates.size());
+        gc_candidates.push_back(this);
+        if (gc_candidates.size() >= gc_threshold) gc_pending = true;
+    }
+
+public:
+    AttrTable attrs; // 形状 + 槽位数组, 见shape.hpp
+
     void mark_as_important() {
         is_important = true;
     }
 
-    // 获取实际类型的虚函数
-    [[nodiscard]] virtual ObjectType get_type() const {
-        return ObjectType::Object;
+    [[nodiscard]] ObjectType get_type() const {
+        return type_;
+    }
+
+    static constexpr bool uses_atomic_refc() {
+#ifdef KIZ_ATOMIC_REFCOUNT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 只有一个计数引用且不是常驻/原型对象, 也不使用原子计数: 持有者原地修改它不会被其他地方观察到.
+    // 操作数栈上的借用不计数, 但它们只会出现在同一帧尚未求值完的表达式里, 调用方只在语句边界原地修改局部变量
+    [[nodiscard]] bool is_exclusively_owned() const {
+        return !is_important and !is_proto and !uses_atomic_refc() and refc_ == 1;
     }
 
     [[nodiscard]] size_t get_refc_() const {
+        if (uses_atomic_refc()) {
+            return std::atomic_ref(const_cast<size_t&>(refc_)).load(std::memory_order_relaxed);
+        }
         return refc_;
     }
-    
+
     void make_ref() {
         if (is_important) return;
-        refc_.fetch_add(1, std::memory_order_relaxed);
+        if (uses_atomic_refc()) [[unlikely]] {
+            std::atomic_ref(refc_).fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ++refc_;
     }
     void del_ref() {
         if (is_important) return;
-        const size_t old_ref = refc_.fetch_sub(1, std::memory_order_acq_rel);
+        size_t old_ref;
+        if (uses_atomic_refc()) [[unlikely]] {
+            old_ref = std::atomic_ref(refc_).fetch_sub(1, std::memory_order_acq_rel);
+        } else {
+            old_ref = refc_--;
+        }
         if (old_ref == 1) {
-            // std::cout << "deling object " << this->debug_string() << std::endl;
-            delete this;
+            // 计数归零时对象可能还被操作数栈借用着, 先登记到零计数表, 等安全点核对后再释放
+            if (!in_zct_) enter_zct();
+        } else if (!gc_buffered_ and may_form_cycle()) {
+            buffer_as_gc_candidate();
         }
     }
 
-    void attrs_insert(const std::string& name, Object* o) {
+    // 操作数栈只借用对象, 压栈不增加计数. 还没有任何计数引用的对象(刚创建的返回值等)在这里登记到零计数表,
+    // 否则它离开操作数栈后就没有人释放了
+    void note_borrowed() {
+        if (!in_zct_ and !is_important and get_refc_() == 0) enter_zct();
+    }
+
+    void attrs_insert(const Symbol name, Object* o) {
         assert(o != nullptr);
         o->make_ref();
+        if (name == magic_name::parent) o->is_proto = true;
+        if (is_proto) ++attr_epoch;
         attrs.insert(name, o);
     }
 
+    void attrs_insert(const std::string_view name, Object* o) {
+        attrs_insert(Symbol::intern(name), o);
+    }
+
+    void attrs_del(const std::string_view name) {
+        if (is_proto) ++attr_epoch;
+        if (const Symbol sym = Symbol::find(name); sym.valid()) attrs.del(sym);
+    }
+
     [[nodiscard]] virtual std::string debug_string() const {
         return "<Object at " + ptr_to_string(this) + ">";
     }
 
     Object () = default;
+    explicit Object(const ObjectType type) : type_(type) {}
+
+    // 所有堆对象都从分级内存池分配(见pool.hpp); 析构函数是虚函数, delete时传入的是实际类型的大小
+    static void* operator new(const size_t size) { return ObjectPool::allocate(size); }
+    static void operator delete(void* p, const size_t size) { ObjectPool::deallocate(p, size); }
 
     virtual ~Object() {
-        auto kv_list = attrs.to_vector();
-        for (const auto& obj : kv_list | std::views::values) {
-            if (obj) obj->del_ref();
+        assert(!in_zct_); // 零计数表里的对象只由DeferredRc释放
+        if (gc_buffered_) gc_candidates[gc_index_] = nullptr;
+        if (is_proto) ++attr_epoch;
+        for (const auto& slot : attrs.slots()) {
+            if (slot.value) slot.value->del_ref();
         }
     }
 };
@@ -154,12 +313,31 @@ inline auto stop_iter_signal = new Object();
 
 class List;
 
+// GET_ATTR/CALL_METHOD的多态内联缓存, 以接收者的形状为键:
+// 属性在对象自身上时直接记住槽位, 否则记住__parent__的槽位与原型, 并缓存在原型链上的查找结果
+// 缓存槽位号由IR生成时写入指令的第3个操作数
+struct AttrCacheEntry {
+    const Shape* shape = nullptr;
+    size_t slot = 0;
+    bool own = false;
+    Object* proto = nullptr;
+    Object* value = nullptr;
+    size_t epoch = 0;
+};
+
+struct AttrCache {
+    static constexpr size_t ways = 4;
+    AttrCacheEntry entries[ways];
+    size_t next = 0; // 缓存满时轮换替换
+};
+
 class CodeObject : public Object {
 public:
     std::vector<kiz::Instruction> code;
+    std::vector<PosEntry> pos_table;
 
     std::vector<std::string> var_names;
-    std::vector<std::string> attr_names;
+    std::vector<Symbol> attr_names; // 生成IR时已登记为符号
     std::vector<std::string> free_names;
 
     std::vector<UpValue> upvalues;
@@ -167,20 +345,45 @@ public:
 
     std::vector<ExceptionTable> exception_tables;
     std::vector<kiz::Instruction> ensure_stmts;
+    std::vector<PosEntry> ensure_pos_table;
+
+    std::vector<AttrCache> attr_caches;
+
+    // 运行时按距离回溯调用栈(SET_NONLOCAL, 创建闭包)时最远越过自身帧的层数;
+    // 非0的函数不能作为尾调用的目标, 否则被复用掉的调用者帧会使回溯错位
+    size_t frame_reach = 0;
+
+    // 寄存器后端(--vm=register)生成的代码在局部变量之后使用的临时寄存器个数, 栈式代码为0
+    size_t temp_count = 0;
 
     static constexpr ObjectType TYPE = ObjectType::CodeObject;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
     explicit CodeObject(const std::vector<kiz::Instruction>& c,
+        std::vector<PosEntry> p_t,
         const std::vector<std::string>& v_n,
-        const std::vector<std::string>& a_n,
+        const std::vector<Symbol>& a_n,
         const std::vector<std::string>& f_n,
         const std::vector<UpValue>& u_v,
         const size_t l_c,
         std::vector<ExceptionTable> et,
-        std::vector<kiz::Instruction> e_s)
-            : code(c), var_names(v_n), attr_names(a_n), free_names(f_n), upvalues(u_v), locals_count(l_c),
-                 exception_tables(std::move(et)), ensure_stmts(std::move(e_s)) {}
+        std::vector<kiz::Instruction> e_s,
+        std::vector<PosEntry> e_p_t,
+        const size_t attr_cache_count)
+            : Object(TYPE), code(c), pos_table(std::move(p_t)), var_names(v_n), attr_names(a_n), free_names(f_n), upvalues(u_v),
+                locals_count(l_c), exception_tables(std::move(et)), ensure_stmts(std::move(e_s)),
+                ensure_pos_table(std::move(e_p_t)), attr_caches(attr_cache_count) {}
+
+    // 帧在操作数栈上占用的槽位数: 局部变量 + 临时寄存器
+    [[nodiscard]] size_t frame_size() const {
+        return locals_count + temp_count;
+    }
+
+    // 二分查找pc所在的位置表项
+    [[nodiscard]] err::PositionInfo pos_at(const size_t pc) const {
+        const auto it = std::ranges::upper_bound(pos_table, pc, {}, &PosEntry::start_pc);
+        if (it == pos_table.begin()) return {};
+        return std::prev(it)->pos;
+    }
 
     [[nodiscard]] std::string debug_string() const override {
         return "<CodeObject at " + ptr_to_string(this) + ">";
@@ -193,15 +396,14 @@ public:
     CodeObject* code = nullptr;
 
     static constexpr ObjectType TYPE = ObjectType::Module;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Module(std::string name, CodeObject *code) : path(std::move(name)), code(code) {
-        attrs_insert("__parent__", based_module);
+    explicit Module(std::string name, CodeObject *code) : Object(TYPE), path(std::move(name)), code(code) {
+        attrs_insert(magic_name::parent, based_module);
         code->make_ref();
     }
 
-    explicit Module(std::string name) : path(std::move(name)) {
-        attrs_insert("__parent__", based_module);
+    explicit Module(std::string name) : Object(TYPE), path(std::move(name)) {
+        attrs_insert(magic_name::parent, based_module);
     }
 
     [[nodiscard]] std::string debug_string() const override {
@@ -222,12 +424,11 @@ public:
     std::vector<Object*> free_vars;
 
     static constexpr ObjectType TYPE = ObjectType::Function;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
     explicit Function(std::string name, CodeObject *code, const size_t argc
-    ) : name(std::move(name)), code(code), argc(argc) {
+    ) : Object(TYPE), name(std::move(name)), code(code), argc(argc) {
         code->make_ref();
-        attrs_insert("__parent__", based_function);
+        attrs_insert(magic_name::parent, based_function);
     }
 
     [[nodiscard]] std::string debug_string() const override {
@@ -242,17 +443,35 @@ public:
     }
 };
 
+// 原生函数的快速调用约定: argv直接指向调用方的参数区(操作数栈), 不装箱为List,
+// 也不经过std::function的类型擦除. 内置函数/方法都使用这种约定
+using NativeFuncPtr = Object* (*)(Object* self, Object* const* argv, size_t argc);
+
 class NativeFunction : public Object {
 public:
+    // 不限定参数个数, 由函数自己检查
+    static constexpr size_t any_arity = static_cast<size_t>(-1);
+
     std::string name;
+    NativeFuncPtr fast_func = nullptr;
+    // 旧的调用约定(参数装在List里), 保留给第三方库使用
     std::function<Object*(Object*, List*)> func;
+    // 固定参数个数时, 调用前统一检查, 函数体内不必再调用assert_argc
+    size_t arity = any_arity;
 
     static constexpr ObjectType TYPE = ObjectType::NativeFunction;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit NativeFunction(std::function<Object*(Object*, List*)> func) : func(std::move(func)) {
-        attrs_insert("__parent__", based_native_function);
+    explicit NativeFunction(const NativeFuncPtr fast_func, const size_t arity = any_arity)
+        : Object(TYPE), fast_func(fast_func), arity(arity) {
+        attrs_insert(magic_name::parent, based_native_function);
     }
+
+    explicit NativeFunction(std::function<Object*(Object*, List*)> func) : Object(TYPE), func(std::move(func)) {
+        attrs_insert(magic_name::parent, based_native_function);
+    }
+
+    // argv在调用期间必须保持有效; 返回值的引用计数由调用方管理
+    Object* call(Object* self, Object* const* argv, size_t argc);
     [[nodiscard]] std::string debug_string() const override {
     return "<NativeFunction" +
            (name.empty() 
@@ -268,34 +487,59 @@ public:
     dep::BigInt val;
 
     static constexpr ObjectType TYPE = ObjectType::Int;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Int(dep::BigInt val) : val(std::move(val)) {
-        attrs_insert("__parent__", based_int);
+    explicit Int(dep::BigInt val) : Object(TYPE), val(std::move(val)) {
+        attrs_insert(magic_name::parent, based_int);
     }
-    explicit Int() : val(dep::BigInt(0)) {
-        attrs_insert("__parent__", based_int);
+    explicit Int() : Object(TYPE), val(dep::BigInt(0)) {
+        attrs_insert(magic_name::parent, based_int);
     }
     [[nodiscard]] std::string debug_string() const override {
         return val.to_string();
     }
 };
 
+// 新建Int(优先复用FreeList中的对象), 不经过小整数池
+inline Int* create_int(dep::BigInt val) {
+    if (const auto int_obj = FreeList<Int>::pop()) {
+        int_obj->val = std::move(val);
+        return int_obj;
+    }
+    return new Int(std::move(val));
+}
+
+// 获取Int对象: 小整数直接取自常驻的小整数池, 不分配也不参与引用计数, 其余才新建
+// 注意: 池中对象是共享的, 需要原地修改val的场合(如Range的游标)必须用create_int新建
+inline Int* load_int(const long long val) {
+    if (val >= kiz::Vm::small_int_min and val <= kiz::Vm::small_int_max) {
+        return kiz::Vm::small_int_pool[val - kiz::Vm::small_int_min];
+    }
+    return create_int(dep::BigInt::from_long_long(val));
+}
+
+inline Int* load_int(dep::BigInt val) {
+    long long small = 0;
+    if (val.try_to_long_long(small)
+        and small >= kiz::Vm::small_int_min and small <= kiz::Vm::small_int_max) {
+        return kiz::Vm::small_int_pool[small - kiz::Vm::small_int_min];
+    }
+    return create_int(std::move(val));
+}
+
 class List : public Object {
 public:
     std::vector<Object*> val;
 
     static constexpr ObjectType TYPE = ObjectType::List;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit List(const std::vector<Object*>& val_){
+    explicit List(const std::vector<Object*>& val_) : Object(TYPE) {
         for (auto v: val_) {
             v->make_ref();
             val.push_back(v);
         }
-        attrs_insert("__parent__", based_list);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+        attrs_insert(magic_name::parent, based_list);
+        auto zero = load_int(0);
+        attrs_insert(magic_name::current_index, zero);
     }
     [[nodiscard]] std::string debug_string() const override {
         std::string result = "[";
@@ -320,13 +564,29 @@ public:
     }
 };
 
+// 创建List, 为每个元素make_ref; 优先复用FreeList中的对象
+inline List* create_list(Object* const* elems, const size_t count) {
+    if (const auto list_obj = FreeList<List>::pop()) {
+        list_obj->val.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            elems[i]->make_ref();
+            list_obj->val.push_back(elems[i]);
+        }
+        return list_obj;
+    }
+    return new List(std::vector<Object*>(elems, elems + count));
+}
+
+inline List* create_list(const std::vector<Object*>& elems) {
+    return create_list(elems.data(), elems.size());
+}
+
 class Decimal : public Object {
 public:
     dep::Decimal val;
     static constexpr ObjectType TYPE = ObjectType::Decimal;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
-    explicit Decimal(dep::Decimal val) : val(std::move(val)) {
-        attrs_insert("__parent__", based_decimal);
+    explicit Decimal(dep::Decimal val) : Object(TYPE), val(std::move(val)) {
+        attrs_insert(magic_name::parent, based_decimal);
     }
     [[nodiscard]] std::string debug_string() const override {
         return val.to_string();
@@ -338,60 +598,108 @@ public:
     std::string val;
 
     static constexpr ObjectType TYPE = ObjectType::String;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit String(std::string val) : val(std::move(val)) {
-        attrs_insert("__parent__", based_str);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+    explicit String(std::string val) : Object(TYPE), val(std::move(val)) {
+        attrs_insert(magic_name::parent, based_str);
+        auto zero = load_int(0);
+        attrs_insert(magic_name::current_index, zero);
     }
     [[nodiscard]] std::string debug_string() const override {
         return '"'+val+'"';
     }
 };
 
+// 创建String, 优先复用FreeList中的对象
+inline String* create_str(std::string val) {
+    if (const auto str_obj = FreeList<String>::pop()) {
+        str_obj->val = std::move(val);
+        return str_obj;
+    }
+    return new String(std::move(val));
+}
+
+// 刚构造出的对象的形状: 只有__parent__, List/String还有__current_index__
+inline const Shape* fresh_shape(const bool with_index) {
+    static const Shape* parent_only = Shape::root()->add(magic_name::parent);
+    static const Shape* with_current_index = Shape::root()->add(magic_name::parent)->add(magic_name::current_index);
+    return with_index ? with_current_index : parent_only;
+}
+
+inline bool Object::try_recycle() {
+    if (uses_atomic_refc() or is_proto) return false;
+    const bool is_int = type_ == ObjectType::Int;
+    if (!is_int and type_ != ObjectType::String and type_ != ObjectType::List) return false;
+    // 被脚本增删过属性或改过__parent__的对象不复用
+    if (attrs.shape() != fresh_shape(!is_int)) return false;
+    const auto parent = attrs.value_at(0);
+    if (parent != (is_int ? based_int : type_ == ObjectType::String ? based_str : based_list)) return false;
+
+    if (gc_buffered_) {
+        gc_candidates[gc_index_] = nullptr;
+        gc_buffered_ = false;
+    }
+    switch (type_) {
+        case ObjectType::Int:
+            return FreeList<Int>::push(static_cast<Int*>(this));
+        case ObjectType::String:
+        case ObjectType::List: {
+            // 迭代游标复位为常驻的小整数0
+            auto& index_value = attrs.slot_at(1).value;
+            if (index_value) index_value->del_ref();
+            index_value = load_int(0);
+            if (type_ == ObjectType::String) return FreeList<String>::push(static_cast<String*>(this));
+            // 先释放元素再放回缓存, 保留val的容量; 元素的析构可能再次进入这里, 但碰不到本列表
+            auto* list_obj = static_cast<List*>(this);
+            for (const auto elem : list_obj->val) {
+                if (elem) elem->del_ref();
+            }
+            list_obj->val.clear();
+            return FreeList<List>::push(list_obj);
+        }
+        default:
+            return false;
+    }
+}
+
 class Dictionary : public Object {
 public:
     dep::Dict<std::pair<Object*, Object*>> val;
     static constexpr ObjectType TYPE = ObjectType::Dictionary;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Dictionary(dep::Dict<std::pair<Object*, Object*>> val_) : val(std::move(val_)) {
-        for (auto& kv_pair : val_.to_vector() | std::views::values) {
+    explicit Dictionary(dep::Dict<std::pair<Object*, Object*>> val_) : Object(TYPE), val(std::move(val_)) {
+        val.for_each([](const std::pair<Object*, Object*>& kv_pair) {
             if (kv_pair.first) kv_pair.first->make_ref();
             if (kv_pair.second) kv_pair.second->make_ref();
-        }
-        attrs_insert("__parent__", based_dict);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+        });
+        attrs_insert(magic_name::parent, based_dict);
+        auto zero = load_int(0);
+        attrs_insert(magic_name::current_index, zero);
     }
-    explicit Dictionary() {
-        attrs_insert("__parent__", based_dict);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+    explicit Dictionary() : Object(TYPE) {
+        attrs_insert(magic_name::parent, based_dict);
+        auto zero = load_int(0);
+        attrs_insert(magic_name::current_index, zero);
     }
 
     [[nodiscard]] std::string debug_string() const override {
         std::string result = "{";
-        auto kv_list = val.to_vector();
-        size_t i = 0;
-        for (auto& kv_pair : kv_list | std::views::values) {
+        const auto& entries = val.entries();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto& kv_pair = entries[i].value;
             result += kv_pair.first->debug_string() + ": " + kv_pair.second->debug_string();
-            if (i != kv_list.size() - 1) {
+            if (i != entries.size() - 1) {
                 result += ", ";
             }
-            ++i;
         }
         result += "}";
         return result;
     }
 
     ~Dictionary() override {
-        auto kv_list = val.to_vector();
-        for (auto& kv_pair : kv_list | std::views::values) {
+        val.for_each([](const std::pair<Object*, Object*>& kv_pair) {
             if (kv_pair.first) kv_pair.first->del_ref();
             if (kv_pair.second) kv_pair.second->del_ref();
-        }
+        });
     }
 };
 
@@ -400,10 +708,9 @@ public:
     bool val;
 
     static constexpr ObjectType TYPE = ObjectType::Bool;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Bool(const bool val) : val(val) {
-        attrs_insert("__parent__", based_bool);
+    explicit Bool(const bool val) : Object(TYPE), val(val) {
+        attrs_insert(magic_name::parent, based_bool);
     }
     [[nodiscard]] std::string debug_string() const override {
         return val ? "True" : "False";
@@ -414,9 +721,8 @@ class Nil : public Object {
 public:
 
     static constexpr ObjectType TYPE = ObjectType::Nil;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Nil() : Object() {}
+    explicit Nil() : Object(TYPE) {}
     [[nodiscard]] std::string debug_string() const override {
         return "Nil";
     }
@@ -426,15 +732,14 @@ class Error : public Object {
 public:
     std::vector<std::pair<std::string, err::PositionInfo>> positions;
     static constexpr ObjectType TYPE = ObjectType::Error;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Error(std::vector<std::pair<std::string, err::PositionInfo>> p) {
+    explicit Error(std::vector<std::pair<std::string, err::PositionInfo>> p) : Object(TYPE) {
         positions = std::move(p);
-        attrs_insert("__parent__", based_error);
+        attrs_insert(magic_name::parent, based_error);
     }
 
-    explicit Error() {
-        attrs_insert("__parent__", based_error);
+    explicit Error() : Object(TYPE) {
+        attrs_insert(magic_name::parent, based_error);
     }
 
     [[nodiscard]] std::string debug_string() const override {
@@ -444,10 +749,12 @@ public:
 
 class FileHandle : public Object {
 public:
+    static constexpr ObjectType TYPE = ObjectType::FileHandle;
+
     std::fstream* file_handle = nullptr;
     bool is_closed = false;
-    explicit FileHandle() {
-        attrs_insert("__parent__", based_file_handle);
+    explicit FileHandle() : Object(TYPE) {
+        attrs_insert(magic_name::parent, based_file_handle);
     }
     ~FileHandle() override {
         is_closed = true;
@@ -462,6 +769,30 @@ public:
 
 };
 
+// 按类型标记转换, 代替dynamic_cast: 类型不符(或o为空)时返回nullptr
+template <typename T>
+T* as(Object* o) {
+    return o and o->get_type() == T::TYPE ? static_cast<T*>(o) : nullptr;
+}
+
+template <typename T>
+const T* as(const Object* o) {
+    return o and o->get_type() == T::TYPE ? static_cast<const T*>(o) : nullptr;
+}
+
+// 不检查类型的转换, 只用于调用方已经确认过类型标记的地方
+template <typename T>
+T* as_unchecked(Object* o) {
+    assert(o and o->get_type() == T::TYPE);
+    return static_cast<T*>(o);
+}
+
+template <typename T>
+const T* as_unchecked(const Object* o) {
+    assert(o and o->get_type() == T::TYPE);
+    return static_cast<const T*>(o);
+}
+
 inline auto unique_nil = new Nil();
 inline auto unique_false = new Bool(false);
 inline auto unique_true = new Bool(true);
@@ -492,9 +823,40 @@ inline auto create_nfunc(const std::function<Object*(Object*, List*)>& func, con
     return o;
 }
 
+inline auto create_nfunc(const NativeFuncPtr func, const std::string& name="<unnamed>") {
+    auto o = new NativeFunction(func);
+    o->name = name;
+    return o;
+}
+
+// 固定参数个数的原生函数
+inline auto create_nfunc(const NativeFuncPtr func, const size_t arity, const std::string& name="<unnamed>") {
+    auto o = new NativeFunction(func, arity);
+    o->name = name;
+    return o;
+}
+
+inline Object* NativeFunction::call(Object* self, Object* const* argv, const size_t argc) {
+    if (arity != any_arity) kiz::Vm::assert_argc(arity, argc);
+    if (fast_func) return fast_func(self, argv, argc);
+
+    // 旧的调用约定: 只在这里把参数装进List
+    const auto args_list = create_list(argv, argc);
+    args_list->make_ref();
+    Object* return_val;
+    try {
+        return_val = func(self, args_list);
+    } catch (...) {
+        args_list->del_ref();
+        throw;
+    }
+    args_list->del_ref();
+    return return_val;
+}
+
 
 inline auto cast_to_int(Object* o) {
-    auto obj = dynamic_cast<Int*>(o);
+    auto obj = as<Int>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Int", kiz::Vm::obj_to_debug_str(o)));
@@ -502,7 +864,7 @@ inline auto cast_to_int(Object* o) {
 }
 
 inline auto cast_to_str(Object* o) {
-    auto obj = dynamic_cast<String*>(o);
+    auto obj = as<String>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Str", kiz::Vm::obj_to_debug_str(o)));
@@ -510,20 +872,21 @@ inline auto cast_to_str(Object* o) {
 }
 
 inline auto cast_to_bool(Object* o) {
-    auto obj = dynamic_cast<Bool*>(o);
+    auto obj = as<Bool>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Bool", kiz::Vm::obj_to_debug_str(o)));    return obj;
 }
 
 inline auto cast_to_list(Object* o) {
-    auto obj = dynamic_cast<List*>(o);
+    auto obj = as<List>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to List", kiz::Vm::obj_to_debug_str(o)));
     return obj;
 }
 
+// 赋值语义: List/Dictionary深复制出尚未被持有的新对象, 其余对象原样返回; 都不增加引用计数
 inline auto copy_if_mutable(Object* obj) -> Object* {
     switch (obj->get_type()) {
 
@@ -532,14 +895,14 @@ inline auto copy_if_mutable(Object* obj) -> Object* {
         for (auto val : cast_to_list(obj)->val) {
             new_val.push_back(copy_if_mutable(val));
         }
-        return new List(new_val);
+        return create_list(new_val);
     }
 
     case Object::ObjectType::Dictionary: {
         std::vector<std::pair<
             dep::BigInt, std::pair< Object*, Object* >
         >> elem_list;
-        auto dict_obj = dynamic_cast<Dictionary*>(obj);
+        auto dict_obj = as<Dictionary>(obj);
         assert(dict_obj != nullptr);
         for (auto& [_, kv_pair] : dict_obj->val.to_vector()) {
             // key是hashable value, 也就是不可变对象, 可以引用传递, 应该没有神人为可变对象重载__hash__方法的
@@ -551,10 +914,8 @@ inline auto copy_if_mutable(Object* obj) -> Object* {
         return new_dict_obj;
     }
 
-    default: {
-        obj->make_ref();
+    default:
         return obj;
-    }
 
     }
 }
@@ -0,0 +1,200 @@
+/**
+ * @file pool.hpp
+ * @brief 堆对象的分级内存池
+ * 对象与属性槽位数组按16字节分级(16~256字节), 每级从按64KB对齐的slab中切出等长的块,
+ * 释放的块挂回该级的空闲链表, 分配和释放都只是一次链表操作; 更大的请求直接交给全局operator new.
+ * trim()把完全空闲的slab还给系统, 供REPL和start_test在两次运行之间回收内存.
+ * 虚拟机是单线程的, 内存池不加锁; 定义KIZ_ATOMIC_REFCOUNT(对象可能在其他线程释放)或
+ * 关闭KIZ_OBJECT_POOL时全部使用全局operator new
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(KIZ_OBJECT_POOL) && !defined(KIZ_ATOMIC_REFCOUNT)
+#define KIZ_USE_OBJECT_POOL 1
+#endif
+
+namespace model {
+
+class ObjectPool {
+public:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t max_block_size = 256;
+    static constexpr size_t slab_size = 64 * 1024;
+
+    struct Stats {
+        size_t live_blocks = 0;  // 正在使用的块
+        size_t free_blocks = 0;  // 空闲链表中的块
+        size_t slabs = 0;        // 向系统申请的slab
+    };
+
+    static void* allocate(const size_t size) {
+#ifdef KIZ_USE_OBJECT_POOL
+        if (size <= max_block_size) {
+            SizeClass& sc = classes_[class_index(size)];
+            if (!sc.free_list) refill(sc, block_size_of(class_index(size)));
+            FreeBlock* block = sc.free_list;
+            sc.free_list = block->next;
+            --sc.free_blocks;
+            ++sc.live_blocks;
+            return block;
+        }
+#endif
+        return ::operator new(size);
+    }
+
+    static void deallocate(void* p, const size_t size) {
+        if (!p) return;
+#ifdef KIZ_USE_OBJECT_POOL
+        if (size <= max_block_size) {
+            SizeClass& sc = classes_[class_index(size)];
+            auto* block = static_cast<FreeBlock*>(p);
+            block->next = sc.free_list;
+            sc.free_list = block;
+            ++sc.free_blocks;
+            --sc.live_blocks;
+            return;
+        }
+#endif
+        ::operator delete(p);
+    }
+
+    // 释放所有块都空闲的slab, 返回释放的slab数
+    static size_t trim() {
+        size_t released = 0;
+#ifdef KIZ_USE_OBJECT_POOL
+        for (size_t idx = 0; idx < class_count; ++idx) {
+            SizeClass& sc = classes_[idx];
+            if (!sc.slabs or sc.free_blocks == 0) continue;
+            const size_t per_slab = blocks_per_slab(block_size_of(idx));
+
+            for (Slab* slab = sc.slabs; slab; slab = slab->next) slab->free_count = 0;
+            for (FreeBlock* block = sc.free_list; block; block = block->next) ++slab_of(block)->free_count;
+
+            // 重建空闲链表, 跳过将被释放的slab中的块
+            FreeBlock* kept = nullptr;
+            size_t kept_count = 0;
+            for (FreeBlock* block = sc.free_list; block;) {
+                FreeBlock* next = block->next;
+                if (slab_of(block)->free_count != per_slab) {
+                    block->next = kept;
+                    kept = block;
+                    ++kept_count;
+                }
+                block = next;
+            }
+            sc.free_list = kept;
+            sc.free_blocks = kept_count;
+
+            Slab** link = &sc.slabs;
+            while (*link) {
+                Slab* slab = *link;
+                if (slab->free_count == per_slab) {
+                    *link = slab->next;
+                    ::operator delete(slab, std::align_val_t(slab_size));
+                    --sc.slab_count;
+                    ++released;
+                } else {
+                    link = &slab->next;
+                }
+            }
+        }
+#endif
+        return released;
+    }
+
+    [[nodiscard]] static Stats stats() {
+        Stats result;
+        for (const SizeClass& sc : classes_) {
+            result.live_blocks += sc.live_blocks;
+            result.free_blocks += sc.free_blocks;
+            result.slabs += sc.slab_count;
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t class_count = max_block_size / granularity;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // 位于每个slab开头, 块从slab_header_size之后开始
+    struct Slab {
+        Slab* next;
+        size_t free_count; // 只在trim时使用
+    };
+    static constexpr size_t slab_header_size = (sizeof(Slab) + granularity - 1) / granularity * granularity;
+
+    struct SizeClass {
+        FreeBlock* free_list;
+        Slab* slabs;
+        size_t free_blocks;
+        size_t live_blocks;
+        size_t slab_count;
+    };
+
+    // 零初始化, 不依赖静态初始化顺序(内置对象在静态初始化阶段就会分配)
+    static inline SizeClass classes_[class_count] {};
+
+    static constexpr size_t class_index(const size_t size) {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    static constexpr size_t block_size_of(const size_t idx) {
+        return (idx + 1) * granularity;
+    }
+
+    static constexpr size_t blocks_per_slab(const size_t block_size) {
+        return (slab_size - slab_header_size) / block_size;
+    }
+
+    static Slab* slab_of(void* block) {
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~(uintptr_t{slab_size} - 1));
+    }
+
+    static void refill(SizeClass& sc, const size_t block_size) {
+        auto* slab = static_cast<Slab*>(::operator new(slab_size, std::align_val_t(slab_size)));
+        slab->next = sc.slabs;
+        slab->free_count = 0;
+        sc.slabs = slab;
+        ++sc.slab_count;
+
+        // 倒序挂入空闲链表, 分配时按地址递增取用
+        char* base = reinterpret_cast<char*>(slab) + slab_header_size;
+        const size_t count = blocks_per_slab(block_size);
+        for (size_t i = count; i > 0; --i) {
+            auto* block = reinterpret_cast<FreeBlock*>(base + (i - 1) * block_size);
+            block->next = sc.free_list;
+            sc.free_list = block;
+        }
+        sc.free_blocks += count;
+    }
+};
+
+// 让容器(属性槽位数组等)也从内存池分配
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(const size_t n) {
+        return static_cast<T*>(ObjectPool::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, const size_t n) noexcept {
+        ObjectPool::deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+};
+
+} // namespace model
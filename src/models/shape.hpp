@@ -0,0 +1,245 @@
+/**
+ * @file shape.hpp
+ * @brief 对象属性布局(隐藏类/Shape)
+ * 属性插入顺序相同的对象共享同一个Shape(转移树上的同一节点),
+ * 属性值按槽位存放在对象自身的扁平数组(AttrTable)中. 属性名以Symbol(见symbol.hpp)存放, 查找只比较整数
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pool.hpp"
+#include "symbol.hpp"
+
+namespace model {
+
+class Object;
+
+// 属性表版本号: 原型的属性被增删改, 原型被销毁或字典形状被删改/销毁时递增,
+// 用于让GET_ATTR/CALL_METHOD的内联缓存失效
+inline size_t attr_epoch = 1;
+
+class Shape {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    // 属性数超过该值的对象改用独占的字典形状, 避免转移树上每个节点都复制一份长键表
+    static constexpr size_t max_shared_slots = 32;
+    // 属性数不超过该值时线性比较键, 否则建立哈希索引
+    static constexpr size_t linear_lookup_limit = 8;
+
+    // 空形状, 所有对象的起点
+    static Shape* root() {
+        static auto* root_shape = new Shape();
+        return root_shape;
+    }
+
+    [[nodiscard]] size_t lookup(const Symbol name) const {
+        if (index_.empty()) {
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                if (keys_[i] == name) return i;
+            }
+            return npos;
+        }
+        const auto it = index_.find(name.id());
+        return it == index_.end() ? npos : it->second;
+    }
+
+    // 未登记过的名字不可能是任何对象的属性
+    [[nodiscard]] size_t lookup(const std::string_view name) const {
+        const Symbol sym = Symbol::find(name);
+        return sym.valid() ? lookup(sym) : npos;
+    }
+
+    // __parent__所在槽位, 几乎每次属性查找都要用到, 创建形状时预先算好
+    [[nodiscard]] size_t parent_slot() const { return parent_slot_; }
+    [[nodiscard]] size_t size() const { return keys_.size(); }
+    [[nodiscard]] const std::string& key_at(const size_t slot) const { return keys_[slot].str(); }
+    [[nodiscard]] bool is_dictionary() const { return dictionary_; }
+
+    // 共享形状: 返回加上name后的子形状(同一个键总是得到同一个子形状);
+    // 字典形状: 原地追加并返回自身
+    Shape* add(const Symbol name) {
+        if (dictionary_) {
+            append_key(name);
+            return this;
+        }
+        for (Shape* child : transitions_) {
+            if (child->keys_.back() == name) return child;
+        }
+        auto* child = new Shape();
+        child->keys_ = keys_;
+        child->index_ = index_;
+        child->parent_slot_ = parent_slot_;
+        child->append_key(name);
+        transitions_.push_back(child);
+        return child;
+    }
+
+    // 复制出一个对象独占的字典形状(不进入转移树, 由AttrTable负责释放)
+    [[nodiscard]] Shape* to_dictionary() const {
+        auto* dict_shape = new Shape();
+        dict_shape->dictionary_ = true;
+        dict_shape->keys_ = keys_;
+        dict_shape->index_ = index_;
+        dict_shape->parent_slot_ = parent_slot_;
+        return dict_shape;
+    }
+
+    // 仅用于字典形状: 删除槽位并重建索引, 之后的槽位依次前移
+    void remove_slot(const size_t slot) {
+        keys_.erase(keys_.begin() + static_cast<std::ptrdiff_t>(slot));
+        index_.clear();
+        parent_slot_ = npos;
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            if (keys_[i] == magic_name::parent) parent_slot_ = i;
+            if (keys_.size() > linear_lookup_limit) index_.emplace(keys_[i].id(), i);
+        }
+    }
+
+private:
+    Shape() = default;
+
+    void append_key(const Symbol name) {
+        const size_t slot = keys_.size();
+        keys_.push_back(name);
+        if (name == magic_name::parent) parent_slot_ = slot;
+        if (keys_.size() > linear_lookup_limit) {
+            if (index_.empty()) {
+                for (size_t i = 0; i < keys_.size(); ++i) index_.emplace(keys_[i].id(), i);
+            } else {
+                index_.emplace(name.id(), slot);
+            }
+        }
+    }
+
+    std::vector<Symbol> keys_; // 按槽位排列的属性名
+    std::unordered_map<uint32_t, size_t> index_;
+    std::vector<Shape*> transitions_;
+    size_t parent_slot_ = npos;
+    bool dictionary_ = false;
+};
+
+// 对象的属性表: 形状指针 + 槽位数组
+class AttrTable {
+public:
+    struct Slot {
+        Object* value;
+    };
+    // 槽位数组通常只有一两个元素, 从内存池分配
+    using SlotVector = std::vector<Slot, PoolAllocator<Slot>>;
+
+    AttrTable() : shape_(Shape::root()) {}
+    AttrTable(const AttrTable&) = delete;
+    AttrTable& operator=(const AttrTable&) = delete;
+
+    ~AttrTable() {
+        if (shape_->is_dictionary()) {
+            ++attr_epoch;
+            delete shape_;
+        }
+    }
+
+    [[nodiscard]] Slot* find(const Symbol name) {
+        const size_t slot = shape_->lookup(name);
+        return slot == Shape::npos ? nullptr : &slots_[slot];
+    }
+
+    [[nodiscard]] const Slot* find(const Symbol name) const {
+        const size_t slot = shape_->lookup(name);
+        return slot == Shape::npos ? nullptr : &slots_[slot];
+    }
+
+    [[nodiscard]] Slot* find(const std::string_view name) {
+        const size_t slot = shape_->lookup(name);
+        return slot == Shape::npos ? nullptr : &slots_[slot];
+    }
+
+    [[nodiscard]] const Slot* find(const std::string_view name) const {
+        const size_t slot = shape_->lookup(name);
+        return slot == Shape::npos ? nullptr : &slots_[slot];
+    }
+
+    [[nodiscard]] Slot* find_parent() {
+        const size_t slot = shape_->parent_slot();
+        return slot == Shape::npos ? nullptr : &slots_[slot];
+    }
+
+    // 插入/更新属性(存在则更新, 不存在则追加槽位)
+    void insert(const Symbol name, Object* value) {
+        if (const size_t slot = shape_->lookup(name); slot != Shape::npos) {
+            slots_[slot].value = value;
+            return;
+        }
+        if (shape_->is_dictionary()) {
+            // 字典形状原地追加, 形状指针不变, 只能靠版本号让缓存失效
+            ++attr_epoch;
+        } else if (shape_->size() >= Shape::max_shared_slots) {
+            shape_ = shape_->to_dictionary();
+        }
+        shape_ = shape_->add(name);
+        slots_.push_back({value});
+    }
+
+    bool del(const Symbol name) {
+        const size_t slot = shape_->lookup(name);
+        if (slot == Shape::npos) return false;
+        if (!shape_->is_dictionary()) {
+            shape_ = shape_->to_dictionary();
+        }
+        // 字典形状原地改变了布局
+        ++attr_epoch;
+        shape_->remove_slot(slot);
+        slots_.erase(slots_.begin() + static_cast<std::ptrdiff_t>(slot));
+        return true;
+    }
+
+    // 清空全部属性但不释放属性值的引用, 只供循环回收器拆开垃圾环时使用
+    void drop_slots() {
+        if (shape_->is_dictionary()) {
+            ++attr_epoch;
+            delete shape_;
+        }
+        shape_ = Shape::root();
+        slots_.clear();
+    }
+
+    [[nodiscard]] const Shape* shape() const { return shape_; }
+    [[nodiscard]] size_t size() const { return slots_.size(); }
+    [[nodiscard]] Object* value_at(const size_t slot) const { return slots_[slot].value; }
+    [[nodiscard]] Slot& slot_at(const size_t slot) { return slots_[slot]; }
+    [[nodiscard]] const SlotVector& slots() const { return slots_; }
+
+    // 转换为键值对vector(按插入顺序)
+    [[nodiscard]] std::vector<std::pair<std::string, Object*>> to_vector() const {
+        std::vector<std::pair<std::string, Object*>> vec;
+        vec.reserve(slots_.size());
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            vec.emplace_back(shape_->key_at(i), slots_[i].value);
+        }
+        return vec;
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        std::stringstream ss;
+        ss << "{ ";
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            ss << shape_->key_at(i) << ": " << static_cast<void*>(slots_[i].value);
+            if (i + 1 < slots_.size()) ss << ", ";
+        }
+        ss << " }";
+        return ss.str();
+    }
+
+private:
+    Shape* shape_;
+    SlotVector slots_;
+};
+
+} // namespace model
@@ -0,0 +1,126 @@
+/**
+ * @file symbol.hpp
+ * @brief 属性名的驻留符号表
+ * 同一个名字只登记一次, 得到一个整数编号(Symbol). 形状(Shape)按Symbol存放属性名,
+ * 查找属性只需比较整数, 不必对字符串求哈希或逐字符比较.
+ * 生成IR时属性名就被登记为Symbol(见CodeObject::attr_names); magic_name中的内置名字
+ * 有固定编号, 可以在编译期直接使用, 不依赖静态初始化顺序.
+ * 虚拟机是单线程的, 符号表不加锁
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "../../depends/hashmap.hpp"
+
+namespace model {
+
+class Symbol {
+public:
+    constexpr Symbol() = default;
+    constexpr explicit Symbol(const uint32_t id) : id_(id) {}
+
+    // 登记name(已登记过则返回原有编号)
+    static Symbol intern(std::string_view name);
+    // 只查找不登记: name从未登记过时返回无效符号, 说明没有任何对象有这个属性
+    static Symbol find(std::string_view name);
+
+    [[nodiscard]] constexpr uint32_t id() const { return id_; }
+    [[nodiscard]] constexpr bool valid() const { return id_ != invalid_id; }
+    [[nodiscard]] const std::string& str() const;
+
+    constexpr bool operator==(const Symbol&) const = default;
+
+private:
+    static constexpr uint32_t invalid_id = UINT32_MAX;
+    uint32_t id_ = invalid_id;
+};
+
+namespace magic_name {
+    // 以下魔术方法只在原型链上查找(见Vm::call_method), 编号连续排在最前面
+    constexpr Symbol add {0};
+    constexpr Symbol sub {1};
+    constexpr Symbol mul {2};
+    constexpr Symbol div {3};
+    constexpr Symbol pow {4};
+    constexpr Symbol mod {5};
+    constexpr Symbol neg {6};
+    constexpr Symbol eq {7};
+    constexpr Symbol gt {8};
+    constexpr Symbol lt {9};
+    constexpr Symbol str {10};
+    constexpr Symbol debug_str {11};
+    constexpr Symbol bool_of {12};
+    constexpr Symbol getitem {13};
+    constexpr Symbol setitem {14};
+    constexpr Symbol contains {15};  // contains不是魔术方法
+    constexpr Symbol next_item {16};
+    constexpr Symbol hash {17};
+    constexpr uint32_t magic_method_count = 18;
+
+    constexpr Symbol parent {18};
+    constexpr Symbol call {19};
+    constexpr Symbol current_index {20};
+    constexpr Symbol name {21};
+    constexpr Symbol msg {22};
+
+    // 按编号排列, 符号表创建时依次登记
+    constexpr std::string_view builtin_names[] = {
+        "__add__", "__sub__", "__mul__", "__div__", "__pow__", "__mod__", "__neg__",
+        "__eq__", "__gt__", "__lt__", "__str__", "__dstr__", "__bool__",
+        "__getitem__", "__setitem__", "contains", "__next__", "__hash__",
+        "__parent__", "__call__", "__current_index__", "__name__", "__msg__",
+    };
+
+    constexpr bool is_magic_method(const Symbol sym) {
+        return sym.id() < magic_method_count;
+    }
+}
+
+namespace symbol_detail {
+
+struct SymbolTable {
+    std::deque<std::string> names; // 编号 -> 名字, deque追加时不移动已有元素
+    dep::HashMap<uint32_t> ids;
+
+    SymbolTable() {
+        for (const auto name : magic_name::builtin_names) add(name);
+    }
+
+    uint32_t add(const std::string_view name) {
+        const auto id = static_cast<uint32_t>(names.size());
+        names.emplace_back(name);
+        ids.insert(name, id);
+        return id;
+    }
+};
+
+// 第一次使用时创建, 内置对象在静态初始化阶段就会登记属性名
+inline SymbolTable& table() {
+    static SymbolTable symbol_table;
+    return symbol_table;
+}
+
+} // namespace symbol_detail
+
+inline Symbol Symbol::intern(const std::string_view name) {
+    auto& table = symbol_detail::table();
+    if (const auto it = table.ids.find(name)) return Symbol(it->value);
+    return Symbol(table.add(name));
+}
+
+inline Symbol Symbol::find(const std::string_view name) {
+    const auto it = symbol_detail::table().ids.find(name);
+    return it ? Symbol(it->value) : Symbol();
+}
+
+inline const std::string& Symbol::str() const {
+    return symbol_detail::table().names[id_];
+}
+
+} // namespace model
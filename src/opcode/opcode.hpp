@@ -31,8 +31,32 @@ enum class Opcode : uint8_t {
     LOAD_ERROR,
     CACHE_ITER, GET_ITER, POP_ITER, JUMP_IF_FINISH_ITER,
 
-    IS_CHILD, CREATE_OBJECT, COPY_TOP,
-    STOP, LOAD_FREE_VAR, LOAD_BUILTINS
+    IS_CHILD, CREATE_OBJECT, COPY_TOP, POP_TOP,
+    STOP, LOAD_FREE_VAR, LOAD_BUILTINS,
+
+    // 超级指令: 由窥孔优化(peephole.cpp)原地改写序列的第一条指令得到, 序列其余指令保留不动
+    LOAD_VAR_LOAD_VAR, LOAD_VAR_LOAD_CONST,
+    BINARY_VAR_VAR, BINARY_VAR_CONST, INC_LOCAL,
+    COMPARE_JUMP_IF_FALSE, JUMP_IF_FALSE_KEEP, JUMP_IF_TRUE_KEEP,
+    SET_LOCAL_JUMP_IF_FINISH_ITER,
+
+    // 加载常量折叠的结果并跳过其后保留的原指令(见optimize.cpp)
+    LOAD_FOLDED,
+
+    // 尾调用: return f(...)复用当前帧, 其后保留的RET只在退化为普通调用时执行
+    TAIL_CALL,
+
+    // 寄存器指令(--vm=register, 由reg_gen.cpp生成): 操作数是帧内槽位(局部变量之后是临时寄存器),
+    // 源操作数带Instruction::const_operand_bit时是常量池下标; 目的槽位写在第一个操作数
+    REG_MOVE, REG_LOAD_FREE, REG_LOAD_FOLDED, REG_LOAD_ITER, REG_LOAD_ERROR,
+    REG_BINARY, REG_UNARY,
+    REG_COMPARE_JUMP_IF_FALSE, REG_JUMP_IF_FALSE, REG_JUMP_IF_TRUE, REG_JUMP_IF_FINISH_ITER,
+    REG_CACHE_ITER,
+    REG_CALL, REG_TAIL_CALL, REG_CALL_METHOD, REG_RET,
+    REG_GET_ATTR, REG_SET_ATTR, REG_SET_ITEM,
+    REG_MAKE_LIST, REG_MAKE_DICT, REG_CLOSURE, REG_CREATE_OBJECT, REG_IMPORT, REG_THROW,
+    REG_SET_GLOBAL, REG_SET_NONLOCAL,
+    REG_PUSH
 };
 
 inline std::string opcode_to_string(Opcode opc) {
@@ -100,6 +124,52 @@ inline std::string opcode_to_string(Opcode opc) {
     case Opcode::CREATE_OBJECT: return "CREATE_OBJECT";
     case Opcode::STOP:        return "STOP";
     case Opcode::COPY_TOP:    return "COPY_TOP";
+    case Opcode::POP_TOP:     return "POP_TOP";
+
+    // 超级指令
+    case Opcode::LOAD_VAR_LOAD_VAR: return "LOAD_VAR_LOAD_VAR";
+    case Opcode::LOAD_VAR_LOAD_CONST: return "LOAD_VAR_LOAD_CONST";
+    case Opcode::BINARY_VAR_VAR: return "BINARY_VAR_VAR";
+    case Opcode::BINARY_VAR_CONST: return "BINARY_VAR_CONST";
+    case Opcode::INC_LOCAL: return "INC_LOCAL";
+    case Opcode::COMPARE_JUMP_IF_FALSE: return "COMPARE_JUMP_IF_FALSE";
+    case Opcode::JUMP_IF_FALSE_KEEP: return "JUMP_IF_FALSE_KEEP";
+    case Opcode::JUMP_IF_TRUE_KEEP: return "JUMP_IF_TRUE_KEEP";
+    case Opcode::SET_LOCAL_JUMP_IF_FINISH_ITER: return "SET_LOCAL_JUMP_IF_FINISH_ITER";
+
+
+    case Opcode::LOAD_FOLDED: return "LOAD_FOLDED";
+    case Opcode::TAIL_CALL:   return "TAIL_CALL";
+
+    // 寄存器指令
+    case Opcode::REG_MOVE: return "REG_MOVE";
+    case Opcode::REG_LOAD_FREE: return "REG_LOAD_FREE";
+    case Opcode::REG_LOAD_FOLDED: return "REG_LOAD_FOLDED";
+    case Opcode::REG_LOAD_ITER: return "REG_LOAD_ITER";
+    case Opcode::REG_LOAD_ERROR: return "REG_LOAD_ERROR";
+    case Opcode::REG_BINARY: return "REG_BINARY";
+    case Opcode::REG_UNARY: return "REG_UNARY";
+    case Opcode::REG_COMPARE_JUMP_IF_FALSE: return "REG_COMPARE_JUMP_IF_FALSE";
+    case Opcode::REG_JUMP_IF_FALSE: return "REG_JUMP_IF_FALSE";
+    case Opcode::REG_JUMP_IF_TRUE: return "REG_JUMP_IF_TRUE";
+    case Opcode::REG_JUMP_IF_FINISH_ITER: return "REG_JUMP_IF_FINISH_ITER";
+    case Opcode::REG_CACHE_ITER: return "REG_CACHE_ITER";
+    case Opcode::REG_CALL: return "REG_CALL";
+    case Opcode::REG_TAIL_CALL: return "REG_TAIL_CALL";
+    case Opcode::REG_CALL_METHOD: return "REG_CALL_METHOD";
+    case Opcode::REG_RET: return "REG_RET";
+    case Opcode::REG_GET_ATTR: return "REG_GET_ATTR";
+    case Opcode::REG_SET_ATTR: return "REG_SET_ATTR";
+    case Opcode::REG_SET_ITEM: return "REG_SET_ITEM";
+    case Opcode::REG_MAKE_LIST: return "REG_MAKE_LIST";
+    case Opcode::REG_MAKE_DICT: return "REG_MAKE_DICT";
+    case Opcode::REG_CLOSURE: return "REG_CLOSURE";
+    case Opcode::REG_CREATE_OBJECT: return "REG_CREATE_OBJECT";
+    case Opcode::REG_IMPORT: return "REG_IMPORT";
+    case Opcode::REG_THROW: return "REG_THROW";
+    case Opcode::REG_SET_GLOBAL: return "REG_SET_GLOBAL";
+    case Opcode::REG_SET_NONLOCAL: return "REG_SET_NONLOCAL";
+    case Opcode::REG_PUSH: return "REG_PUSH";
 
     // 兜底
     default:                  return "UNKNOWN_OPCODE(" + std::to_string(static_cast<int>(opc)) + ")";
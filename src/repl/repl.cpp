@@ -51,6 +51,8 @@ void Repl::loop() {
                 cmd_history_.push_back(line);
             }
             eval_and_print(code, old_size + 1);
+            // 每条输入执行完毕后回收这次运行产生的环和空闲内存
+            kiz::Vm::reclaim_memory();
         } catch (KizStopRunningSignal& e) {
             if (std::string(e.what()).empty()) {
                 continue;
@@ -98,7 +100,7 @@ void Repl::eval_and_print(const std::string& cmd, const size_t startline) {
     }
     auto stack_top = kiz::Vm::op_stack.back();
     if (stack_top) {
-        if (!dynamic_cast<model::Nil*>(stack_top) and should_print) {
+        if (!model::as<model::Nil>(stack_top) and should_print) {
             std::cout << kiz::Vm::obj_to_debug_str(stack_top) << std::endl;
         }
     }
@@ -32,75 +32,75 @@ void Vm::entry_builtins() {
     model::based_based_obj->attrs_insert("__setitem__", model::create_nfunc(model::object_setitem));
 
     // Bool 类型魔法方法
-    model::based_bool->attrs_insert("__eq__", model::create_nfunc(model::bool_eq));
+    model::based_bool->attrs_insert("__eq__", model::create_nfunc(model::bool_eq, 1));
     model::based_bool->attrs_insert("__call__", model::create_nfunc(model::bool_call));
     model::based_bool->attrs_insert("__hash__", model::create_nfunc(model::bool_hash));
     model::based_bool->attrs_insert("__str__", model::create_nfunc(model::bool_str));
 
     // Nil 类型魔法方法
-    model::unique_nil->attrs_insert("__eq__", model::create_nfunc(model::nil_eq));
+    model::unique_nil->attrs_insert("__eq__", model::create_nfunc(model::nil_eq, 1));
     model::unique_nil->attrs_insert("__hash__", model::create_nfunc(model::nil_hash));
     model::unique_nil->attrs_insert("__str__", model::create_nfunc(model::nil_str));
 
     // Int 类型魔法方法
-    model::based_int->attrs_insert("__add__", model::create_nfunc(model::int_add));
-    model::based_int->attrs_insert("__sub__", model::create_nfunc(model::int_sub));
-    model::based_int->attrs_insert("__mul__", model::create_nfunc(model::int_mul));
-    model::based_int->attrs_insert("__div__", model::create_nfunc(model::int_div));
-    model::based_int->attrs_insert("__mod__", model::create_nfunc(model::int_mod));
-    model::based_int->attrs_insert("__pow__", model::create_nfunc(model::int_pow));
+    model::based_int->attrs_insert("__add__", model::create_nfunc(model::int_add, 1));
+    model::based_int->attrs_insert("__sub__", model::create_nfunc(model::int_sub, 1));
+    model::based_int->attrs_insert("__mul__", model::create_nfunc(model::int_mul, 1));
+    model::based_int->attrs_insert("__div__", model::create_nfunc(model::int_div, 1));
+    model::based_int->attrs_insert("__mod__", model::create_nfunc(model::int_mod, 1));
+    model::based_int->attrs_insert("__pow__", model::create_nfunc(model::int_pow, 1));
     model::based_int->attrs_insert("__neg__", model::create_nfunc(model::int_neg));
-    model::based_int->attrs_insert("__gt__", model::create_nfunc(model::int_gt));
-    model::based_int->attrs_insert("__lt__", model::create_nfunc(model::int_lt));
-    model::based_int->attrs_insert("__eq__", model::create_nfunc(model::int_eq));
+    model::based_int->attrs_insert("__gt__", model::create_nfunc(model::int_gt, 1));
+    model::based_int->attrs_insert("__lt__", model::create_nfunc(model::int_lt, 1));
+    model::based_int->attrs_insert("__eq__", model::create_nfunc(model::int_eq, 1));
     model::based_int->attrs_insert("__call__", model::create_nfunc(model::int_call));
     model::based_int->attrs_insert("__bool__", model::create_nfunc(model::int_bool));
     model::based_int->attrs_insert("__hash__", model::create_nfunc(model::int_hash));
     model::based_int->attrs_insert("__str__", model::create_nfunc(model::int_str));
 
     // Decimal类型魔术方法
-    model::based_decimal->attrs_insert("__add__", model::create_nfunc(model::decimal_add));
-    model::based_decimal->attrs_insert("__sub__", model::create_nfunc(model::decimal_sub));
-    model::based_decimal->attrs_insert("__mul__", model::create_nfunc(model::decimal_mul));
-    model::based_decimal->attrs_insert("__div__", model::create_nfunc(model::decimal_div));
-    model::based_decimal->attrs_insert("__pow__", model::create_nfunc(model::decimal_pow));
+    model::based_decimal->attrs_insert("__add__", model::create_nfunc(model::decimal_add, 1));
+    model::based_decimal->attrs_insert("__sub__", model::create_nfunc(model::decimal_sub, 1));
+    model::based_decimal->attrs_insert("__mul__", model::create_nfunc(model::decimal_mul, 1));
+    model::based_decimal->attrs_insert("__div__", model::create_nfunc(model::decimal_div, 1));
+    model::based_decimal->attrs_insert("__pow__", model::create_nfunc(model::decimal_pow, 1));
     model::based_decimal->attrs_insert("__neg__", model::create_nfunc(model::decimal_neg));
-    model::based_decimal->attrs_insert("__gt__", model::create_nfunc(model::decimal_gt));
-    model::based_decimal->attrs_insert("__lt__", model::create_nfunc(model::decimal_lt));
-    model::based_decimal->attrs_insert("__eq__", model::create_nfunc(model::decimal_eq));
+    model::based_decimal->attrs_insert("__gt__", model::create_nfunc(model::decimal_gt, 1));
+    model::based_decimal->attrs_insert("__lt__", model::create_nfunc(model::decimal_lt, 1));
+    model::based_decimal->attrs_insert("__eq__", model::create_nfunc(model::decimal_eq, 1));
     model::based_decimal->attrs_insert("__call__", model::create_nfunc(model::decimal_call));
     model::based_decimal->attrs_insert("__bool__", model::create_nfunc(model::decimal_bool));
     model::based_decimal->attrs_insert("__hash__", model::create_nfunc(model::decimal_hash));
     model::based_decimal->attrs_insert("__str__", model::create_nfunc(model::decimal_str));
-    model::based_decimal->attrs_insert("limit_div", model::create_nfunc(model::decimal_limit_div));
-    model::based_decimal->attrs_insert("round_div", model::create_nfunc(model::decimal_round_div));
-    model::based_decimal->attrs_insert("approx", model::create_nfunc(model::decimal_approx));
+    model::based_decimal->attrs_insert("limit_div", model::create_nfunc(model::decimal_limit_div, 2));
+    model::based_decimal->attrs_insert("round_div", model::create_nfunc(model::decimal_round_div, 2));
+    model::based_decimal->attrs_insert("approx", model::create_nfunc(model::decimal_approx, 2));
 
     // Dictionary 类型魔法方法
-    model::based_dict->attrs_insert("__add__", model::create_nfunc(model::dict_add));
-    model::based_dict->attrs_insert("__contains__", model::create_nfunc(model::dict_contains));
+    model::based_dict->attrs_insert("__add__", model::create_nfunc(model::dict_add, 1));
+    model::based_dict->attrs_insert("__contains__", model::create_nfunc(model::dict_contains, 1));
     model::based_dict->attrs_insert("__getitem__", model::create_nfunc(model::dict_getitem));
     model::based_dict->attrs_insert("__str__", model::create_nfunc(model::dict_str));
     model::based_dict->attrs_insert("__dstr__", model::create_nfunc(model::dict_dstr));
-    model::based_dict->attrs_insert("__setitem__", model::create_nfunc(model::dict_setitem));
+    model::based_dict->attrs_insert("__setitem__", model::create_nfunc(model::dict_setitem, 2));
     model::based_dict->attrs_insert("__next__", model::create_nfunc(model::dict_next));
     model::based_dict->attrs_insert("foreach", model::create_nfunc(model::dict_foreach));
     model::based_dict->attrs_insert("len", model::create_nfunc(model::dict_len));
 
     // List 类型魔法方法
-    model::based_list->attrs_insert("__add__", model::create_nfunc(model::list_add));
-    model::based_list->attrs_insert("__mul__", model::create_nfunc(model::list_mul));
-    model::based_list->attrs_insert("__eq__", model::create_nfunc(model::list_eq));
+    model::based_list->attrs_insert("__add__", model::create_nfunc(model::list_add, 1));
+    model::based_list->attrs_insert("__mul__", model::create_nfunc(model::list_mul, 1));
+    model::based_list->attrs_insert("__eq__", model::create_nfunc(model::list_eq, 1));
     model::based_list->attrs_insert("__call__", model::create_nfunc(model::list_call));
     model::based_list->attrs_insert("__bool__", model::create_nfunc(model::list_bool));
     model::based_list->attrs_insert("__next__", model::create_nfunc(model::list_next));
     model::based_list->attrs_insert("__getitem__", model::create_nfunc(model::list_getitem));
-    model::based_list->attrs_insert("__setitem__", model::create_nfunc(model::list_setitem));
+    model::based_list->attrs_insert("__setitem__", model::create_nfunc(model::list_setitem, 2));
     model::based_list->attrs_insert("__str__", model::create_nfunc(model::list_str));
     model::based_list->attrs_insert("__dstr__", model::create_nfunc(model::list_dstr));
 
-    model::based_list->attrs_insert("append", model::create_nfunc(model::list_append));
-    model::based_list->attrs_insert("contains", model::create_nfunc(model::list_contains));
+    model::based_list->attrs_insert("append", model::create_nfunc(model::list_append, 1));
+    model::based_list->attrs_insert("contains", model::create_nfunc(model::list_contains, 1));
     model::based_list->attrs_insert("foreach", model::create_nfunc(model::list_foreach));
     model::based_list->attrs_insert("reverse", model::create_nfunc(model::list_reverse));
     model::based_list->attrs_insert("extend", model::create_nfunc(model::list_extend));
@@ -114,9 +114,9 @@ void Vm::entry_builtins() {
     model::based_list->attrs_insert("join", model::create_nfunc(model::list_join));
 
     // String 类型魔法方法
-    model::based_str->attrs_insert("__add__", model::create_nfunc(model::str_add));
-    model::based_str->attrs_insert("__mul__", model::create_nfunc(model::str_mul));
-    model::based_str->attrs_insert("__eq__", model::create_nfunc(model::str_eq));
+    model::based_str->attrs_insert("__add__", model::create_nfunc(model::str_add, 1));
+    model::based_str->attrs_insert("__mul__", model::create_nfunc(model::str_mul, 1));
+    model::based_str->attrs_insert("__eq__", model::create_nfunc(model::str_eq, 1));
     model::based_str->attrs_insert("__call__", model::create_nfunc(model::str_call));
     model::based_str->attrs_insert("__bool__", model::create_nfunc(model::str_bool));
     model::based_str->attrs_insert("__hash__", model::create_nfunc(model::str_hash));
@@ -125,7 +125,7 @@ void Vm::entry_builtins() {
     model::based_str->attrs_insert("__dstr__", model::create_nfunc(model::str_dstr));
     model::based_str->attrs_insert("__next__", model::create_nfunc(model::str_next));
 
-    model::based_str->attrs_insert("contains", model::create_nfunc(model::str_contains));
+    model::based_str->attrs_insert("contains", model::create_nfunc(model::str_contains, 1));
     model::based_str->attrs_insert("count", model::create_nfunc(model::str_count));
     model::based_str->attrs_insert("foreach", model::create_nfunc(model::str_foreach));
     model::based_str->attrs_insert("startswith", model::create_nfunc(model::str_startswith));
@@ -139,11 +139,11 @@ void Vm::entry_builtins() {
     model::based_str->attrs_insert("format", model::create_nfunc(model::str_format));
 
     // FileHandle类型
-    model::based_file_handle->attrs_insert("read", model::create_nfunc(model::file_handle_read));
-    model::based_file_handle->attrs_insert("flush", model::create_nfunc(model::file_handle_flush));
-    model::based_file_handle->attrs_insert("write", model::create_nfunc(model::file_handle_write));
-    model::based_file_handle->attrs_insert("readline", model::create_nfunc(model::file_handle_readline));
-    model::based_file_handle->attrs_insert("close", model::create_nfunc(model::file_handle_close));
+    model::based_file_handle->attrs_insert("read", model::create_nfunc(model::file_handle_read, 0));
+    model::based_file_handle->attrs_insert("flush", model::create_nfunc(model::file_handle_flush, 0));
+    model::based_file_handle->attrs_insert("write", model::create_nfunc(model::file_handle_write, 1));
+    model::based_file_handle->attrs_insert("readline", model::create_nfunc(model::file_handle_readline, 1));
+    model::based_file_handle->attrs_insert("close", model::create_nfunc(model::file_handle_close, 0));
 
     // Range类型
     model::based_range->attrs_insert("__call__", model::create_nfunc(model::range_call));
@@ -151,7 +151,7 @@ void Vm::entry_builtins() {
     model::based_range->attrs_insert("__next__", model::create_nfunc(model::range_next));
 
     // Error类型
-    model::based_error->attrs_insert("__call__", model::create_nfunc(model::error_call));
+    model::based_error->attrs_insert("__call__", model::create_nfunc(model::error_call, 2));
     model::based_error->attrs_insert("__str__", model::create_nfunc(model::error_str));
 
     // Module类型
@@ -168,14 +168,14 @@ void Vm::entry_builtins() {
     };
     builtin_insert("print", model::create_nfunc(builtin::print, "print"));
     builtin_insert("input", model::create_nfunc(builtin::input, "input"));
-    builtin_insert("ischild", model::create_nfunc(builtin::ischild, "ischild"));
+    builtin_insert("ischild", model::create_nfunc(builtin::ischild, 2, "ischild"));
     builtin_insert("create", model::create_nfunc(builtin::create, "create"));
     builtin_insert("now", model::create_nfunc(builtin::now, "now"));
     builtin_insert("get_refc", model::create_nfunc(builtin::get_refc, "get_refc"));
     builtin_insert("breakpoint", model::create_nfunc(builtin::breakpoint, "breakpoint"));
     builtin_insert("cmd", model::create_nfunc(builtin::cmd, "cmd"));
     builtin_insert("help", model::create_nfunc(builtin::help, "help"));
-    builtin_insert("delattr", model::create_nfunc(builtin::delattr, "delattr"));
+    builtin_insert("delattr", model::create_nfunc(builtin::delattr, 2, "delattr"));
     builtin_insert("setattr", model::create_nfunc(builtin::setattr, "setattr"));
     builtin_insert("getattr", model::create_nfunc(builtin::getattr, "getattr"));
     builtin_insert("hasattr", model::create_nfunc(builtin::hasattr, "hasattr"));
@@ -184,7 +184,7 @@ void Vm::entry_builtins() {
     builtin_insert("debug_str", model::create_nfunc(builtin::debug_str, "debug_str"));
     builtin_insert("attr", model::create_nfunc(builtin::attr, "attr"));
     builtin_insert("sleep", model::create_nfunc(builtin::sleep, "sleep"));
-    builtin_insert("open", model::create_nfunc(builtin::open, "open"));
+    builtin_insert("open", model::create_nfunc(builtin::open, 2, "open"));
     builtin_insert("assert", model::create_nfunc(builtin::assert_, "assert"));
     builtin_insert("panic", model::create_nfunc(builtin::panic, "panic"));
 
@@ -9,48 +9,48 @@ void Vm::execute_unit(const Instruction& instruction) {
     case Opcode::OP_ADD: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__add__", {b.get()});
+        call_method(a.get(), model::magic_name::add, {b.get()});
         break;
     }
 
     case Opcode::OP_SUB: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__sub__", {b.get()});
+        call_method(a.get(), model::magic_name::sub, {b.get()});
         break;
     }
 
     case Opcode::OP_MUL: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__mul__", {b.get()});
+        call_method(a.get(), model::magic_name::mul, {b.get()});
         break;
     }
 
     case Opcode::OP_DIV: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__div__", {b.get()});
+        call_method(a.get(), model::magic_name::div, {b.get()});
         break;
     }
 
     case Opcode::OP_MOD: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__mod__", {b.get()});
+        call_method(a.get(), model::magic_name::mod, {b.get()});
         break;
     }
 
     case Opcode::OP_POW: {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__pow__", {b.get()});
+        call_method(a.get(), model::magic_name::pow, {b.get()});
         break;
     }
 
     case Opcode::OP_NEG: {
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__neg__", {});
+        call_method(a.get(), model::magic_name::neg, {});
         break;
     }
 
@@ -58,7 +58,7 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__eq__", {b.get()});
+        call_method(a.get(), model::magic_name::eq, {b.get()});
         break;
     }
 
@@ -66,7 +66,7 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__gt__", {b.get()});
+        call_method(a.get(), model::magic_name::gt, {b.get()});
         break;
     }
 
@@ -74,7 +74,7 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__lt__", {b.get()});
+        call_method(a.get(), model::magic_name::lt, {b.get()});
         break;
     }
 
@@ -82,8 +82,8 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__eq__", {b.get()});
-        call_method(a.get(), "__gt__", {b.get()});
+        call_method(a.get(), model::magic_name::eq, {b.get()});
+        call_method(a.get(), model::magic_name::gt, {b.get()});
 
         // 统一使用封装的栈操作获取结果
         auto gt_result = get_and_pop_stack_top();
@@ -103,10 +103,10 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto a = get_and_pop_stack_top();
 
         // 调用__eq__方法
-        call_method(a.get(), "__eq__", {b.get()});
+        call_method(a.get(), model::magic_name::eq, {b.get()});
 
         // 调用__lt__方法
-        call_method(a.get(), "__lt__", {b.get()});
+        call_method(a.get(), model::magic_name::lt, {b.get()});
 
         // 获取结果
         auto lt_result = get_and_pop_stack_top();
@@ -127,7 +127,7 @@ void Vm::execute_unit(const Instruction& instruction) {
 
 
         // 调用__eq__方法
-        call_method(a.get(), "__eq__", {b.get()});
+        call_method(a.get(), model::magic_name::eq, {b.get()});
 
         // 获取比较结果
         auto eq_result = get_and_pop_stack_top();
@@ -158,7 +158,7 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto item = get_and_pop_stack_top();
 
         // 调用contains方法，参数为item
-        call_method(for_check.get(), "contains", {item.get()});
+        call_method(for_check.get(), model::magic_name::contains, {item.get()});
         break;
     }
 
@@ -173,34 +173,53 @@ void Vm::execute_unit(const Instruction& instruction) {
     }
 
     case Opcode::CREATE_CLOSURE: {
-        auto func_obj = dynamic_cast<model::Function*>(op_stack.back());
+        auto fn_template = model::as<model::Function>(op_stack.back());
 
-        auto& upvalues = func_obj->code->upvalues;
-        std::vector<model::Object*> free_vars {};
+        auto& upvalues = fn_template->code->upvalues;
+        if (upvalues.empty()) break;
+
+        // 常量池里的函数是共享的(且不参与引用计数), 每次定义闭包都新建一个函数对象来持有捕获的变量:
+        // 同一定义产生的闭包互不覆盖, 闭包与被捕获对象之间的环也能被循环回收器看到
+        auto func_obj = new model::Function(fn_template->name, fn_template->code, fn_template->argc);
+        func_obj->has_rest_params = fn_template->has_rest_params;
+        func_obj->free_vars.reserve(upvalues.size());
 
         for (const auto& [distance_from_curr, idx] : upvalues) {
             auto frame = call_stack[ call_stack.size() - distance_from_curr];
             size_t loc_based = frame->bp;
 
             auto var = op_stack[loc_based + idx];
-            var->make_ref();
-            free_vars.push_back( var );
+            // 函数递归引用自己时, 变量里还是模板, 换成新建的闭包
+            if (var == fn_template) var = func_obj;
+            // 尚未赋值的变量原样捕获为空, 由LOAD_FREE_VAR报错
+            if (var) var->make_ref();
+            func_obj->free_vars.push_back( var );
         }
 
-        func_obj->free_vars = free_vars;
+        auto old_top = get_and_pop_stack_top();
+        push_to_stack(func_obj);
         break;
     }
 
 
     case Opcode::CALL: {
         auto func_obj = get_and_pop_stack_top();
-        // 弹出栈顶-1元素 : 参数列表
-        auto args_obj = get_and_pop_stack_top();
-        handle_call(func_obj.get(), args_obj.get(), nullptr);
+        // 其下是opn_list[0]个参数, 由handle_call直接在栈上取用
+        handle_call(func_obj.get(), instruction.opn_list[0], nullptr);
+        break;
+    }
+
+    case Opcode::TAIL_CALL: {
+        auto func_obj = get_and_pop_stack_top();
+        handle_tail_call(func_obj.get(), instruction.opn_list[0]);
         break;
     }
 
     case Opcode::RET: {
+        // 先取出返回值: ensure块里的表达式语句会在栈顶留下自己的结果
+        auto return_val = get_and_pop_stack_top();
+        assert(return_val.get());
+
         // 执行ensure确保资源被释放
         handle_ensure();
 
@@ -209,46 +228,38 @@ void Vm::execute_unit(const Instruction& instruction) {
         call_stack.back()->bp = frame->last_bp;
         call_stack.back()->pc = frame->return_to_pc;
 
-        auto return_val = get_and_pop_stack_top();
-        assert(return_val.get());
-
-        while (frame->bp < op_stack.size()) {
-            op_stack.back()->del_ref();
-            op_stack.pop_back();
-        }
-
+        // 帧拆除时核对计数: 局部变量归还引用, 其上的临时值是借用的, 直接截掉
+        release_locals(frame);
+        op_stack.resize(frame->bp);
         push_to_stack(return_val.get());
-
-        frame->owner->del_ref();
-        frame->code_object->del_ref();
-        for (auto it: frame->iters) {
-            if (it) it->del_ref();
-        }
-
-        delete frame;
+        release_frame(frame);
         break;
     }
 
     case Opcode::CALL_METHOD: {
         auto obj = get_and_pop_stack_top();
 
-        // 弹出栈顶-1元素 : 参数列表
-        auto args_obj = get_and_pop_stack_top();
-
-        std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
+        const model::Symbol attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
 
-        auto func_obj = get_attr(obj.get(), attr_name);
+        model::Object* func_obj;
+        try {
+            func_obj = get_attr_cached(obj.get(), attr_name, instruction.opn_list[2]);
+        } catch (NativeFuncError&) {
+            // 找不到方法时参数不会被消费, 先从栈上清掉
+            drop_args(op_stack.size() - instruction.opn_list[1], instruction.opn_list[1]);
+            throw;
+        }
 
-        func_obj->make_ref();
-        handle_call(func_obj, args_obj.get(), obj.get());
+        // 其下是opn_list[1]个参数, 由handle_call直接在栈上取用
+        handle_call(func_obj, instruction.opn_list[1], obj.get());
         break;
     }
 
     case Opcode::GET_ATTR: {
         auto obj = get_and_pop_stack_top();
-         std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
+        const model::Symbol attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
 
-        model::Object* attr_val = get_attr(obj.get(), attr_name);
+        model::Object* attr_val = get_attr_cached(obj.get(), attr_name, instruction.opn_list[2]);
         push_to_stack(attr_val);
         break;
     }
@@ -256,17 +267,20 @@ void Vm::execute_unit(const Instruction& instruction) {
     case Opcode::SET_ATTR: {
         auto attr_val = get_and_pop_stack_top();
         auto obj = get_and_pop_stack_top();
-        std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
+        const model::Symbol attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
 
         if (std::ranges::find(builtins, obj.get()) != std::ranges::end(builtins)) {
             throw NativeFuncError("SetattrError", "Cannot reset or add attribute for builtin object");
         }
 
+        note_attr_write(obj.get());
         auto new_val = model::copy_if_mutable(attr_val.get());
-        auto old_it = obj.get()->attrs.find(attr_name);   // 获取旧值（若有）
+        // 先取出旧值: 插入后槽位里已经是新值
+        const auto old_it = obj.get()->attrs.find(attr_name);
+        model::Object* old_val = old_it ? old_it->value : nullptr;
         obj.get()->attrs_insert(attr_name, new_val);      // 插入新值，内部 make_ref
 
-        if (old_it) old_it->value->del_ref();       // 释放旧值
+        if (old_val) old_val->del_ref();       // 释放旧值
         break;
     }
 
@@ -274,7 +288,7 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto obj = get_and_pop_stack_top();
         auto args_list = get_and_pop_stack_top();
 
-        call_method(obj.get(), "__getitem__", model::cast_to_list(
+        call_method(obj.get(), model::magic_name::getitem, model::cast_to_list(
             args_list.get()
         ) -> val);
         break;
@@ -286,12 +300,19 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto obj = get_and_pop_stack_top();
 
         // 获取对象自身的 __setitem__
-        call_method(obj.get(), "__setitem__", {arg.get(), value.get()});
+        call_method(obj.get(), model::magic_name::setitem, {arg.get(), value.get()});
         break;
     }
 
     case Opcode::LOAD_VAR: {
-        auto val = op_stack[call_stack.back()->bp + instruction.opn_list[0]];
+        const auto frame = call_stack.back();
+        auto val = op_stack[frame->bp + instruction.opn_list[0]];
+        // 参数直接放在操作数栈上, 空槽位不能静默跳过, 否则后面的操作数会整体错位
+        if (!val) {
+            throw NativeFuncError("NameError",
+                "Undefined var '" + frame->code_object->var_names[instruction.opn_list[0]] + "'"
+            );
+        }
         push_to_stack(val);
         break;
     }
@@ -310,38 +331,26 @@ void Vm::execute_unit(const Instruction& instruction) {
     }
 
     case Opcode::LOAD_FREE_VAR: {
-        auto func = dynamic_cast<model::Function*>(call_stack.back()->owner);
+        auto func = model::as<model::Function>(call_stack.back()->owner);
         assert(func != nullptr);
-        push_to_stack(func->free_vars[ instruction.opn_list[0] ]);
+        auto val = func->free_vars[ instruction.opn_list[0] ];
+        if (!val) {
+            throw NativeFuncError("NameError",
+                "Undefined var '" + func->code->free_names[instruction.opn_list[0]] + "'"
+            );
+        }
+        push_to_stack(val);
         break;
     }
 
     case Opcode::SET_LOCAL: {
-        auto value = get_and_pop_stack_top();
-
-        size_t offset = call_stack.back()->bp + instruction.opn_list[0];
-        auto new_val = model::copy_if_mutable(value.get());
-        new_val->make_ref();
-
-        if (op_stack[offset]) {
-            op_stack[offset]->del_ref();
-        }
-        op_stack[offset] = new_val;
+        assign_slot(call_stack.back()->bp + instruction.opn_list[0], simple_get_and_pop_stack_top());
         break;
     }
 
 
     case Opcode::SET_GLOBAL: {
-        auto offset = instruction.opn_list[0];
-        auto value = get_and_pop_stack_top();
-
-        auto new_val = model::copy_if_mutable(value.get());
-        new_val->make_ref();
-        if (op_stack[offset]) {
-            op_stack[offset]->del_ref();
-        }
-
-        op_stack[offset] = new_val;
+        assign_slot(instruction.opn_list[0], simple_get_and_pop_stack_top());
         break;
     }
 
@@ -351,19 +360,12 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto frame = call_stack[ call_stack.size() - upvalue.distance_from_curr - 1]; // 区别于CREATE_CLOSURE指令, 这里在函数中要多减一
         size_t loc_based = frame->bp;
 
-        auto value = get_and_pop_stack_top();
-
-        auto new_val = model::copy_if_mutable(value.get());
-        new_val->make_ref();
-
-        if (op_stack[loc_based + upvalue.idx]) {
-            op_stack[loc_based + upvalue.idx]->del_ref();
-        }
-
-        op_stack[loc_based + upvalue.idx] = new_val;
+        auto new_val = assign_slot(loc_based + upvalue.idx, simple_get_and_pop_stack_top());
 
         // 更新闭包
-        if (auto f = dynamic_cast<model::Function*>(call_stack.back()->owner)) {
+        if (auto f = model::as<model::Function>(call_stack.back()->owner)) {
+            new_val->make_ref();
+            if (f->free_vars[idx_of_upvalue]) f->free_vars[idx_of_upvalue]->del_ref();
             f->free_vars[idx_of_upvalue] = new_val;
         }
         break;
@@ -372,9 +374,9 @@ void Vm::execute_unit(const Instruction& instruction) {
 
     case Opcode::THROW: {
         auto top = get_and_pop_stack_top();
+        top.get()->make_ref();
         if (call_stack.back()->curr_error) call_stack.back()->curr_error->del_ref();
         call_stack.back()->curr_error = top.get();
-        top.get()->make_ref();     // 使 curr_error 持有引用
         handle_throw();
         break;
     }
@@ -383,7 +385,6 @@ void Vm::execute_unit(const Instruction& instruction) {
         if (!call_stack.back()->curr_error) {
             throw KizStopRunningSignal("Unable to load error");
         }
-        call_stack.back()->curr_error->make_ref();
         push_to_stack(call_stack.back()->curr_error);
         break;
     }
@@ -414,13 +415,13 @@ void Vm::execute_unit(const Instruction& instruction) {
 
     case Opcode::CREATE_OBJECT: {
         auto obj = new model::Object();
-        obj->attrs_insert("__parent__", model::based_obj);
+        obj->attrs_insert(model::magic_name::parent, model::based_obj);
         push_to_stack(obj);
         break;
     }
 
     case Opcode::IMPORT: {
-        std::string module_path = get_attr_name_by_idx(instruction.opn_list[0]);
+        const std::string& module_path = get_attr_name_by_idx(instruction.opn_list[0]).str();
         handle_import(module_path);
         break;
     }
@@ -466,6 +467,11 @@ void Vm::execute_unit(const Instruction& instruction) {
         break;
     }
 
+    case Opcode::POP_TOP: {
+        auto obj = get_and_pop_stack_top();
+        break;
+    }
+
     case Opcode::STOP: {
         running = false;
         break;
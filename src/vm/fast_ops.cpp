@@ -0,0 +1,193 @@
+/**
+ * @file fast_ops.cpp
+ * @brief 运算符快速路径
+ * 两个操作数都是内置的Int/Decimal/Str/Bool时直接计算结果,
+ * 省去call_method的魔术方法查找, 参数List的构造和std::function调用.
+ * 计算规则与libs/builtins下对应的魔术方法保持一致;
+ * 除零等需要抛错的情况返回nullptr, 交给慢路径按原协议报错
+ */
+
+#include "vm.hpp"
+#include "../models/models.hpp"
+#include "../opcode/opcode.hpp"
+
+namespace kiz {
+
+namespace {
+
+using model::Object;
+using ObjectType = model::Object::ObjectType;
+
+bool is_builtin_value_type(const ObjectType t) {
+    return t == ObjectType::Int or t == ObjectType::Decimal
+        or t == ObjectType::String or t == ObjectType::Bool;
+}
+
+// 比较运算统一由 eq/lt/gt 三个结果组合, 与OP_GE/OP_LE/OP_NE的慢路径语义相同
+template <typename T>
+Object* compare(const Opcode opc, const T& a, const T& b) {
+    switch (opc) {
+        case Opcode::OP_EQ: return model::load_bool(a == b);
+        case Opcode::OP_NE: return model::load_bool(!(a == b));
+        case Opcode::OP_LT: return model::load_bool(a < b);
+        case Opcode::OP_GT: return model::load_bool(a > b);
+        case Opcode::OP_LE: return model::load_bool(a < b or a == b);
+        case Opcode::OP_GE: return model::load_bool(a > b or a == b);
+        default: return nullptr;
+    }
+}
+
+// Int 与 Int
+Object* int_int_op(const Opcode opc, const dep::BigInt& a, const dep::BigInt& b) {
+    switch (opc) {
+        case Opcode::OP_ADD: return model::load_int(a + b);
+        case Opcode::OP_SUB: return model::load_int(a - b);
+        case Opcode::OP_MUL: return model::load_int(a * b);
+        case Opcode::OP_DIV: {
+            if (b == 0) return nullptr;
+            return new model::Decimal(dep::Decimal(a).div(dep::Decimal(b), 10));
+        }
+        case Opcode::OP_MOD: {
+            if (b == dep::BigInt(0)) return nullptr;
+            dep::BigInt remainder = a % b;
+            // 修正余数符号（确保与除数同号）
+            if (remainder != dep::BigInt(0)
+                and (a < dep::BigInt(0)) != (b < dep::BigInt(0))
+            ) {
+                remainder += b;
+            }
+            return model::load_int(std::move(remainder));
+        }
+        case Opcode::OP_POW: {
+            // 负指数返回Decimal, 交给慢路径
+            if (b.is_negative()) return nullptr;
+            return model::load_int(a.pow(b));
+        }
+        default: return compare(opc, a, b);
+    }
+}
+
+// 至少一边是Decimal, 另一边是Int或Decimal
+Object* decimal_op(const Opcode opc, Object* a, Object* b) {
+    const bool a_is_int = a->get_type() == ObjectType::Int;
+    const bool b_is_int = b->get_type() == ObjectType::Int;
+
+    switch (opc) {
+        case Opcode::OP_ADD:
+        case Opcode::OP_SUB:
+        case Opcode::OP_MUL: {
+            dep::Decimal res;
+            if (a_is_int) {
+                // 同Int.__add__等: 先把左操作数转成Decimal
+                const dep::Decimal left(model::as_unchecked<model::Int>(a)->val);
+                const auto& right = model::as_unchecked<model::Decimal>(b)->val;
+                res = opc == Opcode::OP_ADD ? left + right
+                    : opc == Opcode::OP_SUB ? left - right
+                    : left * right;
+            } else if (b_is_int) {
+                const auto& left = model::as_unchecked<model::Decimal>(a)->val;
+                const auto& right = model::as_unchecked<model::Int>(b)->val;
+                res = opc == Opcode::OP_ADD ? left + right
+                    : opc == Opcode::OP_SUB ? left - right
+                    : left * right;
+            } else {
+                const auto& left = model::as_unchecked<model::Decimal>(a)->val;
+                const auto& right = model::as_unchecked<model::Decimal>(b)->val;
+                res = opc == Opcode::OP_ADD ? left + right
+                    : opc == Opcode::OP_SUB ? left - right
+                    : left * right;
+            }
+            return new model::Decimal(res);
+        }
+        case Opcode::OP_DIV: {
+            const dep::Decimal left = a_is_int
+                ? dep::Decimal(model::as_unchecked<model::Int>(a)->val)
+                : model::as_unchecked<model::Decimal>(a)->val;
+            const dep::Decimal right = b_is_int
+                ? dep::Decimal(model::as_unchecked<model::Int>(b)->val)
+                : model::as_unchecked<model::Decimal>(b)->val;
+            if (right == dep::Decimal(0)) return nullptr;
+            return new model::Decimal(left.div(right, 10));
+        }
+        case Opcode::OP_EQ:
+        case Opcode::OP_NE:
+        case Opcode::OP_LT:
+        case Opcode::OP_GT:
+        case Opcode::OP_LE:
+        case Opcode::OP_GE: {
+            const dep::Decimal left = a_is_int
+                ? dep::Decimal(model::as_unchecked<model::Int>(a)->val)
+                : model::as_unchecked<model::Decimal>(a)->val;
+            const dep::Decimal right = b_is_int
+                ? dep::Decimal(model::as_unchecked<model::Int>(b)->val)
+                : model::as_unchecked<model::Decimal>(b)->val;
+            return compare(opc, left, right);
+        }
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+void Vm::note_attr_write(const model::Object* obj) {
+    if (!builtin_ops_intact) return;
+    if (is_builtin_value_type(obj->get_type())
+        or std::ranges::find(builtins, obj) != std::ranges::end(builtins)) {
+        builtin_ops_intact = false;
+    }
+}
+
+model::Object* Vm::try_fast_binary_op(const Opcode opc, model::Object* a, model::Object* b) {
+    if (!builtin_ops_intact or a == nullptr or b == nullptr) return nullptr;
+
+    const auto a_type = a->get_type();
+    const auto b_type = b->get_type();
+
+    if (a_type == ObjectType::Int and b_type == ObjectType::Int) {
+        return int_int_op(opc, model::as_unchecked<model::Int>(a)->val, model::as_unchecked<model::Int>(b)->val);
+    }
+
+    if ((a_type == ObjectType::Decimal and (b_type == ObjectType::Int or b_type == ObjectType::Decimal))
+        or (a_type == ObjectType::Int and b_type == ObjectType::Decimal)) {
+        // Decimal没有__mod__, Int.__pow__/Decimal.__pow__不接受Decimal指数
+        if (opc == Opcode::OP_MOD or opc == Opcode::OP_POW) return nullptr;
+        return decimal_op(opc, a, b);
+    }
+
+    if (a_type == ObjectType::String and b_type == ObjectType::String) {
+        const auto& left = model::as_unchecked<model::String>(a)->val;
+        const auto& right = model::as_unchecked<model::String>(b)->val;
+        switch (opc) {
+            case Opcode::OP_ADD: return model::create_str(left + right);
+            case Opcode::OP_EQ: return model::load_bool(left == right);
+            case Opcode::OP_NE: return model::load_bool(left != right);
+            default: return nullptr;
+        }
+    }
+
+    if (a_type == ObjectType::Bool and b_type == ObjectType::Bool) {
+        const bool left = model::as_unchecked<model::Bool>(a)->val;
+        const bool right = model::as_unchecked<model::Bool>(b)->val;
+        switch (opc) {
+            case Opcode::OP_EQ: return model::load_bool(left == right);
+            case Opcode::OP_NE: return model::load_bool(left != right);
+            default: return nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+model::Object* Vm::try_fast_neg(model::Object* a) {
+    if (!builtin_ops_intact or a == nullptr) return nullptr;
+    switch (a->get_type()) {
+        case ObjectType::Int:
+            return model::load_int(dep::BigInt(0) - model::as_unchecked<model::Int>(a)->val);
+        case ObjectType::Decimal:
+            return new model::Decimal(dep::Decimal(dep::BigInt(0)) - model::as_unchecked<model::Decimal>(a)->val);
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace kiz
@@ -1,68 +1,192 @@
+#include <algorithm>
 #include <utility>
 
 #include "vm.hpp"
 #include "../models/models.hpp"
 #include "opcode/opcode.hpp"
-#include <unordered_set>
 
 namespace kiz {
 
 bool Vm::is_true(model::Object* obj) {
-    if (const auto bool_obj = dynamic_cast<const model::Bool*>(obj)) {
+    if (const auto bool_obj = model::as<model::Bool>(obj)) {
         return bool_obj->val==true;
     }
-    if (dynamic_cast<const model::Nil*>(obj)) {
+    if (model::as<model::Nil>(obj)) {
         return false;
     }
 
-    call_method(obj, "__bool__", {});
+    call_method(obj, model::magic_name::bool_of, {});
     auto result = simple_get_and_pop_stack_top();
     bool ret = is_true(result);
 
     return ret;
 }
 
-model::Object* Vm::get_attr(model::Object* obj, const std::string& attr_name) {
+model::Object* Vm::get_attr(model::Object* obj, const model::Symbol attr_name) {
     assert(obj != nullptr);
-    const auto attr_it = obj->attrs.find(attr_name);
-    auto parent_it = obj->attrs.find("__parent__");
-    if (attr_it) {
-        return attr_it->value;
+    // 沿__parent__链迭代查找
+    for (model::Object* curr = obj; curr != nullptr; ) {
+        if (const auto attr_it = curr->attrs.find(attr_name)) {
+            return attr_it->value;
+        }
+        const auto parent_it = curr->attrs.find_parent();
+        curr = parent_it ? parent_it->value : nullptr;
+    }
+
+    throw NativeFuncError("NameError",
+        "Undefined attribute '" + attr_name.str() + "'"
+    );
+}
+
+model::Object* Vm::get_attr(model::Object* obj, const std::string_view attr_name) {
+    assert(obj != nullptr);
+    const auto sym = model::Symbol::find(attr_name);
+    if (!sym.valid()) {
+        throw NativeFuncError("NameError",
+            "Undefined attribute '" + std::string(attr_name) + "'"
+        );
     }
+    return get_attr(obj, sym);
+}
 
-    if (parent_it) {
-        return get_attr(parent_it->value, attr_name);
+model::Object* Vm::get_attr_cached(model::Object* obj, const model::Symbol attr_name, const size_t cache_slot) {
+    assert(obj != nullptr);
+    const model::Shape* shape = obj->attrs.shape();
+    auto& cache = get_frame()->code_object->attr_caches[cache_slot];
+
+    for (const auto& entry : cache.entries) {
+        if (entry.shape != shape or entry.epoch != model::attr_epoch) continue;
+        if (entry.own) return obj->attrs.value_at(entry.slot);
+        if (obj->attrs.value_at(entry.slot) == entry.proto) return entry.value;
     }
 
+    // 未命中: 查找并填入缓存
+    model::AttrCacheEntry new_entry {shape, 0, false, nullptr, nullptr, model::attr_epoch};
+    model::Object* value;
+    if (const size_t own_slot = shape->lookup(attr_name); own_slot != model::Shape::npos) {
+        new_entry.own = true;
+        new_entry.slot = own_slot;
+        value = obj->attrs.value_at(own_slot);
+    } else {
+        const size_t parent_slot = shape->parent_slot();
+        if (parent_slot == model::Shape::npos) {
+            throw NativeFuncError("NameError",
+                "Undefined attribute '" + attr_name.str() + "'"
+            );
+        }
+        new_entry.slot = parent_slot;
+        new_entry.proto = obj->attrs.value_at(parent_slot);
+        value = get_attr(new_entry.proto, attr_name);
+        new_entry.value = value;
+    }
+
+    cache.entries[cache.next] = new_entry;
+    cache.next = (cache.next + 1) % model::AttrCache::ways;
+    return value;
+}
+
+model::Object* Vm::get_attr_current(model::Object* obj, const model::Symbol attr) {
+    const auto attr_it = obj->attrs.find(attr);
+    if (attr_it) {
+        return attr_it->value;
+    }
     throw NativeFuncError("NameError",
-        "Undefined attribute '" + attr_name + "'"
+        "Undefined attribute '" + attr.str() + "'" + " of current attributes table"
     );
 }
 
-model::Object* Vm::get_attr_current(model::Object* obj, const std::string& attr) {
+model::Object* Vm::get_attr_current(model::Object* obj, const std::string_view attr) {
     const auto attr_it = obj->attrs.find(attr);
     if (attr_it) {
         return attr_it->value;
     }
     throw NativeFuncError("NameError",
-        "Undefined attribute '" + attr + "'" + " of current attributes table"
+        "Undefined attribute '" + std::string(attr) + "'" + " of current attributes table"
     );
 }
 
-void Vm::handle_call(model::Object* func_obj, model::Object* args_obj, model::Object* self){
-    assert(func_obj != nullptr);
-    assert(args_obj != nullptr);
-    auto args_list = dynamic_cast<model::List*>(args_obj);
+// 参数只能来自当前帧的临时值区: 落到局部变量槽位里说明栈上的操作数已经错位, 直接报错终止
+void Vm::check_args_base(const size_t base, const size_t argc) {
+    if (argc > op_stack.size()) {
+        throw KizStopRunningSignal("Unable to fetch call arguments");
+    }
+    if (call_stack.empty()) return;
+    const auto frame = call_stack.back();
+    if (base < frame->bp + frame->code_object->locals_count) {
+        throw KizStopRunningSignal("Call arguments overlap the locals of the current frame");
+    }
+}
+
+// 弹出操作数栈上[base, base + argc)这段参数; 参数是借用的, 不需要释放
+void Vm::drop_args(const size_t base, const size_t argc) {
+    op_stack.erase(op_stack.begin() + static_cast<std::ptrdiff_t>(base),
+        op_stack.begin() + static_cast<std::ptrdiff_t>(base + argc));
+}
+
+// 校验参数个数, 并把栈上[base, base + argc)的参数整理成func的前几个局部变量(插入self, 收集剩余参数)
+void Vm::bind_args(const model::Function* func, const size_t base, const size_t argc, model::Object* self) {
+    // 校验参数数量
+    const size_t required_argc = func->argc;
+    const bool pass_self = self and self->get_type() != model::Object::ObjectType::Module;
+    const size_t actual_argc = pass_self ? argc + 1 : argc;
+    if ((actual_argc != required_argc and !func->has_rest_params)
+        or (func->has_rest_params and actual_argc + 1 < required_argc)) {
+        drop_args(base, argc);
+        throw NativeFuncError("ArgCountError", std::format(
+            "expect {} arguments but got {} arguments", required_argc, actual_argc
+        ));
+    }
+
+    // 参数原地成为新帧的前几个局部变量: 新帧的bp就是第一个参数的位置, self插在最前面
+    if (pass_self) {
+        op_stack.insert(op_stack.begin() + static_cast<std::ptrdiff_t>(base), self);
+    }
+
+    if (func->has_rest_params) {
+        // 最后一个形参收集剩余参数, 只有这种情况需要构造List
+        const size_t rest_begin = base + required_argc - 1;
+        const auto rest_list = model::create_list(std::vector<model::Object*>(
+            op_stack.begin() + static_cast<std::ptrdiff_t>(rest_begin), op_stack.end()
+        ));
+        drop_args(rest_begin, op_stack.size() - rest_begin);
+        op_stack.push_back(rest_list);
+    }
+
+    // 从借用的临时值变成局部变量, 改由槽位持有计数引用
+    for (size_t i = base; i < op_stack.size(); ++i) op_stack[i]->make_ref();
+}
 
-    assert(args_list && "CALL: 栈顶-1元素非List类型（参数必须封装为列表）");
+void Vm::handle_call(model::Object* func_obj, const size_t argc, model::Object* self){
+    assert(func_obj != nullptr);
     DEBUG_OUTPUT("start to call function");
+    // 参数是操作数栈顶借用的argc个对象
+    const size_t base = op_stack.size() - argc;
+    check_args_base(base, argc);
 
     // 分类型处理函数调用（Function / NativeFunction）
-    if (const auto cpp_func = dynamic_cast<model::NativeFunction*>(func_obj)) {
+    if (const auto cpp_func = model::as<model::NativeFunction>(func_obj)) {
         // -------------------------- 处理 NativeFunction 调用 --------------------------
-        model::Object* return_val = cpp_func->func(self, args_list);
+        // 原生函数里可能回调脚本函数而使操作数栈扩容, 参数指针先复制到这里;
+        // 参数仍留在栈上的原位置, 调用期间一直被借用, 调用结束后统一弹出
+        constexpr size_t inline_argc = 8;
+        model::Object* inline_argv[inline_argc];
+        std::vector<model::Object*> heap_argv;
+        model::Object** argv = inline_argv;
+        if (argc > inline_argc) {
+            heap_argv.resize(argc);
+            argv = heap_argv.data();
+        }
+        std::copy_n(op_stack.begin() + static_cast<std::ptrdiff_t>(base), argc, argv);
+
+        model::Object* return_val;
+        try {
+            return_val = cpp_func->call(self, argv, argc);
+        } catch (...) {
+            drop_args(base, argc);
+            throw;
+        }
+        drop_args(base, argc);
 
-        // 管理返回值引用计数：返回值压栈前必须 make_ref
         if (!return_val){
             // 若返回空，默认压入 Nil（避免栈异常）
             return_val = model::unique_nil;
@@ -70,176 +194,127 @@ void Vm::handle_call(model::Object* func_obj, model::Object* args_obj, model::Ob
 
         // 返回值压入操作数栈
         push_to_stack(return_val);
-    } else if (auto func = dynamic_cast<model::Function*>(func_obj)) {
+    } else if (auto func = model::as<model::Function>(func_obj)) {
         // -------------------------- 处理 Function 调用 --------------------------
         DEBUG_OUTPUT("call Function: " + func->name);
 
-        // 校验参数数量
-        const size_t required_argc = func->argc;
-        size_t actual_argc;
-        if (self and self->get_type() != model::Object::ObjectType::Module) {
-            actual_argc = args_list->val.size() + 1;
-        } else {
-            actual_argc = args_list->val.size();
-        }
-        if (actual_argc != required_argc and !func->has_rest_params)
-            throw NativeFuncError("ArgCountError", std::format(
-                "expect {} arguments but got {} arguments", required_argc, actual_argc
-            ));
+        bind_args(func, base, argc, self);
 
-        // 创建新调用帧
+        // 新调用帧
         func->make_ref();
         func->code->make_ref();
-        auto new_frame = new CallFrame{
-            .name = func->name,
-
-            .owner = func,
-
-            .pc = 0,
-            .return_to_pc = call_stack.back()->pc + 1,
-            .last_bp = call_stack.back()->bp,
-            .bp = op_stack.size(),
-            .code_object = func->code,
-
-            .iters{},
-
-            .curr_error = nullptr,
-            .exec_ensure_stmt = false
-        };
-        op_stack.resize(op_stack.size() + func->code->locals_count);
-
-        // 储存self
-        if (self and self->get_type() != model::Object::ObjectType::Module) {
-            self->make_ref();
-            args_list->val.emplace(args_list->val.begin(), self);
-        }
-
-        if (func->has_rest_params) {
-            for (size_t i = 0; i < required_argc; ++i) {
-                std::string param_name = new_frame->code_object->var_names[i];
-                model::Object* param_val;
-                if (i == required_argc - 1 ) {
-                    args_list->val.assign(args_list->val.begin() + i, args_list->val.end());
-                    param_val = args_list;
-                }
-                else {
-                    param_val = args_list->val[i];  // 从列表取参数
-                }
-
-                assert(param_val);
-                param_val->make_ref();
-                op_stack[new_frame->bp + i] = param_val;
-            }
-
-            call_stack.emplace_back(new_frame);
-            return;
-        }
-
-        // 从参数列表中提取参数，存入locals
-        for (size_t i = 0; i < required_argc; ++i) {
-            std::string param_name = new_frame->code_object->var_names[i];
-            model::Object* param_val = args_list->val[i];  // 从列表取参数
-
-            // 校验参数非空
-            assert(param_val != nullptr);
-
-            // 增加参数引用计数（存入locals需持有引用）
-            param_val->make_ref();
-            op_stack[new_frame->bp + i] = param_val;
-        }
+        op_stack.resize(base + func->code->frame_size());
 
-        // 压入新调用帧，更新程序计数器
-        call_stack.emplace_back(new_frame);
+        // 压入新调用帧(复用帧栈中的槽位)
+        call_stack.push(func, func->code, call_stack.back()->pc + 1, call_stack.back()->bp, base);
 
     // 处理对象魔术方法__call__
     } else {
         model::Object* callable;
         try {
-            callable = get_attr(func_obj, "__call__");
+            callable = get_attr(func_obj, model::magic_name::call);
         } catch (NativeFuncError& e) {
+            drop_args(base, argc);
             throw NativeFuncError("TypeError", "try to call an uncallable object");
         }
         assert(callable);
-        handle_call(callable, args_obj, func_obj);
+        handle_call(callable, argc, func_obj);
     }
 }
 
+void Vm::handle_tail_call(model::Object* func_obj, const size_t argc) {
+    assert(func_obj != nullptr);
+    check_args_base(op_stack.size() - argc, argc);
+    const auto frame = call_stack.back();
+    const auto func = model::as<model::Function>(func_obj);
+
+    // 原生函数/__call__对象, 依赖调用者帧布局的函数, 返回前还要执行ensure的帧以及原生函数调用的帧,
+    // 都按普通调用处理: 返回后执行TAIL_CALL之后保留的RET
+    if (!func or func->code->frame_reach > 0
+        or !frame->code_object->ensure_stmts.empty()
+        or frame->called_from_native
+        or frame->owner->get_type() != model::Object::ObjectType::Function) {
+        handle_call(func_obj, argc, nullptr);
+        ++frame->pc;
+        return;
+    }
+
+    DEBUG_OUTPUT("tail call Function: " + func->name);
+    const size_t base = op_stack.size() - argc;
+    bind_args(func, base, argc, nullptr);
+
+    // 先持有新函数, 再释放当前帧的局部变量并丢弃临时值: 它们可能持有func的最后一个引用
+    func->make_ref();
+    func->code->make_ref();
+    release_locals(frame);
+    drop_args(frame->bp, base - frame->bp);
+    op_stack.resize(frame->bp + func->code->frame_size());
+
+    // 当前帧改为执行func, 返回地址和bp保持不变; 之前执行完的try/catch可能还留着错误对象
+    release_frame(frame);
+    frame->owner = func;
+    frame->code_object = func->code;
+    frame->pc = 0;
+    frame->exec_ensure_stmt = false;
+}
+
 void Vm::call_function(model::Object* func_obj, std::vector<model::Object*> args, model::Object* self) {
+    // 原生函数回调脚本: 它以裸指针持有的对象在回调期间不能被释放
+    const model::ZctPin pin;
     size_t old_call_stack_size = call_stack.size();
 
-    auto temp_args = new model::List(std::move(args));
-    temp_args->make_ref();
-    handle_call(func_obj, temp_args, self);
-    temp_args->del_ref();
+    for (const auto arg : args) push_to_stack(arg);
+    handle_call(func_obj, args.size(), self);
 
     if (old_call_stack_size == call_stack.size()) return;
 
-    while (running and !call_stack.empty() and call_stack.size() > old_call_stack_size) {
-        auto curr_frame = call_stack.back();
-        auto& frame_code = curr_frame->code_object;
-
-        // 检查是否执行到模块代码末尾：执行完毕则出栈
-        if (curr_frame->pc >= frame_code->code.size()) {
-            call_stack.pop_back();
-            continue;
-        }
-
-        // 执行当前指令
-        const Instruction& curr_inst = frame_code->code[curr_frame->pc];
-        try {
-            if (curr_inst.opc == Opcode::RET and old_call_stack_size == call_stack.size() - 1) {
-                assert(!call_stack.empty());
-                call_stack.pop_back();
-                return;
-            }
-            execute_unit(curr_inst); // 调用VM的指令执行核心方法
-        } catch (const NativeFuncError& e) {
-            // 原生函数执行错误，抛出异常
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
-
-        ADVANCE_PC
+    // 调用者仍停在当前指令上, 由外层循环推进pc, 所以返回地址不加一
+    if (old_call_stack_size > 0) {
+        call_stack.back()->return_to_pc = call_stack[old_call_stack_size - 1]->pc;
+    }
+    call_stack.back()->called_from_native = true;
+    run_until(old_call_stack_size);
 
+    // 没有以RET结束的帧(理论上不会出现)直接弹出
+    while (call_stack.size() > old_call_stack_size) {
+        call_stack.pop_back();
     }
 }
 
-void Vm::call_method(model::Object* obj, const std::string& attr_name, std::vector<model::Object*> args) {
+void Vm::call_method(model::Object* obj, const model::Symbol attr_name, std::vector<model::Object*> args) {
     assert(obj != nullptr);
-    auto parent_it = obj->attrs.find("__parent__");
-    static const std::unordered_set<std::string_view> magic_methods = {
-    std::string_view("__add__"), std::string_view("__sub__"),
-    std::string_view("__mul__"), std::string_view("__div__"),
-    std::string_view("__pow__"), std::string_view("__mod__"),
-    std::string_view("__neg__"), std::string_view("__eq__"),
-    std::string_view("__gt__"), std::string_view("__lt__"),
-    std::string_view("__str__"), std::string_view("__dstr__"),
-    std::string_view("__bool__"), std::string_view("__getitem__"),
-    std::string_view("__setitem__"), std::string_view("contains"),
-    std::string_view("__next__"), std::string_view("__hash__")
-    };
-
-    const bool is_magic = magic_methods.contains(std::string_view(attr_name));
-    if (!is_magic) {
+    // 魔术方法只在原型链上查找
+    if (!model::magic_name::is_magic_method(attr_name)) {
         call_function(get_attr(obj, attr_name), args, obj);
         return;
     }
 
-    if (parent_it) {
+    if (const auto parent_it = obj->attrs.find_parent()) {
         call_function(get_attr(parent_it->value, attr_name), args, obj);
         return;
     }
     throw NativeFuncError("NameError",
-        "Undefined method '" + attr_name + "'"
+        "Undefined method '" + attr_name.str() + "'"
     );
 }
 
+void Vm::call_method(model::Object* obj, const std::string_view attr_name, std::vector<model::Object*> args) {
+    assert(obj != nullptr);
+    const auto sym = model::Symbol::find(attr_name);
+    if (!sym.valid()) {
+        throw NativeFuncError("NameError",
+            "Undefined attribute '" + std::string(attr_name) + "'"
+        );
+    }
+    call_method(obj, sym, std::move(args));
+}
+
 std::string Vm::obj_to_str(model::Object* for_cast_obj) {
     DEBUG_OUTPUT("obj to str");
     try {
-        call_method(for_cast_obj, "__str__", {});
+        call_method(for_cast_obj, model::magic_name::str, {});
     } catch (NativeFuncError& e) {
-        call_method(for_cast_obj, "__dstr__", {});
+        call_method(for_cast_obj, model::magic_name::debug_str, {});
     }
     auto res = simple_get_and_pop_stack_top();
     std::string val = model::cast_to_str(res)->val;
@@ -250,9 +325,9 @@ std::string Vm::obj_to_str(model::Object* for_cast_obj) {
 std::string Vm::obj_to_debug_str(model::Object* for_cast_obj) {
     DEBUG_OUTPUT("obj to debug str");
     try {
-        call_method(for_cast_obj, "__dstr__", {});
+        call_method(for_cast_obj, model::magic_name::debug_str, {});
     } catch (NativeFuncError& e) {
-        call_method(for_cast_obj, "__str__", {});
+        call_method(for_cast_obj, model::magic_name::str, {});
     }
     auto res = simple_get_and_pop_stack_top();
     std::string val = model::cast_to_str(res) ->val;
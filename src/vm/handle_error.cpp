@@ -9,12 +9,12 @@ namespace kiz {
 // -------------------------- 异常处理 --------------------------
 
 void Vm::forward_to_handle_throw(const std::string& name, const std::string& content) {
-    const auto err_name = new model::String(name);
-    const auto err_msg = new model::String(content);
+    const auto err_name = model::create_str(name);
+    const auto err_msg = model::create_str(content);
     const auto err_obj = new model::Error(make_pos_info());
 
-    err_obj->attrs_insert("__name__", err_name);
-    err_obj->attrs_insert("__msg__", err_msg);
+    err_obj->attrs_insert(model::magic_name::name, err_name);
+    err_obj->attrs_insert(model::magic_name::msg, err_msg);
 
     // 替换全局curr_error前，释放旧错误对象
     if (call_stack.back()->curr_error) {
@@ -31,8 +31,8 @@ void Vm::handle_throw() {
     // 提取错误对象的 __name__ 和 __msg__
     auto err = call_stack.back()->curr_error;
     err->make_ref();
-    auto err_name_it = err->attrs.find("__name__");
-    auto err_msg_it = err->attrs.find("__msg__");
+    auto err_name_it = err->attrs.find(model::magic_name::name);
+    auto err_msg_it = err->attrs.find(model::magic_name::msg);
 
     if (!err_name_it or !err_msg_it) {
         throw KizStopRunningSignal(
@@ -59,12 +59,20 @@ void Vm::handle_throw() {
                     frame->pc = table.mismatch_pc;
                 }
 
-                // 弹出多余的栈帧
+                // 弹出多余的栈帧, 释放它们的局部变量和持有的对象(包括抛出时的curr_error);
+                // 帧之上剩下的槽位只是借用, 留给catch块之后的指令覆盖
                 for (size_t i = 0; i < frames_to_pop; ++i) {
+                    const auto popped = call_stack.back();
                     call_stack.pop_back();
+                    release_locals(popped);
+                    release_frame(popped);
                 }
-                err->make_ref();
-                frame->curr_error = err;
+                if (frame->curr_error != err) {
+                    err->make_ref();
+                    if (frame->curr_error) frame->curr_error->del_ref();
+                    frame->curr_error = err;
+                }
+                err->del_ref();
                 return;
             }
         }
@@ -72,7 +80,7 @@ void Vm::handle_throw() {
     }
 
     // 没有找到任何能处理该异常的 try 块：打印错误信息并终止执行
-    if (const auto err_obj = dynamic_cast<model::Error*>(err)) {
+    if (const auto err_obj = model::as<model::Error>(err)) {
         std::cout << Color::BRIGHT_RED << "\nTrace Back: " << Color::RESET << std::endl;
         for (auto& [_path, _pos] : err_obj->positions) {
             err::context_printer(_path, _pos);
@@ -85,8 +93,10 @@ void Vm::handle_throw() {
 
     std::cout << std::endl;
 
-    err->del_ref();
+    // 归还这里和抛出帧的curr_error持有的两个引用
     call_stack.back()->curr_error = nullptr;
+    err->del_ref();
+    err->del_ref();
     throw KizStopRunningSignal();
 }
 
@@ -94,37 +104,32 @@ void Vm::handle_ensure() {
     auto frame = call_stack.back();
     if (frame->exec_ensure_stmt) return;
 
-    auto ensures = frame->code_object->ensure_stmts;
-    if (ensures.empty()) {
+    const auto code_object = frame->code_object;
+    if (code_object->ensure_stmts.empty()) {
         return;
     }
 
-    auto old_code = frame->code_object->code;
-    size_t old_pc = call_stack.back()->pc;
-    frame->code_object->code = ensures;
-    frame->pc = 0;
-
-    while (!call_stack.empty() && running) {
-        auto curr_frame = call_stack.back();
-        // 检查当前帧是否执行完毕
-        if (curr_frame->pc >= curr_frame->code_object->code.size()) {
-            break;
-        }
+    // 先标记为已执行: ensure块自身抛出的错误(比如变量还没赋值)不会再次进入ensure块
+    frame->exec_ensure_stmt = true;
 
-        // 执行当前指令
-        const Instruction& curr_inst = curr_frame->code_object->code[curr_frame->pc];
-        try {
-            execute_unit(curr_inst);
-        } catch (NativeFuncError& e) {
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
+    // 临时把ensure块换成帧的代码(连同位置表)执行, 执行完再换回来
+    size_t old_pc = frame->pc;
+    auto swap_code = [&] {
+        std::swap(code_object->code, code_object->ensure_stmts);
+        std::swap(code_object->pos_table, code_object->ensure_pos_table);
+    };
+    swap_code();
+    frame->pc = 0;
 
-        ADVANCE_PC
+    try {
+        run_until(call_stack.size() - 1);
+    } catch (...) {
+        swap_code();
+        frame->pc = old_pc;
+        throw;
     }
-    frame->code_object->code = old_code;
+    swap_code();
     frame->pc = old_pc;
-    frame->exec_ensure_stmt = true;
 }
 
 }
@@ -170,18 +170,14 @@ void Vm::handle_import(const std::string& module_path) {
         content = err::SrcManager::get_file_by_path(actually_found_path.string());
 #endif
     } else if (auto std_init_it = std_modules.find(module_path)) {
-        auto std_init_func = dynamic_cast<model::NativeFunction*>(std_init_it->value);
+        auto std_init_func = model::as<model::NativeFunction>(std_init_it->value);
         assert(std_init_func != nullptr);
 
-        model::List* args_list = new model::List({});
-        args_list->make_ref();
-        model::Object* return_val = std_init_func->func(std_init_func, args_list);
-        // 使用后释放临时参数列表
-        args_list->del_ref();
+        model::Object* return_val = std_init_func->call(std_init_func, nullptr, 0);
 
         assert(return_val != nullptr);
 
-        auto module_obj = dynamic_cast<model::Module*>(return_val);
+        auto module_obj = model::as<model::Module>(return_val);
         assert(module_obj != nullptr);
 
         push_to_stack(module_obj);
@@ -212,55 +208,18 @@ void Vm::handle_import(const std::string& module_path) {
 
     module_obj->make_ref();
     module_obj->code->make_ref();
-    auto new_frame = new CallFrame{
-        .name = module_path,
+    const size_t new_bp = op_stack.size();
 
-        .owner = module_obj,
-
-        .pc = 0,
-        .return_to_pc = module_obj->code->code.size() + 1,
-        .last_bp = call_stack.back()->bp,
-        .bp = op_stack.size(),
-        .code_object = module_obj->code,
-
-        .iters{},
-
-        .curr_error = nullptr,
-        .exec_ensure_stmt = false
-    };
+    // 与函数调用一样为模块的局部变量(和寄存器代码的临时寄存器)预留槽位, 否则SET_LOCAL会写到栈顶之外
+    op_stack.resize(op_stack.size() + module_obj->code->frame_size());
 
     size_t old_call_stack_size = call_stack.size();
 
-    call_stack.emplace_back(new_frame);
+    call_stack.push(module_obj, module_obj->code, module_obj->code->code.size() + 1, call_stack.back()->bp, new_bp);
 
 
     /// 执行新代码
-    while (running and !call_stack.empty()) {
-        auto curr_frame = call_stack.back();
-        auto frame_code = curr_frame->code_object;
-
-        // 检查是否执行到模块代码末尾：执行完毕则出栈
-        if (curr_frame->pc >= frame_code->code.size()) {
-            if (old_call_stack_size == call_stack.size() - 1) {
-                break;
-            }
-            call_stack.pop_back();
-            continue;
-        }
-
-        // 执行当前指令
-        const Instruction& curr_inst = frame_code->code[curr_frame->pc];
-        try {
-            execute_unit(curr_inst); // 调用VM的指令执行核心方法
-        } catch (const NativeFuncError& e) {
-            // 原生函数执行错误，抛出异常
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
-
-        ADVANCE_PC
-
-    }
+    run_until(old_call_stack_size);
 
     for (size_t i = call_stack.back()->bp; i < call_stack.back()->bp + call_stack.back()->code_object->locals_count; ++i) {
         const auto local_object = op_stack[i];
@@ -271,21 +230,14 @@ void Vm::handle_import(const std::string& module_path) {
     }
 
 
-    /// 处理delete frame
+    /// 弹出模块帧(槽位留给之后的调用复用)
     auto frame = call_stack.back();
     call_stack.pop_back();
     call_stack.back()->bp = frame->last_bp;
 
-    while (frame->bp < op_stack.size()) {
-        op_stack.back()->del_ref();
-        op_stack.pop_back();
-    }
-    frame->owner->del_ref();
-    frame->code_object->del_ref();
-    for (auto it: frame->iters) {
-        if (it) it->del_ref();
-    }
-    delete frame;
+    release_locals(frame);
+    op_stack.resize(frame->bp);
+    release_frame(frame);
 
     /// 储存module
     push_to_stack(module_obj);
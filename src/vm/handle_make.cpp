@@ -2,6 +2,8 @@
 #include "../models/models.hpp"
 #include "opcode/opcode.hpp"
 
+#include <algorithm>
+
 namespace kiz {
 
 // 辅助函数
@@ -10,15 +12,15 @@ auto Vm::make_pos_info() -> std::vector<std::pair<std::string, err::PositionInfo
     std::vector<std::pair<std::string, err::PositionInfo>> positions;
     std::string path;
     for (const auto& frame: call_stack) {
-        if (const auto m = dynamic_cast<model::Module*>(frame->owner)) {
+        if (const auto m = model::as<model::Module>(frame->owner)) {
             path = m->path;
         }
         err::PositionInfo pos{};
         bool is_last_frame = frame_index == call_stack.size() - 1;
         if (is_last_frame) {
-            pos = frame->code_object->code.at(frame->pc).pos;
+            pos = frame->code_object->pos_at(frame->pc);
         } else {
-            pos = frame->code_object->code.at(frame->pc - 1).pos;
+            pos = frame->code_object->pos_at(frame->pc - 1);
         }
         positions.emplace_back(path, pos);
         ++frame_index;
@@ -39,7 +41,7 @@ void Vm::make_list(size_t len) {
     }
     std::ranges::reverse(elem_list); // 恢复原序
 
-    auto list_obj = new model::List(elem_list);      // 内部为每个元素 make_ref
+    auto list_obj = model::create_list(elem_list);      // 内部为每个元素 make_ref
     push_to_stack(list_obj);
 }
 
@@ -50,29 +52,31 @@ void Vm::make_dict(size_t len) {
 
     std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
     elem_list.reserve(elem_count);
+    // 弹出的键值在字典持有它们之前要钉住: 计算哈希会回调脚本, 其间可能核对零计数表
+    std::vector<StackRef> popped;
+    popped.reserve(total_elems + elem_count);
 
     for (size_t i = 0; i < elem_count; ++i) {
-        auto value = simple_get_and_pop_stack_top(); // 弹出 value
-        auto key = simple_get_and_pop_stack_top();   // 弹出 key
-        value = copy_if_mutable(value);
+        auto& value = popped.emplace_back(get_and_pop_stack_top()); // 弹出 value
+        auto& key = popped.emplace_back(get_and_pop_stack_top());   // 弹出 key
+        auto stored_value = copy_if_mutable(value.get());
+        // 复制出的新对象还没有持有者, 同样钉住
+        if (stored_value != value.get()) {
+            popped.emplace_back(stored_value);
+        }
 
         // 计算哈希
-        call_method(key, "__hash__", {});
-        auto hash_obj = simple_get_and_pop_stack_top();
-        auto hashed_int = dynamic_cast<model::Int*>(hash_obj);
+        call_method(key.get(), model::magic_name::hash, {});
+        auto hash_obj = get_and_pop_stack_top();
+        auto hashed_int = model::as<model::Int>(hash_obj.get());
         if (!hashed_int) {
-            hash_obj->del_ref();
-            key->del_ref();
-            value->del_ref();
             throw NativeFuncError("TypeError", "__hash__ must return an integer");
         }
-        elem_list.emplace_back(hashed_int->val, std::pair{key, value});
-
-        hash_obj->del_ref();
-        key->del_ref();
-        value->del_ref();
+        elem_list.emplace_back(hashed_int->val, std::pair{key.get(), stored_value});
     }
 
+    // 栈上的键值对是倒序弹出的, 翻转后按源码顺序插入
+    std::ranges::reverse(elem_list);
     auto dict_obj = new model::Dictionary(dep::Dict(elem_list)); // 内部为 key/value make_ref
     push_to_stack(dict_obj);
 }
@@ -0,0 +1,468 @@
+/**
+ * @file run_loop.cpp
+ * @brief 虚拟机指令分派循环
+ * GCC/Clang 下使用 computed goto(直接线索化分派), 否则回退到 switch 分派,
+ * 由 CMake 选项 KIZ_COMPUTED_GOTO 控制
+ */
+
+#include "vm.hpp"
+#include "../models/models.hpp"
+#include "../models/gc.hpp"
+#include "../opcode/opcode.hpp"
+
+#if defined(KIZ_COMPUTED_GOTO) && (defined(__GNUC__) || defined(__clang__))
+#define KIZ_THREADED_DISPATCH 1
+#endif
+
+namespace kiz {
+
+void Vm::exec_curr_code() {
+    run_until(0);
+}
+
+void Vm::run_until(const size_t stop_depth) {
+    // 异常处理放在分派循环外: 热路径上不再逐条指令进入try块
+    while (call_stack.size() > stop_depth && running) {
+        try {
+            if (engine == Engine::Register) {
+                run_reg_loop(stop_depth);
+            } else {
+                run_loop(stop_depth);
+            }
+            return;
+        } catch (NativeFuncError& e) {
+            forward_to_handle_throw(e.name, e.msg);
+        }
+    }
+}
+
+void Vm::run_loop(const size_t stop_depth) {
+    // pc 与当前帧的代码保存在局部变量中, 只在需要时写回 frame->pc
+    CallFrame* frame = nullptr;
+    const Instruction* code = nullptr;
+    size_t code_len = 0;
+    size_t pc = 0;
+    const Instruction* inst = nullptr;
+    // 超级指令回退慢路径时, 重建出的被融合的第一条原指令
+    Instruction unfused(Opcode::STOP, {});
+
+#define LOAD_FRAME() \
+    do { \
+        frame = call_stack.back(); \
+        code = frame->code_object->code.data(); \
+        code_len = frame->code_object->code.size(); \
+        pc = frame->pc; \
+    } while (0)
+
+#define SAVE_PC() (frame->pc = pc)
+
+    // 局部变量尚未赋值: 按LOAD_VAR交给execute_unit报NameError
+#define UNBOUND_LOCAL(slot) \
+    do { \
+        unfused = Instruction(Opcode::LOAD_VAR, {(slot)}); \
+        inst = &unfused; \
+        goto op_generic; \
+    } while (0)
+
+#ifdef KIZ_THREADED_DISPATCH
+    static void* dispatch_table[256];
+    static bool dispatch_table_ready = false;
+    if (!dispatch_table_ready) {
+        // 没有专门快速处理的指令统一走 execute_unit
+        for (auto& target : dispatch_table) target = &&op_generic;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_VAR)] = &&op_LOAD_VAR;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_CONST)] = &&op_LOAD_CONST;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_BUILTINS)] = &&op_LOAD_BUILTINS;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_FOLDED)] = &&op_LOAD_FOLDED;
+        dispatch_table[static_cast<uint8_t>(Opcode::SET_LOCAL)] = &&op_SET_LOCAL;
+        dispatch_table[static_cast<uint8_t>(Opcode::SET_GLOBAL)] = &&op_SET_GLOBAL;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP)] = &&op_JUMP;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP_IF_FALSE)] = &&op_JUMP_IF_FALSE;
+        dispatch_table[static_cast<uint8_t>(Opcode::COPY_TOP)] = &&op_COPY_TOP;
+        dispatch_table[static_cast<uint8_t>(Opcode::POP_TOP)] = &&op_POP_TOP;
+        dispatch_table[static_cast<uint8_t>(Opcode::OP_IS)] = &&op_OP_IS;
+        for (const auto op : {Opcode::OP_ADD, Opcode::OP_SUB, Opcode::OP_MUL, Opcode::OP_DIV,
+                              Opcode::OP_MOD, Opcode::OP_POW, Opcode::OP_EQ, Opcode::OP_NE,
+                              Opcode::OP_LT, Opcode::OP_GT, Opcode::OP_LE, Opcode::OP_GE}) {
+            dispatch_table[static_cast<uint8_t>(op)] = &&op_binary;
+        }
+        dispatch_table[static_cast<uint8_t>(Opcode::OP_NEG)] = &&op_OP_NEG;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_VAR_LOAD_VAR)] = &&op_LOAD_VAR_LOAD_VAR;
+        dispatch_table[static_cast<uint8_t>(Opcode::LOAD_VAR_LOAD_CONST)] = &&op_LOAD_VAR_LOAD_CONST;
+        dispatch_table[static_cast<uint8_t>(Opcode::BINARY_VAR_VAR)] = &&op_BINARY_VAR_VAR;
+        dispatch_table[static_cast<uint8_t>(Opcode::BINARY_VAR_CONST)] = &&op_BINARY_VAR_CONST;
+        dispatch_table[static_cast<uint8_t>(Opcode::INC_LOCAL)] = &&op_INC_LOCAL;
+        dispatch_table[static_cast<uint8_t>(Opcode::COMPARE_JUMP_IF_FALSE)] = &&op_COMPARE_JUMP_IF_FALSE;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP_IF_FALSE_KEEP)] = &&op_JUMP_IF_FALSE_KEEP;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP_IF_TRUE_KEEP)] = &&op_JUMP_IF_TRUE_KEEP;
+        dispatch_table[static_cast<uint8_t>(Opcode::SET_LOCAL_JUMP_IF_FINISH_ITER)] = &&op_SET_LOCAL_JUMP_IF_FINISH_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::CACHE_ITER)] = &&op_CACHE_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::GET_ITER)] = &&op_GET_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::POP_ITER)] = &&op_POP_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP_IF_FINISH_ITER)] = &&op_JUMP_IF_FINISH_ITER;
+        dispatch_table_ready = true;
+    }
+
+#define TARGET(op) op_##op:
+#define DISPATCH() \
+    do { \
+        if (pc >= code_len) goto frame_end; \
+        inst = &code[pc]; \
+        goto *dispatch_table[static_cast<uint8_t>(inst->opc)]; \
+    } while (0)
+#else
+#define TARGET(op) case Opcode::op:
+#define DISPATCH() goto dispatch
+#endif
+
+    LOAD_FRAME();
+
+#ifdef KIZ_THREADED_DISPATCH
+    DISPATCH();
+#else
+dispatch:
+    if (pc >= code_len) goto frame_end;
+    inst = &code[pc];
+    switch (inst->opc) {
+#endif
+
+    TARGET(LOAD_VAR) {
+        model::Object* value = op_stack[frame->bp + inst->opn_list[0]];
+        if (!value) UNBOUND_LOCAL(inst->opn_list[0]);
+        push_to_stack(value);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(LOAD_CONST) {
+        push_to_stack(const_pool[inst->opn_list[0]]);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(LOAD_BUILTINS) {
+        push_to_stack(builtins[inst->opn_list[0]]);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(LOAD_FOLDED) {
+        // 内置运算被改写后折叠结果不再可信, 改为执行后面保留的原指令
+        if (builtin_ops_intact) {
+            push_to_stack(const_pool[inst->opn_list[0]]);
+            pc = inst->opn_list[1];
+        } else {
+            ++pc;
+        }
+        DISPATCH();
+    }
+
+    // 快速路径不会回调脚本, 也不经过安全点: 弹出的值直接借用, 不需要StackRef钉住
+    TARGET(SET_LOCAL) {
+        assign_slot(frame->bp + inst->opn_list[0], simple_get_and_pop_stack_top());
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(SET_GLOBAL) {
+        assign_slot(inst->opn_list[0], simple_get_and_pop_stack_top());
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(JUMP) {
+        pc = inst->opn_list[0];
+        // 循环里可能只有快速路径, 回跳也要作为安全点核对零计数表
+        if (model::DeferredRc::pending()) {
+            SAVE_PC();
+            model::CycleCollector::on_safe_point();
+        }
+        DISPATCH();
+    }
+
+    TARGET(JUMP_IF_FALSE) {
+        // 只处理Bool/Nil条件, 其余需要调用__bool__的交给execute_unit
+        if (op_stack.empty() or !op_stack.back()) goto op_generic;
+        const auto cond_type = op_stack.back()->get_type();
+        if (cond_type != model::Object::ObjectType::Bool
+            and cond_type != model::Object::ObjectType::Nil) {
+            goto op_generic;
+        }
+        {
+            const auto cond = simple_get_and_pop_stack_top();
+            const bool truthy = cond_type == model::Object::ObjectType::Bool
+                and model::as_unchecked<model::Bool>(cond)->val;
+            pc = truthy ? pc + 1 : inst->opn_list[0];
+        }
+        DISPATCH();
+    }
+
+    TARGET(COPY_TOP) {
+        push_to_stack(op_stack.back());
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(POP_TOP) {
+        simple_get_and_pop_stack_top();
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(OP_IS) {
+        {
+            const auto b = simple_get_and_pop_stack_top();
+            const auto a = simple_get_and_pop_stack_top();
+            push_to_stack(model::load_bool(a == b));
+        }
+        ++pc;
+        DISPATCH();
+    }
+
+#ifdef KIZ_THREADED_DISPATCH
+    op_binary:
+#else
+    case Opcode::OP_ADD: case Opcode::OP_SUB: case Opcode::OP_MUL: case Opcode::OP_DIV:
+    case Opcode::OP_MOD: case Opcode::OP_POW: case Opcode::OP_EQ: case Opcode::OP_NE:
+    case Opcode::OP_LT: case Opcode::OP_GT: case Opcode::OP_LE: case Opcode::OP_GE:
+#endif
+    {
+        // 内置类型直接计算, 其余(用户对象, 被改写的原型, 需要报错的情况)走call_method
+        const size_t stack_size = op_stack.size();
+        if (stack_size < 2) goto op_generic;
+        model::Object* result = try_fast_binary_op(
+            inst->opc, op_stack[stack_size - 2], op_stack[stack_size - 1]
+        );
+        if (!result) goto op_generic;
+        op_stack.resize(stack_size - 2);
+        push_to_stack(result);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(OP_NEG) {
+        if (op_stack.empty()) goto op_generic;
+        model::Object* result = try_fast_neg(op_stack.back());
+        if (!result) goto op_generic;
+        op_stack.pop_back();
+        push_to_stack(result);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(CACHE_ITER) {
+        auto iter = op_stack.back();
+        iter->make_ref();
+        frame->iters.push_back(iter);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(GET_ITER) {
+        push_to_stack(frame->iters.back());
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(POP_ITER) {
+        frame->iters.back()->del_ref();
+        frame->iters.pop_back();
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(JUMP_IF_FINISH_ITER) {
+        pc = simple_get_and_pop_stack_top() == model::stop_iter_signal ? inst->opn_list[0] : pc + 1;
+        DISPATCH();
+    }
+
+    // ---- 超级指令(见ir_gen/peephole.cpp): 序列中除第一条外的原指令都还在, 回退时只需完成第一条 ----
+
+    TARGET(LOAD_VAR_LOAD_VAR) {
+        model::Object* a = op_stack[frame->bp + inst->opn_list[0]];
+        model::Object* b = op_stack[frame->bp + inst->opn_list[1]];
+        if (!a) UNBOUND_LOCAL(inst->opn_list[0]);
+        if (!b) UNBOUND_LOCAL(inst->opn_list[1]);
+        push_to_stack(a);
+        push_to_stack(b);
+        pc += 2;
+        DISPATCH();
+    }
+
+    TARGET(LOAD_VAR_LOAD_CONST) {
+        model::Object* a = op_stack[frame->bp + inst->opn_list[0]];
+        if (!a) UNBOUND_LOCAL(inst->opn_list[0]);
+        push_to_stack(a);
+        push_to_stack(const_pool[inst->opn_list[1]]);
+        pc += 2;
+        DISPATCH();
+    }
+
+    TARGET(BINARY_VAR_VAR) {
+        model::Object* a = op_stack[frame->bp + inst->opn_list[0]];
+        model::Object* b = op_stack[frame->bp + inst->opn_list[1]];
+        if (!a) UNBOUND_LOCAL(inst->opn_list[0]);
+        if (!b) UNBOUND_LOCAL(inst->opn_list[1]);
+        model::Object* result = try_fast_binary_op(static_cast<Opcode>(inst->opn_list[2]), a, b);
+        if (!result) {
+            // 只做两次加载, 运算交给保留的原指令
+            push_to_stack(a);
+            push_to_stack(b);
+            pc += 2;
+            DISPATCH();
+        }
+        push_to_stack(result);
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(BINARY_VAR_CONST) {
+        model::Object* a = op_stack[frame->bp + inst->opn_list[0]];
+        model::Object* b = const_pool[inst->opn_list[1]];
+        if (!a) UNBOUND_LOCAL(inst->opn_list[0]);
+        model::Object* result = try_fast_binary_op(static_cast<Opcode>(inst->opn_list[2]), a, b);
+        if (!result) {
+            push_to_stack(a);
+            push_to_stack(b);
+            pc += 2;
+            DISPATCH();
+        }
+        push_to_stack(result);
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(INC_LOCAL) {
+        const size_t offset = frame->bp + inst->opn_list[0];
+        model::Object* local = op_stack[offset];
+        model::Object* step = const_pool[inst->opn_list[1]];
+        if (!local) UNBOUND_LOCAL(inst->opn_list[0]);
+        // 超出小整数池的计数器: 只被这个槽位持有的Int直接原地累加, 不再每次新建对象
+        if (builtin_ops_intact and local->get_type() == model::Object::ObjectType::Int
+            and local->is_exclusively_owned()) {
+            model::as_unchecked<model::Int>(local)->val += model::as_unchecked<model::Int>(step)->val;
+            pc += 4;
+            DISPATCH();
+        }
+        model::Object* result = try_fast_binary_op(Opcode::OP_ADD, local, step);
+        if (!result) {
+            push_to_stack(local);
+            ++pc;
+            DISPATCH();
+        }
+        // 结果是Int或Decimal, 不需要copy_if_mutable
+        result->make_ref();
+        local->del_ref();
+        op_stack[offset] = result;
+        pc += 4;
+        DISPATCH();
+    }
+
+    TARGET(COMPARE_JUMP_IF_FALSE) {
+        const auto cmp_opc = static_cast<Opcode>(inst->opn_list[0]);
+        const size_t stack_size = op_stack.size();
+        model::Object* result = stack_size < 2 ? nullptr : try_fast_binary_op(
+            cmp_opc, op_stack[stack_size - 2], op_stack[stack_size - 1]
+        );
+        if (!result) {
+            // 比较走慢路径, 之后落到保留的JUMP_IF_FALSE上
+            unfused = Instruction(cmp_opc, {});
+            inst = &unfused;
+            goto op_generic;
+        }
+        op_stack.resize(stack_size - 2);
+        // 比较的快速路径总是返回Bool
+        pc = model::as_unchecked<model::Bool>(result)->val ? pc + 2 : inst->opn_list[1];
+        DISPATCH();
+    }
+
+    TARGET(JUMP_IF_FALSE_KEEP) {
+        // and: 条件为假时保留栈顶并跳转, 否则弹出栈顶并跳过保留的POP_TOP
+        model::Object* top = op_stack.empty() ? nullptr : op_stack.back();
+        const auto top_type = top ? top->get_type() : model::Object::ObjectType::Object;
+        if (top_type != model::Object::ObjectType::Bool and top_type != model::Object::ObjectType::Nil) {
+            // 需要调用__bool__, 只做COPY_TOP
+            push_to_stack(top);
+            ++pc;
+            DISPATCH();
+        }
+        const bool truthy = top_type == model::Object::ObjectType::Bool
+            and model::as_unchecked<model::Bool>(top)->val;
+        if (!truthy) {
+            pc = inst->opn_list[0];
+            DISPATCH();
+        }
+        simple_get_and_pop_stack_top();
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(JUMP_IF_TRUE_KEEP) {
+        // or: 条件为真时保留栈顶并跳转, 否则弹出栈顶并跳过保留的POP_TOP
+        model::Object* top = op_stack.empty() ? nullptr : op_stack.back();
+        const auto top_type = top ? top->get_type() : model::Object::ObjectType::Object;
+        if (top_type != model::Object::ObjectType::Bool and top_type != model::Object::ObjectType::Nil) {
+            push_to_stack(top);
+            ++pc;
+            DISPATCH();
+        }
+        const bool truthy = top_type == model::Object::ObjectType::Bool
+            and model::as_unchecked<model::Bool>(top)->val;
+        if (truthy) {
+            pc = inst->opn_list[0];
+            DISPATCH();
+        }
+        simple_get_and_pop_stack_top();
+        pc += 4;
+        DISPATCH();
+    }
+
+    TARGET(SET_LOCAL_JUMP_IF_FINISH_ITER) {
+        const bool finished = assign_slot(frame->bp + inst->opn_list[0], simple_get_and_pop_stack_top())
+            == model::stop_iter_signal;
+        pc = finished ? inst->opn_list[1] : pc + 3;
+        DISPATCH();
+    }
+
+#ifndef KIZ_THREADED_DISPATCH
+    default:
+        break;
+    }
+#endif
+
+op_generic: {
+        // 慢路径: 可能调用函数, 切换帧或抛出异常, 前后都要同步pc
+        SAVE_PC();
+        const Opcode opc = inst->opc;
+        execute_unit(*inst);
+        if (opc != Opcode::JUMP
+            and opc != Opcode::JUMP_IF_FALSE
+            and opc != Opcode::RET
+            and opc != Opcode::TAIL_CALL
+            and opc != Opcode::THROW
+            and opc != Opcode::JUMP_IF_FINISH_ITER) {
+            frame->pc++;
+        }
+        // 指令边界是安全点: 此时没有处理器还持有弹出后没有钉住的借用值, 可以核对零计数表和做循环回收
+        model::CycleCollector::on_safe_point();
+        if (call_stack.size() <= stop_depth or !running) return;
+        LOAD_FRAME();
+        DISPATCH();
+    }
+
+frame_end:
+    // 最底层的帧(模块帧/ensure块)执行完毕则退出循环, 由调用者负责清理; 其余帧直接弹出
+    SAVE_PC();
+    if (call_stack.size() <= stop_depth + 1) return;
+    call_stack.pop_back();
+    LOAD_FRAME();
+    DISPATCH();
+
+#undef LOAD_FRAME
+#undef SAVE_PC
+#undef UNBOUND_LOCAL
+#undef TARGET
+#undef DISPATCH
+}
+
+} // namespace kiz
@@ -0,0 +1,560 @@
+/**
+ * @file run_reg_loop.cpp
+ * @brief 寄存器引擎(--vm=register)的指令分派循环
+ * 执行寄存器后端(ir_gen/reg_gen.cpp)生成的代码: 指令直接读写当前帧在op_stack上的槽位
+ * [bp, bp + frame_size), 帧之上不再堆放临时值. 与栈式引擎共用CodeObject, CallFrame,
+ * 调用/返回/异常处理和内置对象; 没有快速路径的运算把操作数临时压到帧之上,
+ * 交给execute_unit里对应的栈指令完成, 再把结果取回目的寄存器.
+ * 分派方式与run_loop.cpp相同, 由 CMake 选项 KIZ_COMPUTED_GOTO 控制
+ */
+
+#include "vm.hpp"
+#include "../models/models.hpp"
+#include "../models/gc.hpp"
+#include "../opcode/opcode.hpp"
+
+#if defined(KIZ_COMPUTED_GOTO) && (defined(__GNUC__) || defined(__clang__))
+#define KIZ_THREADED_DISPATCH 1
+#endif
+
+namespace kiz {
+
+namespace {
+
+// 把op_stack调整为size项, 不足的补空槽位. 只用来截掉局部变量之后的临时寄存器和参数, 它们是借用的
+void fit_stack(const size_t size) {
+    Vm::op_stack.resize(size, nullptr);
+}
+
+// 写入寄存器: 局部变量持有计数引用, 先持有新值再释放旧值(新值可能只被旧值引用), copy时按赋值语义复制可变对象;
+// 临时寄存器和操作数栈一样只借用
+void store_reg(const size_t offset, model::Object* value, const bool copy, const bool counted) {
+    if (!counted) {
+        value->note_borrowed();
+        Vm::op_stack[offset] = value;
+        return;
+    }
+    model::Object* stored = copy ? model::copy_if_mutable(value) : value;
+    stored->make_ref();
+    model::Object* old = Vm::op_stack[offset];
+    Vm::op_stack[offset] = stored;
+    if (old) old->del_ref();
+}
+
+// 读取源操作数: 常量池下标或当前帧的槽位, 只有局部变量可能尚未赋值
+model::Object* load_operand(CallFrame* frame, const size_t pc, const uint32_t opnd) {
+    if (opnd & Instruction::const_operand_bit) {
+        return Vm::const_pool[opnd & ~Instruction::const_operand_bit];
+    }
+    model::Object* value = Vm::op_stack[frame->bp + opnd];
+    if (!value) {
+        frame->pc = pc;
+        throw NativeFuncError("NameError",
+            "Undefined var '" + frame->code_object->var_names[opnd] + "'"
+        );
+    }
+    return value;
+}
+
+bool has_fast_path(const Opcode opc) {
+    return opc != Opcode::OP_IN and opc != Opcode::IS_CHILD and opc != Opcode::GET_ITEM;
+}
+
+} // namespace
+
+void Vm::run_reg_loop(const size_t stop_depth) {
+    CallFrame* frame = nullptr;
+    const Instruction* code = nullptr;
+    size_t code_len = 0;
+    size_t locals_count = 0;
+    size_t frame_size = 0;
+    size_t pc = 0;
+    const Instruction* inst = nullptr;
+
+#define LOAD_FRAME() \
+    do { \
+        frame = call_stack.back(); \
+        code = frame->code_object->code.data(); \
+        code_len = frame->code_object->code.size(); \
+        locals_count = frame->code_object->locals_count; \
+        frame_size = frame->code_object->frame_size(); \
+        pc = frame->pc; \
+    } while (0)
+
+#define SAVE_PC() (frame->pc = pc)
+#define OPERAND(n) load_operand(frame, pc, inst->opn_list[n])
+    // 目的寄存器是局部变量时按赋值语义存入, 临时寄存器和新建的对象直接存入
+#define STORE(reg, value) store_reg(frame->bp + (reg), (value), (reg) < locals_count, (reg) < locals_count)
+#define STORE_FRESH(reg, value) store_reg(frame->bp + (reg), (value), false, (reg) < locals_count)
+
+#ifdef KIZ_THREADED_DISPATCH
+    static void* dispatch_table[256];
+    static bool dispatch_table_ready = false;
+    if (!dispatch_table_ready) {
+        for (auto& target : dispatch_table) target = &&op_unknown;
+        dispatch_table[static_cast<uint8_t>(Opcode::JUMP)] = &&op_JUMP;
+        dispatch_table[static_cast<uint8_t>(Opcode::POP_ITER)] = &&op_POP_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_MOVE)] = &&op_REG_MOVE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_LOAD_FREE)] = &&op_REG_LOAD_FREE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_LOAD_FOLDED)] = &&op_REG_LOAD_FOLDED;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_LOAD_ITER)] = &&op_REG_LOAD_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_LOAD_ERROR)] = &&op_REG_LOAD_ERROR;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_BINARY)] = &&op_REG_BINARY;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_UNARY)] = &&op_REG_UNARY;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_COMPARE_JUMP_IF_FALSE)] = &&op_REG_COMPARE_JUMP_IF_FALSE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_JUMP_IF_FALSE)] = &&op_REG_JUMP_IF_FALSE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_JUMP_IF_TRUE)] = &&op_REG_JUMP_IF_TRUE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_JUMP_IF_FINISH_ITER)] = &&op_REG_JUMP_IF_FINISH_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_CACHE_ITER)] = &&op_REG_CACHE_ITER;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_CALL)] = &&op_REG_CALL;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_TAIL_CALL)] = &&op_REG_TAIL_CALL;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_CALL_METHOD)] = &&op_REG_CALL_METHOD;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_RET)] = &&op_REG_RET;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_GET_ATTR)] = &&op_REG_GET_ATTR;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_SET_ATTR)] = &&op_REG_SET_ATTR;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_SET_ITEM)] = &&op_REG_SET_ITEM;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_MAKE_LIST)] = &&op_REG_MAKE_LIST;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_MAKE_DICT)] = &&op_REG_MAKE_DICT;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_CLOSURE)] = &&op_REG_CLOSURE;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_CREATE_OBJECT)] = &&op_REG_CREATE_OBJECT;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_IMPORT)] = &&op_REG_IMPORT;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_THROW)] = &&op_REG_THROW;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_SET_GLOBAL)] = &&op_REG_SET_GLOBAL;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_SET_NONLOCAL)] = &&op_REG_SET_NONLOCAL;
+        dispatch_table[static_cast<uint8_t>(Opcode::REG_PUSH)] = &&op_REG_PUSH;
+        dispatch_table_ready = true;
+    }
+
+#define TARGET(op) op_##op:
+#define DISPATCH() \
+    do { \
+        if (pc >= code_len) goto frame_end; \
+        inst = &code[pc]; \
+        goto *dispatch_table[static_cast<uint8_t>(inst->opc)]; \
+    } while (0)
+#else
+#define TARGET(op) case Opcode::op:
+#define DISPATCH() goto dispatch
+#endif
+
+    LOAD_FRAME();
+
+#ifdef KIZ_THREADED_DISPATCH
+    DISPATCH();
+#else
+dispatch:
+    if (pc >= code_len) goto frame_end;
+    inst = &code[pc];
+    switch (inst->opc) {
+#endif
+
+    TARGET(REG_MOVE) {
+        STORE(inst->opn_list[0], OPERAND(1));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_LOAD_FREE) {
+        const auto func = model::as<model::Function>(frame->owner);
+        assert(func != nullptr);
+        model::Object* value = func->free_vars[inst->opn_list[1]];
+        if (!value) {
+            SAVE_PC();
+            throw NativeFuncError("NameError",
+                "Undefined var '" + func->code->free_names[inst->opn_list[1]] + "'"
+            );
+        }
+        STORE(inst->opn_list[0], value);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_LOAD_FOLDED) {
+        // 内置运算被改写后折叠结果不再可信, 改为执行后面保留的原指令
+        if (builtin_ops_intact) {
+            STORE_FRESH(inst->opn_list[0], const_pool[inst->opn_list[1]]);
+            pc = inst->opn_list[2];
+        } else {
+            ++pc;
+        }
+        DISPATCH();
+    }
+
+    TARGET(REG_LOAD_ITER) {
+        STORE_FRESH(inst->opn_list[0], frame->iters.back());
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_LOAD_ERROR) {
+        // catch块的入口: 抛出错误时帧之上可能还留着被打断的运算压入的操作数, 在这里统一清理
+        if (!frame->curr_error) {
+            throw KizStopRunningSignal("Unable to load error");
+        }
+        fit_stack(frame->bp + frame_size);
+        STORE(inst->opn_list[0], frame->curr_error);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_BINARY) {
+        {
+            model::Object* a = OPERAND(1);
+            model::Object* b = OPERAND(2);
+            const Opcode op = inst->sub_opc;
+            if (op == Opcode::OP_IS) {
+                STORE_FRESH(inst->opn_list[0], model::load_bool(a == b));
+                ++pc;
+                DISPATCH();
+            }
+            // i = i + n: 只被这个局部变量持有的Int直接原地累加, 不再每次新建对象.
+            // 临时寄存器只是借用, 计数不能说明它没有别的持有者
+            if (op == Opcode::OP_ADD and builtin_ops_intact and inst->opn_list[0] < locals_count
+                and inst->opn_list[0] == inst->opn_list[1] and inst->opn_list[0] != inst->opn_list[2]
+                and a->get_type() == model::Object::ObjectType::Int and a->is_exclusively_owned()
+                and b->get_type() == model::Object::ObjectType::Int) {
+                model::as_unchecked<model::Int>(a)->val += model::as_unchecked<model::Int>(b)->val;
+                ++pc;
+                DISPATCH();
+            }
+            if (has_fast_path(op)) {
+                if (model::Object* result = try_fast_binary_op(op, a, b)) {
+                    STORE_FRESH(inst->opn_list[0], result);
+                    ++pc;
+                    DISPATCH();
+                }
+            }
+        }
+        // 慢路径: 操作数压到帧之上, 由execute_unit按栈指令完成
+        SAVE_PC();
+        {
+            push_to_stack(OPERAND(1));
+            push_to_stack(OPERAND(2));
+            execute_unit(Instruction(inst->sub_opc, {}));
+            model::Object* result = simple_get_and_pop_stack_top();
+            STORE(inst->opn_list[0], result);
+        }
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_UNARY) {
+        {
+            model::Object* operand = OPERAND(1);
+            const auto type = operand->get_type();
+            if (inst->sub_opc == Opcode::OP_NOT
+                and (type == model::Object::ObjectType::Bool or type == model::Object::ObjectType::Nil)) {
+                const bool truthy = type == model::Object::ObjectType::Bool
+                    and model::as_unchecked<model::Bool>(operand)->val;
+                STORE_FRESH(inst->opn_list[0], model::load_bool(!truthy));
+                ++pc;
+                DISPATCH();
+            }
+            if (inst->sub_opc == Opcode::OP_NEG) {
+                if (model::Object* result = try_fast_neg(operand)) {
+                    STORE_FRESH(inst->opn_list[0], result);
+                    ++pc;
+                    DISPATCH();
+                }
+            }
+        }
+        SAVE_PC();
+        {
+            push_to_stack(OPERAND(1));
+            execute_unit(Instruction(inst->sub_opc, {}));
+            model::Object* result = simple_get_and_pop_stack_top();
+            STORE(inst->opn_list[0], result);
+        }
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_COMPARE_JUMP_IF_FALSE) {
+        if (model::Object* result = try_fast_binary_op(inst->sub_opc, OPERAND(0), OPERAND(1))) {
+            // 比较的快速路径总是返回Bool
+            pc = model::as_unchecked<model::Bool>(result)->val ? pc + 1 : inst->opn_list[2];
+            DISPATCH();
+        }
+        SAVE_PC();
+        {
+            push_to_stack(OPERAND(0));
+            push_to_stack(OPERAND(1));
+            execute_unit(Instruction(inst->sub_opc, {}));
+            const auto result = get_and_pop_stack_top();
+            frame->pc = is_true(result.get()) ? pc + 1 : inst->opn_list[2];
+        }
+        goto after_slow;
+    }
+
+    TARGET(REG_JUMP_IF_FALSE)
+    TARGET(REG_JUMP_IF_TRUE) {
+        const bool jump_if = inst->opc == Opcode::REG_JUMP_IF_TRUE;
+        model::Object* cond = OPERAND(0);
+        const auto type = cond->get_type();
+        if (type == model::Object::ObjectType::Bool or type == model::Object::ObjectType::Nil) {
+            const bool truthy = type == model::Object::ObjectType::Bool
+                and model::as_unchecked<model::Bool>(cond)->val;
+            pc = truthy == jump_if ? inst->opn_list[1] : pc + 1;
+            DISPATCH();
+        }
+        // 需要调用__bool__: 调用期间由这里钉住条件对象
+        SAVE_PC();
+        {
+            const StackRef held(cond);
+            frame->pc = is_true(cond) == jump_if ? inst->opn_list[1] : pc + 1;
+        }
+        goto after_slow;
+    }
+
+    TARGET(REG_JUMP_IF_FINISH_ITER) {
+        pc = OPERAND(0) == model::stop_iter_signal ? inst->opn_list[1] : pc + 1;
+        DISPATCH();
+    }
+
+    TARGET(REG_CACHE_ITER) {
+        model::Object* iter = OPERAND(0);
+        iter->make_ref();
+        frame->iters.push_back(iter);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(POP_ITER) {
+        frame->iters.back()->del_ref();
+        frame->iters.pop_back();
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(JUMP) {
+        pc = inst->opn_list[0];
+        // 循环里可能只有快速路径, 回跳也要作为安全点核对零计数表
+        if (model::DeferredRc::pending()) {
+            SAVE_PC();
+            model::CycleCollector::on_safe_point();
+        }
+        DISPATCH();
+    }
+
+    // 调用: 参数在从a开始的argc个临时寄存器里, 其上的临时寄存器已经不再使用,
+    // 截掉之后参数正好在栈顶, 由handle_call原地取用; 返回值落在寄存器a
+    TARGET(REG_CALL) {
+        SAVE_PC();
+        {
+            model::Object* func = OPERAND(2);
+            const StackRef held(func);
+            fit_stack(frame->bp + inst->opn_list[0] + inst->opn_list[1]);
+            handle_call(func, inst->opn_list[1], nullptr);
+        }
+        // 原生函数已经返回: 补齐当前帧的临时寄存器; 否则新帧返回时由REG_RET补齐
+        if (call_stack.back() == frame) fit_stack(frame->bp + frame_size);
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_CALL_METHOD) {
+        SAVE_PC();
+        {
+            // 调用对象紧跟在参数之后
+            const size_t argc = inst->opn_list[1];
+            model::Object* obj = op_stack[frame->bp + inst->opn_list[0] + argc];
+            const StackRef held(obj);
+            model::Object* method = get_attr_cached(obj, get_attr_name_by_idx(inst->aux), inst->opn_list[2]);
+            fit_stack(frame->bp + inst->opn_list[0] + argc);
+            handle_call(method, argc, obj);
+        }
+        if (call_stack.back() == frame) fit_stack(frame->bp + frame_size);
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_TAIL_CALL) {
+        SAVE_PC();
+        {
+            model::Object* func = OPERAND(2);
+            const StackRef held(func);
+            fit_stack(frame->bp + inst->opn_list[0] + inst->opn_list[1]);
+            handle_tail_call(func, inst->opn_list[1]);
+        }
+        // 复用了当前帧(pc已置0)或者退化为原生函数调用(pc已指向保留的REG_RET): 按帧现在的代码补齐寄存器
+        if (call_stack.back() == frame) fit_stack(frame->bp + frame->code_object->frame_size());
+        goto after_slow;
+    }
+
+    TARGET(REG_RET) {
+        SAVE_PC();
+        {
+            model::Object* value = OPERAND(0);
+            const StackRef return_val(value);
+
+            // 执行ensure确保资源被释放
+            handle_ensure();
+
+            const auto callee = call_stack.back();
+            call_stack.pop_back();
+            const auto caller = call_stack.back();
+            caller->bp = callee->last_bp;
+            caller->pc = callee->return_to_pc;
+
+            // 返回值落在调用者的寄存器a上(即被调用帧的bp)
+            release_locals(callee);
+            fit_stack(callee->bp);
+            push_to_stack(value);
+            release_frame(callee);
+            // 原生函数调用的帧: 返回值留在栈顶交给原生函数
+            if (!callee->called_from_native) {
+                fit_stack(caller->bp + caller->code_object->frame_size());
+            }
+        }
+        goto after_slow;
+    }
+
+    TARGET(REG_GET_ATTR) {
+        SAVE_PC();
+        model::Object* attr = get_attr_cached(OPERAND(1), get_attr_name_by_idx(inst->aux), inst->opn_list[2]);
+        STORE(inst->opn_list[0], attr);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_SET_ATTR) {
+        SAVE_PC();
+        push_to_stack(OPERAND(0));
+        push_to_stack(OPERAND(1));
+        execute_unit(Instruction(Opcode::SET_ATTR, {inst->opn_list[2]}));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_SET_ITEM) {
+        SAVE_PC();
+        push_to_stack(OPERAND(0));
+        push_to_stack(OPERAND(1));
+        push_to_stack(OPERAND(2));
+        execute_unit(Instruction(Opcode::SET_ITEM, {}));
+        // 丢弃__setitem__的返回值
+        fit_stack(frame->bp + frame_size);
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_MAKE_LIST) {
+        const auto list = model::create_list(op_stack.data() + frame->bp + inst->opn_list[1], inst->opn_list[2]);
+        STORE_FRESH(inst->opn_list[0], list);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_MAKE_DICT) {
+        SAVE_PC();
+        {
+            const size_t first = frame->bp + inst->opn_list[1];
+            for (size_t i = 0; i < 2 * inst->opn_list[2]; ++i) push_to_stack(op_stack[first + i]);
+            make_dict(inst->opn_list[2]);
+            model::Object* dict = simple_get_and_pop_stack_top();
+            STORE_FRESH(inst->opn_list[0], dict);
+        }
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_CLOSURE) {
+        SAVE_PC();
+        {
+            // 没有捕获变量的函数直接使用常量池里的模板
+            push_to_stack(OPERAND(1));
+            execute_unit(Instruction(Opcode::CREATE_CLOSURE, {}));
+            model::Object* func = simple_get_and_pop_stack_top();
+            STORE(inst->opn_list[0], func);
+        }
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_CREATE_OBJECT) {
+        const auto obj = new model::Object();
+        obj->attrs_insert(model::magic_name::parent, model::based_obj);
+        STORE_FRESH(inst->opn_list[0], obj);
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_IMPORT) {
+        SAVE_PC();
+        {
+            execute_unit(Instruction(Opcode::IMPORT, {inst->opn_list[1]}));
+            model::Object* module = simple_get_and_pop_stack_top();
+            STORE(inst->opn_list[0], module);
+        }
+        frame->pc = pc + 1;
+        goto after_slow;
+    }
+
+    TARGET(REG_THROW) {
+        SAVE_PC();
+        {
+            model::Object* error = OPERAND(0);
+            error->make_ref();
+            if (frame->curr_error) frame->curr_error->del_ref();
+            frame->curr_error = error;
+            handle_throw();
+        }
+        goto after_slow;
+    }
+
+    TARGET(REG_SET_GLOBAL) {
+        SAVE_PC();
+        assign_slot(inst->opn_list[0], OPERAND(1));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_SET_NONLOCAL) {
+        SAVE_PC();
+        push_to_stack(OPERAND(1));
+        execute_unit(Instruction(Opcode::SET_NONLOCAL, {inst->opn_list[0]}));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(REG_PUSH) {
+        push_to_stack(OPERAND(0));
+        ++pc;
+        DISPATCH();
+    }
+
+#ifndef KIZ_THREADED_DISPATCH
+    default:
+        goto op_unknown;
+    }
+#endif
+
+op_unknown:
+    SAVE_PC();
+    throw KizStopRunningSignal("register engine meets non-register opcode " + opcode_to_string(inst->opc));
+
+after_slow:
+    // 慢路径已经把下一条指令写回frame->pc; 指令边界是安全点, 可以核对零计数表和做循环回收
+    model::CycleCollector::on_safe_point();
+    if (call_stack.size() <= stop_depth or !running) return;
+    LOAD_FRAME();
+    DISPATCH();
+
+frame_end:
+    // 最底层的帧(模块帧/ensure块)执行完毕则退出循环, 由调用者负责清理; 其余帧直接弹出
+    SAVE_PC();
+    if (call_stack.size() <= stop_depth + 1) return;
+    call_stack.pop_back();
+    LOAD_FRAME();
+    DISPATCH();
+
+#undef LOAD_FRAME
+#undef SAVE_PC
+#undef OPERAND
+#undef STORE
+#undef STORE_FRESH
+#undef TARGET
+#undef DISPATCH
+}
+
+} // namespace kiz
@@ -9,6 +9,7 @@
 #include "vm.hpp"
 
 #include "../models/models.hpp"
+#include "../models/gc.hpp"
 #include "../opcode/opcode.hpp"
 
 #include <algorithm>
@@ -27,14 +28,26 @@ std::vector<std::string> Vm::builtin_names {};
 dep::HashMap<model::Module*> Vm::modules_cache {};
 model::Module* Vm::main_module;
 std::vector<model::Object*> Vm::op_stack {};
-std::vector<CallFrame*> Vm::call_stack {};
-model::Int* Vm::small_int_pool[201] {};
+FrameStack Vm::call_stack {};
+std::vector<model::Object*> Vm::pinned {};
+model::Int* Vm::small_int_pool[small_int_max - small_int_min + 1] {};
 bool Vm::running = false;
+Vm::Engine Vm::engine = Vm::Engine::Stack;
+bool Vm::builtin_ops_intact = true;
 std::string Vm::main_file_path;
 std::vector<model::Object*> Vm::const_pool {};
 dep::HashMap<model::Object*> Vm::std_modules {};
 
-StackRef::~StackRef() { if (obj) obj->del_ref(); }
+StackRef::StackRef(model::Object* o) : obj(o), pin_index(Vm::pinned.size()) {
+    if (obj) obj->note_borrowed();
+    Vm::pinned.push_back(obj);
+}
+
+StackRef::~StackRef() {
+    if (pin_index == unpinned) return;
+    Vm::pinned[pin_index] = nullptr;
+    while (!Vm::pinned.empty() and !Vm::pinned.back()) Vm::pinned.pop_back();
+}
 
 Vm::Vm(const std::string& file_path_) {
     main_file_path = file_path_;
@@ -60,10 +73,10 @@ Vm::Vm(const std::string& file_path_) {
     model::based_code_object->mark_as_important();
     model::based_range->mark_as_important();
 
-    for (dep::BigInt i = 0; i < 201; i+= 1) {
-        auto int_obj = new model::Int{i};
+    for (long long i = small_int_min; i <= small_int_max; ++i) {
+        auto int_obj = new model::Int(dep::BigInt::from_long_long(i));
         int_obj->mark_as_important();
-        small_int_pool[i.to_unsigned_long_long()] = int_obj;
+        small_int_pool[i - small_int_min] = int_obj;
     }
     entry_builtins();
     entry_std_modules();
@@ -79,28 +92,11 @@ void Vm::set_main_module(model::Module* src_module) {
     src_module->make_ref();
 
     // 创建模块级调用帧（CallFrame）：模块是顶层执行单元，对应一个顶层调用帧
-    op_stack.resize(src_module->code->locals_count);
+    op_stack.resize(src_module->code->frame_size());
     src_module->make_ref(); // owner
     src_module->code->make_ref();
-    auto module_call_frame = new CallFrame{
-        .name = src_module->path,
-
-        .owner = src_module,
-
-        .pc = 0,
-        .return_to_pc = src_module->code->code.size(),
-        .last_bp = 0,
-        .bp = 0,
-        .code_object = src_module->code,
-
-        .iters{},
-
-        .curr_error = nullptr,
-        .exec_ensure_stmt = false
-    };
-
     // 将调用帧压入VM的调用栈
-    call_stack.emplace_back(module_call_frame);
+    call_stack.push(src_module, src_module->code, src_module->code->code.size(), 0, 0);
 
     // 初始化VM执行状态：标记为"就绪"
     running = true; // 标记VM为运行状态（等待exec触发执行）
@@ -109,52 +105,10 @@ void Vm::set_main_module(model::Module* src_module) {
     // handle_ensure();
 }
 
-void Vm::exec_curr_code() {
-    // 循环执行当前调用帧下的所有指令
-    while (!call_stack.empty() && running) {
-        auto curr_frame = call_stack.back();
-        // 检查当前帧是否执行完毕
-        if (curr_frame->pc >= curr_frame->code_object->code.size()) {
-            // 非模块帧则弹出，模块帧则退出循环
-            if (call_stack.size() == 1) {
-                break;
-            }
-            call_stack.pop_back();;
-            continue;
-        }
-
-        // 执行当前指令
-        const Instruction& curr_inst = curr_frame->code_object->code[curr_frame->pc];
-        try {
-            // std::cout << "current instr: " << opcode_to_string(curr_inst.opc) << std::endl;
-            // std::cout << "Stack:" << std::endl;
-            // size_t j = 0;
-            // for (auto st_mem: op_stack) {
-            //     if (st_mem)
-            //         std::cout << j << ": " << st_mem->debug_string() << std::endl;
-            //     else
-            //         std::cout << j << ": " << "<nullptr>" << std::endl;
-            //     ++j;
-            // }
-            // std::cout << "==End==" << std::endl;
-            execute_unit(curr_inst);
-            // std::cout << "finish handle instr: " << opcode_to_string(curr_inst.opc) << std::endl;
-            // std::cout << "Stack:" << std::endl;
-            // j = 0;
-            // for (auto st_mem: op_stack) {
-            //     if (st_mem)
-            //         std::cout << j << ": " << st_mem->debug_string() << std::endl;
-            //     else
-            //         std::cout << j << ": " << "<nullptr>" << std::endl;
-            //     ++j;
-            // }
-            // std::cout << "==End==" << std::endl;
-        } catch (NativeFuncError& e) {
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
-        ADVANCE_PC
-    }
+std::string_view CallFrame::name() const {
+    if (const auto func = model::as<model::Function>(owner)) return func->name;
+    if (const auto m = model::as<model::Module>(owner)) return m->path;
+    return "<frame>";
 }
 
 CallFrame* Vm::get_frame() {
@@ -183,10 +137,39 @@ model::Object* Vm::simple_get_and_pop_stack_top() {
 
 void Vm::push_to_stack(model::Object* obj) {
     if (obj == nullptr) return;
-    obj->make_ref(); // 栈成为新持有者，增加引用计数
+    obj->note_borrowed(); // 栈只借用对象, 不增加引用计数
     op_stack.push_back(obj);
 }
 
+model::Object* Vm::assign_slot(const size_t offset, model::Object* value) {
+    auto new_val = model::copy_if_mutable(value);
+    new_val->make_ref();
+    if (op_stack[offset]) {
+        op_stack[offset]->del_ref();
+    }
+    op_stack[offset] = new_val;
+    return new_val;
+}
+
+void Vm::release_locals(const CallFrame* frame) {
+    const size_t end = std::min(op_stack.size(), frame->bp + frame->code_object->locals_count);
+    for (size_t i = frame->bp; i < end; ++i) {
+        if (op_stack[i]) op_stack[i]->del_ref();
+        op_stack[i] = nullptr;
+    }
+}
+
+void Vm::release_frame(CallFrame* frame) {
+    frame->owner->del_ref();
+    frame->code_object->del_ref();
+    for (const auto it : frame->iters) {
+        if (it) it->del_ref();
+    }
+    frame->iters.clear();
+    if (frame->curr_error) frame->curr_error->del_ref();
+    frame->curr_error = nullptr;
+}
+
 void Vm::reset_global_code(model::CodeObject* code_object) {
     assert(code_object != nullptr);
     assert(!call_stack.empty());
@@ -194,6 +177,10 @@ void Vm::reset_global_code(model::CodeObject* code_object) {
 
     // 获取全局模块级调用帧（REPL 共享同一个帧）
     auto frame = call_stack.back();
+    // 上一段代码留下的临时值(包括供REPL打印的结果)不再需要, 局部变量之后的槽位都要空出来:
+    // 新输入的代码可能把它们用作新的全局变量或临时寄存器. 临时值是借用的, 直接丢弃
+    const size_t old_locals_count = frame->code_object ? frame->code_object->locals_count : 0;
+    op_stack.resize(std::min(op_stack.size(), old_locals_count));
     // 对原有CodeObject调用del_ref(), 释放CallFrame的持有权
     if (frame->code_object) {
         frame->code_object->del_ref();
@@ -202,26 +189,45 @@ void Vm::reset_global_code(model::CodeObject* code_object) {
     code_object->make_ref();
     frame->code_object = code_object;
     frame->pc = 0;
+    // 新输入的代码可能声明了新的全局变量, 保证槽位都在栈内
+    op_stack.resize(code_object->frame_size());
     exec_curr_code();
 }
 
-std::string Vm::get_attr_name_by_idx(const size_t idx) {
-    auto frame = get_frame();
+void Vm::reclaim_memory() {
+    model::CycleCollector::collect(0);
+    model::FreeList<model::Int>::clear();
+    model::FreeList<model::String>::clear();
+    model::FreeList<model::List>::clear();
+    model::ObjectPool::trim();
+}
+
+void Vm::reset_run_state() {
+    for (const auto frame : call_stack) {
+        release_locals(frame);
+        release_frame(frame);
+    }
+    op_stack.clear();
+    call_stack.clear();
+    reclaim_memory();
+}
+
+model::Symbol Vm::get_attr_name_by_idx(const size_t idx) {
+    const auto frame = get_frame();
     return frame->code_object->attr_names[idx];
 }
 
 
-void Vm::assert_argc(size_t argc, const model::List* args) {
-    if (argc == args->val.size()) {
+void Vm::assert_argc(size_t argc, const size_t actually_count) {
+    if (argc == actually_count) {
         return;
     }
     throw NativeFuncError("ArgCountError", std::format(
-        "expect {} arguments but got {} arguments", args->val.size(), argc
+        "expect {} arguments but got {} arguments", actually_count, argc
     ));
 }
 
-void Vm::assert_argc(const std::vector<size_t>& argcs, const model::List* args) {
-    auto actually_count = args->val.size();
+void Vm::assert_argc(const std::vector<size_t>& argcs, const size_t actually_count) {
     for (size_t i : argcs) {
         if (i == actually_count) {
             return;
@@ -243,12 +249,20 @@ void Vm::assert_argc(const std::vector<size_t>& argcs, const model::List* args)
     ));
 }
 
+void Vm::assert_argc(const size_t argc, const model::List* args) {
+    assert_argc(argc, args->val.size());
+}
+
+void Vm::assert_argc(const std::vector<size_t>& argcs, const model::List* args) {
+    assert_argc(argcs, args->val.size());
+}
+
 std::filesystem::path Vm::get_current_file_path() {
     std::filesystem::path current_file_path = "";
     if (main_file_path == "<shell#>") return current_file_path;
     for (const auto& frame: std::ranges::reverse_view(call_stack)) {
         if (frame->owner->get_type() == model::Object::ObjectType::Module) {
-            const auto m = dynamic_cast<model::Module*>(frame->owner);
+            const auto m = model::as<model::Module>(frame->owner);
             current_file_path = m->path;
         }
     }
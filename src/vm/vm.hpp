@@ -8,9 +8,15 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 #include "../../depends/hashmap.hpp"
+#include "../models/symbol.hpp"
 
 #include <stack>
 #include <tuple>
@@ -19,19 +25,9 @@
 #include "../kiz.hpp"
 #include "../error/error_reporter.hpp"
 
-#define ADVANCE_PC \
-    if (curr_inst.opc != Opcode::JUMP \
-        && curr_inst.opc != Opcode::JUMP_IF_FALSE \
-        && curr_inst.opc != Opcode::RET \
-        && curr_inst.opc != Opcode::THROW \
-        && curr_inst.opc != Opcode::JUMP_IF_FINISH_ITER\
-    ) { \
-                curr_frame->pc++; \
-    }
-
-
 namespace model {
 class Module;
+class Function;
 class CodeObject;
 class Object;
 class List;
@@ -43,16 +39,30 @@ namespace kiz {
 
 enum class Opcode : uint8_t;
 
+///| 定长紧凑指令: 操作码 + 至多3个内联的32位操作数(共16字节)
+///| 位置信息不放在指令里, 由CodeObject的位置表(pos_table)按pc查找
 struct Instruction {
+    static constexpr size_t max_opn = 3;
+    // 寄存器指令(REG_*)的源操作数: 最高位为1表示常量池下标, 否则为当前帧的槽位(局部变量或临时寄存器)
+    static constexpr uint32_t const_operand_bit = 0x80000000u;
+
     Opcode opc;
-    std::vector<size_t> opn_list;
-    err::PositionInfo pos{};
-    Instruction(Opcode o, std::vector<size_t> ol, err::PositionInfo& p) : opc(o), opn_list(std::move(ol)), pos(p) {}
+    Opcode sub_opc {}; // REG_*指令携带的运算符, 占用原本的填充字节
+    uint16_t aux {}; // REG_GET_ATTR/REG_CALL_METHOD的属性名下标, 同样占用填充字节
+    uint32_t opn_list[max_opn] {};
+
+    Instruction(const Opcode o, const std::initializer_list<size_t> ol) : opc(o) {
+        assert(ol.size() <= max_opn);
+        size_t i = 0;
+        for (const size_t opn : ol) {
+            assert(opn <= UINT32_MAX && "operand overflows 32 bits");
+            opn_list[i++] = static_cast<uint32_t>(opn);
+        }
+    }
 };
+static_assert(sizeof(Instruction) == 16);
 
 struct CallFrame {
-    std::string name;
-
     model::Object* owner;
 
     size_t pc = 0;
@@ -65,17 +75,78 @@ struct CallFrame {
 
     model::Object* curr_error;
     bool exec_ensure_stmt = false;
+    // 由原生函数经call_function调用的帧: 异常越过原生函数时, 原生函数仍按这一帧留在操作数栈上的内容取值,
+    // 因此不能被尾调用复用
+    bool called_from_native = false;
+
+    // 帧名不再复制保存, 按需从owner(Function的函数名/Module的路径)取得
+    [[nodiscard]] std::string_view name() const;
 };
 
+///| 调用帧栈: 帧对象按块预先分配, 地址在整个运行期间不变;
+///| 出栈的帧留在原处供下一次调用复用(iters保留已有容量), 因此调用和返回都不再有堆分配
+class FrameStack {
+public:
+    static constexpr size_t chunk_size = 256;
+
+    FrameStack() { grow(); }
+    FrameStack(const FrameStack&) = delete;
+    FrameStack& operator=(const FrameStack&) = delete;
+
+    CallFrame* push(model::Object* owner, model::CodeObject* code_object,
+        const size_t return_to_pc, const size_t last_bp, const size_t bp) {
+        if (depth_ == slots_.size()) grow();
+        CallFrame* frame = slots_[depth_++];
+        frame->owner = owner;
+        frame->pc = 0;
+        frame->return_to_pc = return_to_pc;
+        frame->last_bp = last_bp;
+        frame->bp = bp;
+        frame->code_object = code_object;
+        frame->iters.clear();
+        frame->curr_error = nullptr;
+        frame->exec_ensure_stmt = false;
+        frame->called_from_native = false;
+        return frame;
+    }
+
+    // 弹出的帧在下一次push之前仍然可以访问
+    void pop_back() {
+        assert(depth_ > 0);
+        --depth_;
+    }
+    void clear() { depth_ = 0; }
+
+    [[nodiscard]] CallFrame* back() const { return slots_[depth_ - 1]; }
+    [[nodiscard]] CallFrame* operator[](const size_t i) const { return slots_[i]; }
+    [[nodiscard]] size_t size() const { return depth_; }
+    [[nodiscard]] bool empty() const { return depth_ == 0; }
+    [[nodiscard]] auto begin() const { return slots_.begin(); }
+    [[nodiscard]] auto end() const { return slots_.begin() + static_cast<std::ptrdiff_t>(depth_); }
+
+private:
+    void grow() {
+        chunks_.push_back(std::make_unique<CallFrame[]>(chunk_size));
+        for (size_t i = 0; i < chunk_size; ++i) slots_.push_back(&chunks_.back()[i]);
+    }
+
+    std::vector<std::unique_ptr<CallFrame[]>> chunks_;
+    std::vector<CallFrame*> slots_; // 第i个槽位的地址
+    size_t depth_ = 0;
+};
+
+// 从操作数栈弹出的值: 操作数栈只借用对象(见gc.hpp DeferredRc), 弹出后由StackRef钉住, 析构前
+// 核对零计数表都把它当作仍被借用. 弹出后还要调用方法/回调脚本的慢路径用它持有操作数
 class StackRef {
+    static constexpr size_t unpinned = static_cast<size_t>(-1);
     model::Object* obj;
+    size_t pin_index; // 在Vm::pinned中的位置
 public:
-    explicit StackRef(model::Object* o) : obj(o) {}
-    ~StackRef(); // 在vm.cpp中实现
+    explicit StackRef(model::Object* o); // 在vm.cpp中实现
+    ~StackRef();
     StackRef(const StackRef&) = delete;
-    StackRef(StackRef&& other)  noexcept : obj(other.obj) { other.obj = nullptr; }
+    StackRef(StackRef&& other) noexcept : obj(other.obj), pin_index(other.pin_index) { other.pin_index = unpinned; }
     [[nodiscard]] model::Object* get() const { return obj; }
-    model::Object* release() { auto p = obj; obj = nullptr; return p; }
 };
 
 class Vm {
@@ -83,10 +154,16 @@ public:
     static dep::HashMap<model::Module*> modules_cache;
     static model::Module* main_module;
 
+    ///| 局部变量槽位[bp, bp + locals_count)持有计数引用, 其上的临时值/参数只是借用
     static std::vector<model::Object*> op_stack;
-    static std::vector<CallFrame*> call_stack;
-
-    static model::Int* small_int_pool[201];
+    static FrameStack call_stack;
+    ///| 被StackRef钉住的值, 核对零计数表时与op_stack一起视为借用者; 析构顺序不定, 中间可能有空位
+    static std::vector<model::Object*> pinned;
+
+    ///| 小整数池: 值在[small_int_min, small_int_max]内的Int常驻且不参与引用计数, 通过model::load_int取用
+    static constexpr long long small_int_min = -128;
+    static constexpr long long small_int_max = 1024;
+    static model::Int* small_int_pool[small_int_max - small_int_min + 1];
     static std::vector<model::Object*> const_pool;
 
     static std::vector<model::Object*> builtins;
@@ -96,29 +173,63 @@ public:
     static bool running;
     static std::string main_file_path;
 
+    ///| 执行引擎, 启动时由--vm=stack/register选定: 两者共用CodeObject, CallFrame和内置对象,
+    ///| 寄存器引擎执行寄存器后端(见reg_gen.cpp)生成的代码, 临时值放在帧内的槽位上而不经过操作数栈
+    enum class Engine { Stack, Register };
+    static Engine engine;
+
     explicit Vm(const std::string& file_path_);
 
     ///| 核心执行循环
     static void set_main_module(model::Module* src_module);
     static void exec_curr_code();
+    ///| 唯一的执行循环(可重入): 执行到调用栈深度不大于stop_depth,
+    ///| 或深度为stop_depth+1的帧执行到代码末尾为止
+    static void run_until(size_t stop_depth);
+    static void run_loop(size_t stop_depth); // 指令分派, 见run_loop.cpp
+    static void run_reg_loop(size_t stop_depth); // 寄存器指令分派, 见run_reg_loop.cpp
     static void reset_global_code(model::CodeObject* code_object);
+    ///| 两次运行之间回收内存: 核对零计数表并处理全部循环回收候选, 再把完全空闲的slab还给系统
+    static void reclaim_memory();
+    ///| 释放上一次运行留下的操作数栈和调用帧, 然后reclaim_memory(start_test在两个文件之间调用)
+    static void reset_run_state();
     static void execute_unit(const Instruction& instruction);
 
+    ///| 运算符快速路径(见fast_ops.cpp): 操作数都是Int/Decimal/Str/Bool时直接计算, 不走魔术方法协议
+    ///| 内置类型的原型或实例的属性被改写后builtin_ops_intact置为false, 之后一律回退到call_method
+    static bool builtin_ops_intact;
+    static void note_attr_write(const model::Object* obj);
+    static model::Object* try_fast_binary_op(Opcode opc, model::Object* a, model::Object* b);
+    static model::Object* try_fast_neg(model::Object* a);
+
     ///| 栈操作
     static CallFrame* get_frame();
-    static StackRef get_and_pop_stack_top(); // 返回StackRef对象，参与RAII
-    static model::Object* simple_get_and_pop_stack_top(); // 直接返回栈顶值, 需手动del_refc
+    static StackRef get_and_pop_stack_top(); // 返回钉住的StackRef对象，参与RAII
+    static model::Object* simple_get_and_pop_stack_top(); // 直接返回借用的栈顶值, 只在下一个安全点之前有效
     static void push_to_stack(model::Object* obj);
-    static std::string get_attr_name_by_idx(size_t idx);
-
-    ///| 如果新增了调用栈，执行循环仅处理新增的模块栈帧（call_stack.size() > old_stack_size），不影响原有调用栈
+    ///| 赋值语义(copy_if_mutable)存入局部变量槽位op_stack[offset]并返回存入的值, 槽位持有计数引用
+    static model::Object* assign_slot(size_t offset, model::Object* value);
+    ///| 释放帧的局部变量槽位持有的引用并置空; 帧之上的临时值是借用的, 不需要释放
+    static void release_locals(const CallFrame* frame);
+    ///| 释放已弹出的帧持有的函数, 代码, 迭代器和错误对象
+    static void release_frame(CallFrame* frame);
+    static model::Symbol get_attr_name_by_idx(size_t idx);
+
+    ///| 如果新增了调用栈，仅执行新增的栈帧(run_until当前深度)，返回值留在栈顶
     static void call_function(model::Object* func_obj, std::vector<model::Object*> args, model::Object* self);
 
     ///| 运算符与普通方法分规则查找
-    static void call_method(model::Object* obj, const std::string& attr_name, std::vector<model::Object*> args);
+    static void call_method(model::Object* obj, model::Symbol attr_name, std::vector<model::Object*> args);
+    static void call_method(model::Object* obj, std::string_view attr_name, std::vector<model::Object*> args);
 
     ///| 如果用户函数则创建调用栈，如果内置函数则执行并压上返回值
-    static void handle_call(model::Object* func_obj, model::Object* args_obj, model::Object* self=nullptr);
+    ///| 参数是操作数栈顶的argc个对象: 用户函数直接把它们作为新帧的局部变量, 内置函数调用后弹出
+    static void handle_call(model::Object* func_obj, size_t argc, model::Object* self=nullptr);
+    ///| 尾调用: 用户函数直接复用当前帧, 其余情况退化为handle_call
+    static void handle_tail_call(model::Object* func_obj, size_t argc);
+    static void bind_args(const model::Function* func, size_t base, size_t argc, model::Object* self);
+    static void drop_args(size_t base, size_t argc);
+    static void check_args_base(size_t base, size_t argc);
 
     ///| 处理import
     static void handle_import(const std::string& module_path);
@@ -133,8 +244,13 @@ public:
     static void entry_std_modules();
 
     ///| @utils
-    static model::Object* get_attr(model::Object* obj, const std::string& attr);
-    static model::Object* get_attr_current(model::Object* obj, const std::string& attr);
+    ///| 按名字查找的版本先到符号表里找到对应的Symbol, 名字从未登记过时直接报错
+    static model::Object* get_attr(model::Object* obj, model::Symbol attr);
+    static model::Object* get_attr(model::Object* obj, std::string_view attr);
+    ///| 同get_attr, 但对象自身没有该属性时先查指令的内联缓存(以__parent__为键)
+    static model::Object* get_attr_cached(model::Object* obj, model::Symbol attr, size_t cache_slot);
+    static model::Object* get_attr_current(model::Object* obj, model::Symbol attr);
+    static model::Object* get_attr_current(model::Object* obj, std::string_view attr);
     static bool is_true(model::Object* obj);
     static std::string obj_to_str(model::Object* for_cast_obj);
     static std::string obj_to_debug_str(model::Object* for_cast_obj);
@@ -145,6 +261,8 @@ public:
     static void make_dict(size_t len);
 
     ///| @utils: 供builtins检查参数
+    static void assert_argc(size_t argc, size_t actually_count);
+    static void assert_argc(const std::vector<size_t>& argcs, size_t actually_count);
     static void assert_argc(size_t argc, const model::List* args);
     static void assert_argc(const std::vector<size_t>& argcs, const model::List* args);
 
@@ -35,6 +35,9 @@ target("kiz")
     add_files("src/ir_gen/ir_gen.cpp")
     add_files("src/ir_gen/gen_expr.cpp")
     add_files("src/ir_gen/gen_stmt.cpp")
+    add_files("src/ir_gen/peephole.cpp")
+    add_files("src/ir_gen/reg_gen.cpp")
+    add_files("src/ir_gen/optimize.cpp")
 
     -- VM 核心模块
     add_files("src/vm/vm.cpp")
@@ -42,6 +45,9 @@ target("kiz")
     add_files("src/vm/entry_builtins.cpp")
 
     add_files("src/vm/execute_unit.cpp")
+    add_files("src/vm/run_loop.cpp")
+    add_files("src/vm/run_reg_loop.cpp")
+    add_files("src/vm/fast_ops.cpp")
     add_files("src/vm/handle_import.cpp")
     add_files("src/vm/handle_error.cpp")
     add_files("src/vm/handle_call.cpp")
@@ -63,6 +69,7 @@ target("kiz")
     add_files("libs/builtins/dict_methods.cpp")
     add_files("libs/builtins/builtin_functions.cpp")
     add_files("libs/os/os_lib.cpp")
+    add_files("libs/gc/gc_lib.cpp")
     add_files("libs/builtins/builtins_lib.cpp")
     add_files("libs/builtins/file_handle_methods.cpp")
     add_files("libs/builtins/object_methods.cpp")
@@ -73,6 +80,13 @@ target("kiz")
     add_includedirs("libs")
     add_includedirs("cmake-build-debug/include") -- 生成的version.hpp
 
+    -- 指令分派引擎: 使用 computed goto (仅GCC/Clang生效, 否则回退到switch)
+    add_defines("KIZ_COMPUTED_GOTO")
+    -- 所有对象都使用原子引用计数时打开(默认使用普通整数)
+    -- add_defines("KIZ_ATOMIC_REFCOUNT")
+    -- 堆对象从分级内存池分配(注释掉则使用全局operator new)
+    add_defines("KIZ_OBJECT_POOL")
+
     -- 设置编译选项
     set_optimize("fastest")
     add_cflags("-static")